@@ -78,6 +78,19 @@
      (READ (img, (((uint8_t *)(l)) + ((o) * 3) + 2)) << 16))
 #endif
 
+/* 64 bpp pixels are read as two 32 bit words, most significant first
+ * on big endian machines.
+ */
+#ifdef WORDS_BIGENDIAN
+#define FETCH_64(img,l,o)						\
+    (((uint64_t)READ (img, ((uint32_t *)(l)) + 2 * (o)) << 32) |	\
+     READ (img, ((uint32_t *)(l)) + 2 * (o) + 1))
+#else
+#define FETCH_64(img,l,o)						\
+    (((uint64_t)READ (img, ((uint32_t *)(l)) + 2 * (o) + 1) << 32) |	\
+     READ (img, ((uint32_t *)(l)) + 2 * (o)))
+#endif
+
 /* Store macros */
 
 #ifdef WORDS_BIGENDIAN
@@ -160,6 +173,28 @@
     while (0)
 #endif
 
+#ifdef WORDS_BIGENDIAN
+#define STORE_64(img,l,o,v)						\
+    do									\
+    {									\
+	uint32_t *__tmp = ((uint32_t *)(l)) + 2 * (o);			\
+									\
+	WRITE ((img), __tmp, (uint32_t)((v) >> 32));			\
+	WRITE ((img), __tmp + 1, (uint32_t)(v));			\
+    }									\
+    while (0)
+#else
+#define STORE_64(img,l,o,v)						\
+    do									\
+    {									\
+	uint32_t *__tmp = ((uint32_t *)(l)) + 2 * (o);			\
+									\
+	WRITE ((img), __tmp, (uint32_t)(v));				\
+	WRITE ((img), __tmp + 1, (uint32_t)((v) >> 32));		\
+    }									\
+    while (0)
+#endif
+
 /*
  * YV12 setup and access macros
  */
@@ -732,6 +767,121 @@ fetch_scanline_x2b10g10r10_float (bits_image_t   *image,
     }
 }
 
+/* Expects a float buffer */
+static void
+fetch_scanline_a16b16g16r16_float (bits_image_t   *image,
+				   int             x,
+				   int             y,
+				   int             width,
+				   uint32_t *      b,
+				   const uint32_t *mask)
+{
+    const uint32_t *bits = image->bits + y * image->rowstride;
+    argb_t *buffer = (argb_t *)b;
+    int i;
+
+    for (i = x; i < x + width; ++i)
+    {
+	uint64_t p = FETCH_64 (image, bits, i);
+
+	buffer->a = pixman_unorm_to_float (p >> 48, 16);
+	buffer->b = pixman_unorm_to_float (p >> 32, 16);
+	buffer->g = pixman_unorm_to_float (p >> 16, 16);
+	buffer->r = pixman_unorm_to_float (p, 16);
+
+	buffer++;
+    }
+}
+
+/* Expects a float buffer */
+static void
+fetch_scanline_rgba_float_float (bits_image_t   *image,
+				 int             x,
+				 int             y,
+				 int             width,
+				 uint32_t *      b,
+				 const uint32_t *mask)
+{
+    const uint32_t *bits = image->bits + y * image->rowstride;
+    const uint32_t *pixel = bits + 4 * x;
+    const uint32_t *end = pixel + 4 * width;
+    argb_t *buffer = (argb_t *)b;
+    pixman_float_bits_t r, g, b_, a;
+
+    while (pixel < end)
+    {
+	r.u = READ (image, pixel + 0);
+	g.u = READ (image, pixel + 1);
+	b_.u = READ (image, pixel + 2);
+	a.u = READ (image, pixel + 3);
+
+	buffer->a = a.f;
+	buffer->r = r.f;
+	buffer->g = g.f;
+	buffer->b = b_.f;
+
+	pixel += 4;
+	buffer++;
+    }
+}
+
+/* Expects a float buffer */
+static void
+fetch_scanline_rgb_float_float (bits_image_t   *image,
+				int             x,
+				int             y,
+				int             width,
+				uint32_t *      b,
+				const uint32_t *mask)
+{
+    const uint32_t *bits = image->bits + y * image->rowstride;
+    const uint32_t *pixel = bits + 3 * x;
+    const uint32_t *end = pixel + 3 * width;
+    argb_t *buffer = (argb_t *)b;
+    pixman_float_bits_t r, g, b_;
+
+    while (pixel < end)
+    {
+	r.u = READ (image, pixel + 0);
+	g.u = READ (image, pixel + 1);
+	b_.u = READ (image, pixel + 2);
+
+	buffer->a = 1.0f;
+	buffer->r = r.f;
+	buffer->g = g.f;
+	buffer->b = b_.f;
+
+	pixel += 3;
+	buffer++;
+    }
+}
+
+/* Expects a float buffer */
+static void
+fetch_scanline_rgba_half_float (bits_image_t   *image,
+				int             x,
+				int             y,
+				int             width,
+				uint32_t *      b,
+				const uint32_t *mask)
+{
+    const uint32_t *bits = image->bits + y * image->rowstride;
+    const uint16_t *pixel = (const uint16_t *)bits + 4 * x;
+    const uint16_t *end = pixel + 4 * width;
+    argb_t *buffer = (argb_t *)b;
+
+    while (pixel < end)
+    {
+	buffer->a = pixman_half_to_float (READ (image, pixel + 3));
+	buffer->r = pixman_half_to_float (READ (image, pixel + 0));
+	buffer->g = pixman_half_to_float (READ (image, pixel + 1));
+	buffer->b = pixman_half_to_float (READ (image, pixel + 2));
+
+	pixel += 4;
+	buffer++;
+    }
+}
+
 static void
 fetch_scanline_yuy2 (bits_image_t   *image,
                      int             x,
@@ -887,6 +1037,83 @@ fetch_pixel_x2b10g10r10_float (bits_image_t *image,
     return argb;
 }
 
+static argb_t
+fetch_pixel_rgba_float_float (bits_image_t *image,
+			      int           offset,
+			      int           line)
+{
+    const uint32_t *pixel = image->bits + line * image->rowstride + 4 * offset;
+    pixman_float_bits_t r, g, b, a;
+    argb_t argb;
+
+    r.u = READ (image, pixel + 0);
+    g.u = READ (image, pixel + 1);
+    b.u = READ (image, pixel + 2);
+    a.u = READ (image, pixel + 3);
+
+    argb.a = a.f;
+    argb.r = r.f;
+    argb.g = g.f;
+    argb.b = b.f;
+
+    return argb;
+}
+
+static argb_t
+fetch_pixel_rgb_float_float (bits_image_t *image,
+			     int           offset,
+			     int           line)
+{
+    const uint32_t *pixel = image->bits + line * image->rowstride + 3 * offset;
+    pixman_float_bits_t r, g, b;
+    argb_t argb;
+
+    r.u = READ (image, pixel + 0);
+    g.u = READ (image, pixel + 1);
+    b.u = READ (image, pixel + 2);
+
+    argb.a = 1.0f;
+    argb.r = r.f;
+    argb.g = g.f;
+    argb.b = b.f;
+
+    return argb;
+}
+
+static argb_t
+fetch_pixel_rgba_half_float (bits_image_t *image,
+			     int           offset,
+			     int           line)
+{
+    const uint16_t *pixel =
+	(const uint16_t *)(image->bits + line * image->rowstride) + 4 * offset;
+    argb_t argb;
+
+    argb.a = pixman_half_to_float (READ (image, pixel + 3));
+    argb.r = pixman_half_to_float (READ (image, pixel + 0));
+    argb.g = pixman_half_to_float (READ (image, pixel + 1));
+    argb.b = pixman_half_to_float (READ (image, pixel + 2));
+
+    return argb;
+}
+
+static argb_t
+fetch_pixel_a16b16g16r16_float (bits_image_t *image,
+				int           offset,
+				int           line)
+{
+    uint32_t *bits = image->bits + line * image->rowstride;
+    uint64_t p = FETCH_64 (image, bits, offset);
+    argb_t argb;
+
+    argb.a = pixman_unorm_to_float (p >> 48, 16);
+    argb.b = pixman_unorm_to_float (p >> 32, 16);
+    argb.g = pixman_unorm_to_float (p >> 16, 16);
+    argb.r = pixman_unorm_to_float (p, 16);
+
+    return argb;
+}
+
 static argb_t
 fetch_pixel_a8r8g8b8_sRGB_float (bits_image_t *image,
 				 int	       offset,
@@ -1064,6 +1291,98 @@ store_scanline_x2b10g10r10_float (bits_image_t *  image,
     }
 }
 
+static void
+store_scanline_rgba_float_float (bits_image_t *  image,
+				 int             x,
+				 int             y,
+				 int             width,
+				 const uint32_t *v)
+{
+    uint32_t *pixel = image->bits + image->rowstride * y + 4 * x;
+    argb_t *values = (argb_t *)v;
+    pixman_float_bits_t c;
+    int i;
+
+    for (i = 0; i < width; ++i)
+    {
+	c.f = values[i].r;
+	WRITE (image, pixel++, c.u);
+	c.f = values[i].g;
+	WRITE (image, pixel++, c.u);
+	c.f = values[i].b;
+	WRITE (image, pixel++, c.u);
+	c.f = values[i].a;
+	WRITE (image, pixel++, c.u);
+    }
+}
+
+static void
+store_scanline_rgb_float_float (bits_image_t *  image,
+				int             x,
+				int             y,
+				int             width,
+				const uint32_t *v)
+{
+    uint32_t *pixel = image->bits + image->rowstride * y + 3 * x;
+    argb_t *values = (argb_t *)v;
+    pixman_float_bits_t c;
+    int i;
+
+    for (i = 0; i < width; ++i)
+    {
+	c.f = values[i].r;
+	WRITE (image, pixel++, c.u);
+	c.f = values[i].g;
+	WRITE (image, pixel++, c.u);
+	c.f = values[i].b;
+	WRITE (image, pixel++, c.u);
+    }
+}
+
+static void
+store_scanline_rgba_half_float (bits_image_t *  image,
+				int             x,
+				int             y,
+				int             width,
+				const uint32_t *v)
+{
+    uint16_t *pixel = (uint16_t *)(image->bits + image->rowstride * y) + 4 * x;
+    argb_t *values = (argb_t *)v;
+    int i;
+
+    for (i = 0; i < width; ++i)
+    {
+	WRITE (image, pixel++, pixman_float_to_half (values[i].r));
+	WRITE (image, pixel++, pixman_float_to_half (values[i].g));
+	WRITE (image, pixel++, pixman_float_to_half (values[i].b));
+	WRITE (image, pixel++, pixman_float_to_half (values[i].a));
+    }
+}
+
+static void
+store_scanline_a16b16g16r16_float (bits_image_t *  image,
+				   int             x,
+				   int             y,
+				   int             width,
+				   const uint32_t *v)
+{
+    uint32_t *bits = image->bits + image->rowstride * y;
+    argb_t *values = (argb_t *)v;
+    int i;
+
+    for (i = 0; i < width; ++i)
+    {
+	uint64_t a, r, g, b;
+
+	a = pixman_float_to_unorm (values[i].a, 16);
+	r = pixman_float_to_unorm (values[i].r, 16);
+	g = pixman_float_to_unorm (values[i].g, 16);
+	b = pixman_float_to_unorm (values[i].b, 16);
+
+	STORE_64 (image, bits, x + i, (a << 48) | (b << 32) | (g << 16) | r);
+    }
+}
+
 static void
 store_scanline_a8r8g8b8_sRGB_float (bits_image_t *  image,
 				    int             x,
@@ -1352,6 +1671,26 @@ static const format_info_t accessors[] =
     
 /* Wide formats */
     
+    { PIXMAN_rgba_float,
+      NULL, fetch_scanline_rgba_float_float,
+      fetch_pixel_generic_lossy_32, fetch_pixel_rgba_float_float,
+      NULL, store_scanline_rgba_float_float },
+
+    { PIXMAN_rgb_float,
+      NULL, fetch_scanline_rgb_float_float,
+      fetch_pixel_generic_lossy_32, fetch_pixel_rgb_float_float,
+      NULL, store_scanline_rgb_float_float },
+
+    { PIXMAN_rgba_half,
+      NULL, fetch_scanline_rgba_half_float,
+      fetch_pixel_generic_lossy_32, fetch_pixel_rgba_half_float,
+      NULL, store_scanline_rgba_half_float },
+
+    { PIXMAN_a16b16g16r16,
+      NULL, fetch_scanline_a16b16g16r16_float,
+      fetch_pixel_generic_lossy_32, fetch_pixel_a16b16g16r16_float,
+      NULL, store_scanline_a16b16g16r16_float },
+
     { PIXMAN_a2r10g10b10,
       NULL, fetch_scanline_a2r10g10b10_float,
       fetch_pixel_generic_lossy_32, fetch_pixel_a2r10g10b10_float,
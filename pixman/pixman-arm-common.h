@@ -361,6 +361,10 @@ FAST_BILINEAR_MAINLOOP_COMMON (cputype##_##name##_pad_##op,                   \
 FAST_BILINEAR_MAINLOOP_COMMON (cputype##_##name##_normal_##op,                \
                        scaled_bilinear_scanline_##cputype##_##name##_##op,    \
                        src_type, uint32_t, dst_type, NORMAL,                  \
+                       FLAG_NONE)                                             \
+FAST_BILINEAR_MAINLOOP_COMMON (cputype##_##name##_reflect_##op,               \
+                       scaled_bilinear_scanline_##cputype##_##name##_##op,    \
+                       src_type, uint32_t, dst_type, REFLECT,                 \
                        FLAG_NONE)
 
 
@@ -413,6 +417,10 @@ FAST_BILINEAR_MAINLOOP_COMMON (cputype##_##name##_pad_##op,                   \
 FAST_BILINEAR_MAINLOOP_COMMON (cputype##_##name##_normal_##op,                \
                        scaled_bilinear_scanline_##cputype##_##name##_##op,    \
                        src_type, uint8_t, dst_type, NORMAL,                   \
+                       FLAG_HAVE_NON_SOLID_MASK)                              \
+FAST_BILINEAR_MAINLOOP_COMMON (cputype##_##name##_reflect_##op,               \
+                       scaled_bilinear_scanline_##cputype##_##name##_##op,    \
+                       src_type, uint8_t, dst_type, REFLECT,                  \
                        FLAG_HAVE_NON_SOLID_MASK)
 
 
@@ -459,7 +459,7 @@ pixman_implementation_t *
 _pixman_implementation_create_arm_neon (pixman_implementation_t *fallback)
 {
     pixman_implementation_t *imp =
-	_pixman_implementation_create (fallback, arm_neon_fast_paths);
+	_pixman_implementation_create ("arm-neon", fallback, arm_neon_fast_paths);
 
     imp->combine_32[PIXMAN_OP_OVER] = neon_combine_over_u;
     imp->combine_32[PIXMAN_OP_ADD] = neon_combine_add_u;
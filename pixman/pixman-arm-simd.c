@@ -282,7 +282,8 @@ static const pixman_fast_path_t arm_simd_fast_paths[] =
 pixman_implementation_t *
 _pixman_implementation_create_arm_simd (pixman_implementation_t *fallback)
 {
-    pixman_implementation_t *imp = _pixman_implementation_create (fallback, arm_simd_fast_paths);
+    pixman_implementation_t *imp =
+	_pixman_implementation_create ("arm-simd", fallback, arm_simd_fast_paths);
 
     imp->blt = arm_simd_blt;
     imp->fill = arm_simd_fill;
@@ -894,20 +894,192 @@ _pixman_bits_image_dest_iter_init (pixman_image_t *image, pixman_iter_t *iter)
     }
 }
 
+#define PREFETCH_LINE_SIZE	64
+#define PREFETCH_MAX_BYTES	1024
+
+/* Hints to the CPU which pixels a fetch of scanline y, x .. x + width - 1
+ * will read, so that a caller working a few rows ahead can hide the
+ * cache misses. Only short rows are worth it: the hardware prefetchers
+ * follow a long row on their own, but not the jump from the end of one
+ * row to the start of the next, which makes narrow composites on large
+ * images stall on every row. Longer rows and transformed images are
+ * left alone, since prefetching them measured slower.
+ */
+void
+_pixman_bits_image_prefetch_scanline (pixman_image_t *image,
+				      int             x,
+				      int             y,
+				      int             width)
+{
+    bits_image_t *bits;
+    uint8_t *row;
+    int bpp, x0, x1;
+
+    if (!image || image->type != BITS || width <= 0)
+	return;
+
+    bits = &image->bits;
+    bpp = PIXMAN_FORMAT_BPP (bits->format);
+
+    /* Accessors may stand for memory that is not there to prefetch */
+    if (!(image->common.flags & FAST_PATH_ID_TRANSFORM)	||
+	!(image->common.flags & FAST_PATH_NO_ACCESSORS)	||
+	bpp < 8)
+    {
+	return;
+    }
+
+    if (y < 0 || y >= bits->height)
+    {
+	if (image->common.repeat == PIXMAN_REPEAT_NORMAL)
+	    y = MOD (y, bits->height);
+	else if (image->common.repeat == PIXMAN_REPEAT_PAD)
+	    y = y < 0 ? 0 : bits->height - 1;
+	else
+	    return;
+    }
+
+    x0 = MAX (x, 0);
+    x1 = MIN (x + width, bits->width);
+
+    /* A row that wraps around is read in full */
+    if (image->common.repeat == PIXMAN_REPEAT_NORMAL &&
+	(x < 0 || x + width > bits->width))
+    {
+	x0 = 0;
+	x1 = bits->width;
+    }
+
+    x0 = x0 * (bpp >> 3) & ~(PREFETCH_LINE_SIZE - 1);
+    x1 = x1 * (bpp >> 3);
+
+    if (x1 - x0 > PREFETCH_MAX_BYTES)
+	return;
+
+    row = (uint8_t *)(bits->bits + y * bits->rowstride);
+
+    for (; x0 < x1; x0 += PREFETCH_LINE_SIZE)
+	PIXMAN_PREFETCH (row + x0);
+}
+
+/* Calls the begin or end scanline accessor for each row of the boxes,
+ * clipped to the image. With no boxes, the whole image is covered.
+ */
+static void
+bits_image_access (bits_image_t                 *bits,
+		   const pixman_box32_t         *boxes,
+		   int                           n_boxes,
+		   int                           dx,
+		   int                           dy,
+		   uint32_t                      access,
+		   pixman_scanline_access_func_t func)
+{
+    pixman_box32_t whole;
+    int bpp, i, y;
+
+    whole.x1 = 0;
+    whole.y1 = 0;
+    whole.x2 = bits->width;
+    whole.y2 = bits->height;
+
+    if (!boxes)
+    {
+	boxes = &whole;
+	n_boxes = 1;
+	dx = dy = 0;
+    }
+
+    bpp = PIXMAN_FORMAT_BPP (bits->format);
+
+    for (i = 0; i < n_boxes; ++i)
+    {
+	int x1 = MAX (boxes[i].x1 + dx, 0);
+	int y1 = MAX (boxes[i].y1 + dy, 0);
+	int x2 = MIN (boxes[i].x2 + dx, bits->width);
+	int y2 = MIN (boxes[i].y2 + dy, bits->height);
+	int start, n_bytes;
+
+	if (x1 >= x2)
+	    continue;
+
+	start = (int)(((int64_t)x1 * bpp) >> 3);
+	n_bytes = (int)((((int64_t)x2 * bpp + 7) >> 3) - start);
+
+	for (y = y1; y < y2; ++y)
+	{
+	    uint8_t *row = (uint8_t *)(bits->bits + (intptr_t)y * bits->rowstride);
+
+	    func ((pixman_image_t *)bits, row + start, n_bytes,
+		  access, bits->access_data);
+	}
+    }
+}
+
+/* Call the begin or end scanline accessor of @image for every row
+ * span that an operation on @boxes, offset by @dx, @dy, may touch.
+ * Only untransformed, unrepeated images are narrowed down to the
+ * boxes; anything else, and the alpha map, is reported whole. A
+ * NULL @boxes also means the whole image.
+ */
+void
+_pixman_image_access (pixman_image_t       *image,
+		      const pixman_box32_t *boxes,
+		      int                   n_boxes,
+		      int                   dx,
+		      int                   dy,
+		      uint32_t              access,
+		      pixman_bool_t         end)
+{
+    bits_image_t *bits = &image->bits;
+    bits_image_t *alpha = image->common.alpha_map;
+    pixman_scanline_access_func_t func;
+
+    if (image->type != BITS)
+	return;
+
+    if (!(image->common.flags & FAST_PATH_ID_TRANSFORM)	||
+	!(image->common.flags & FAST_PATH_NEAREST_FILTER)	||
+	image->common.repeat != PIXMAN_REPEAT_NONE)
+    {
+	boxes = NULL;
+    }
+
+    func = end ? bits->end_access : bits->begin_access;
+    if (func)
+	bits_image_access (bits, boxes, n_boxes, dx, dy, access, func);
+
+    if (alpha)
+    {
+	func = end ? alpha->end_access : alpha->begin_access;
+	if (func)
+	    bits_image_access (alpha, NULL, 0, 0, 0, access, func);
+    }
+}
+
 static uint32_t *
 create_bits (pixman_format_code_t format,
              int                  width,
              int                  height,
              int *		  rowstride_bytes,
-	     pixman_bool_t	  clear)
+	     uint32_t		  bits_flags,
+	     uint32_t **	  free_me)
 {
     int stride;
     size_t buf_size;
     int bpp;
+    int align;
+    uint8_t *mem;
+
+    if (bits_flags & PIXMAN_BITS_ALIGN_64)
+	align = 64;
+    else if (bits_flags & PIXMAN_BITS_ALIGN_32)
+	align = 32;
+    else
+	align = sizeof (uint32_t);
 
     /* what follows is a long-winded way, avoiding any possibility of integer
      * overflows, of saying:
-     * stride = ((width * bpp + 0x1f) >> 5) * sizeof (uint32_t);
+     * stride = ((width * bpp + 8 * align - 1) / (8 * align)) * align;
      */
 
     bpp = PIXMAN_FORMAT_BPP (format);
@@ -915,26 +1087,44 @@ create_bits (pixman_format_code_t format,
 	return NULL;
 
     stride = width * bpp;
-    if (_pixman_addition_overflows_int (stride, 0x1f))
+    if (_pixman_addition_overflows_int (stride, 8 * align - 1))
 	return NULL;
 
-    stride += 0x1f;
-    stride >>= 5;
+    stride += 8 * align - 1;
+    stride /= 8 * align;
 
-    stride *= sizeof (uint32_t);
+    stride *= align;
 
     if (_pixman_multiply_overflows_size (height, stride))
 	return NULL;
 
     buf_size = (size_t)height * stride;
 
+    /* Over-allocate so that the start can be aligned; free_me keeps
+     * the pointer that was returned by the allocator.
+     */
+    if (align > (int) sizeof (uint32_t))
+    {
+	if (buf_size > SIZE_MAX - align)
+	    return NULL;
+
+	buf_size += align;
+    }
+
     if (rowstride_bytes)
 	*rowstride_bytes = stride;
 
-    if (clear)
-	return calloc (buf_size, 1);
+    if (bits_flags & PIXMAN_BITS_NO_CLEAR)
+	mem = malloc (buf_size);
     else
-	return malloc (buf_size);
+	mem = calloc (buf_size, 1);
+
+    *free_me = (uint32_t *)mem;
+
+    if (mem && align > (int) sizeof (uint32_t))
+	mem += (align - ((uintptr_t)mem & (align - 1))) & (align - 1);
+
+    return (uint32_t *)mem;
 }
 
 pixman_bool_t
@@ -944,7 +1134,7 @@ _pixman_bits_image_init (pixman_image_t *     image,
                          int                  height,
                          uint32_t *           bits,
                          int                  rowstride,
-			 pixman_bool_t	      clear)
+			 uint32_t	      bits_flags)
 {
     uint32_t *free_me = NULL;
 
@@ -952,7 +1142,8 @@ _pixman_bits_image_init (pixman_image_t *     image,
     {
 	int rowstride_bytes;
 
-	free_me = bits = create_bits (format, width, height, &rowstride_bytes, clear);
+	bits = create_bits (format, width, height, &rowstride_bytes,
+			    bits_flags, &free_me);
 
 	if (!bits)
 	    return FALSE;
@@ -970,7 +1161,14 @@ _pixman_bits_image_init (pixman_image_t *     image,
     image->bits.free_me = free_me;
     image->bits.read_func = NULL;
     image->bits.write_func = NULL;
+    image->bits.begin_access = NULL;
+    image->bits.end_access = NULL;
+    image->bits.access_data = NULL;
+    image->bits.mipmap = FALSE;
+    memset (image->bits.mipmap_levels, 0, sizeof (image->bits.mipmap_levels));
+    image->bits.analytic_coverage = FALSE;
     image->bits.rowstride = rowstride;
+    image->bits.bits_flags = bits_flags;
     image->bits.indexed = NULL;
 
     image->common.property_changed = bits_image_property_changed;
@@ -986,7 +1184,7 @@ create_bits_image_internal (pixman_format_code_t format,
 			    int                  height,
 			    uint32_t *           bits,
 			    int                  rowstride_bytes,
-			    pixman_bool_t	 clear)
+			    uint32_t		 bits_flags)
 {
     pixman_image_t *image;
 
@@ -995,6 +1193,19 @@ create_bits_image_internal (pixman_format_code_t format,
     return_val_if_fail (
 	bits == NULL || (rowstride_bytes % sizeof (uint32_t)) == 0, NULL);
 
+    /* or of uint64_t's for 64 bpp formats */
+    return_val_if_fail (
+	bits == NULL || PIXMAN_FORMAT_BPP (format) != 64 ||
+	(rowstride_bytes % sizeof (uint64_t)) == 0, NULL);
+
+    /* and live up to the promised alignment */
+    return_val_if_fail (
+	bits == NULL || !(bits_flags & PIXMAN_BITS_ALIGN_32) ||
+	(((uintptr_t)bits | rowstride_bytes) & 31) == 0, NULL);
+    return_val_if_fail (
+	bits == NULL || !(bits_flags & PIXMAN_BITS_ALIGN_64) ||
+	(((uintptr_t)bits | rowstride_bytes) & 63) == 0, NULL);
+
     return_val_if_fail (PIXMAN_FORMAT_BPP (format) >= PIXMAN_FORMAT_DEPTH (format), NULL);
 
     image = _pixman_image_allocate ();
@@ -1004,7 +1215,7 @@ create_bits_image_internal (pixman_format_code_t format,
 
     if (!_pixman_bits_image_init (image, format, width, height, bits,
 				  rowstride_bytes / (int) sizeof (uint32_t),
-				  clear))
+				  bits_flags))
     {
 	free (image);
 	return NULL;
@@ -1022,7 +1233,7 @@ pixman_image_create_bits (pixman_format_code_t format,
                           int                  rowstride_bytes)
 {
     return create_bits_image_internal (
-	format, width, height, bits, rowstride_bytes, TRUE);
+	format, width, height, bits, rowstride_bytes, 0);
 }
 
 
@@ -1035,5 +1246,20 @@ pixman_image_create_bits_no_clear (pixman_format_code_t format,
 				   int                  rowstride_bytes)
 {
     return create_bits_image_internal (
-	format, width, height, bits, rowstride_bytes, FALSE);
+	format, width, height, bits, rowstride_bytes, PIXMAN_BITS_NO_CLEAR);
+}
+
+/* Like pixman_image_create_bits(), with pixman_bits_flags_t describing
+ * how to allocate the bits, or what the caller guarantees about them.
+ */
+PIXMAN_EXPORT pixman_image_t *
+pixman_image_create_bits_with_flags (pixman_format_code_t format,
+				     int                  width,
+				     int                  height,
+				     uint32_t *           bits,
+				     int                  rowstride_bytes,
+				     uint32_t             flags)
+{
+    return create_bits_image_internal (
+	format, width, height, bits, rowstride_bytes, flags);
 }
@@ -272,8 +272,18 @@ get_factor (combine_factor_t factor, float sa, float da)
     									\
     MAKE_COMBINERS(name, pd_combine_ ## name, pd_combine_ ## name)
 
+/* SRC is a copy, so unlike the other operators it doesn't clamp. This
+ * keeps colors outside [0, 1] intact between the float formats.
+ */
+static float force_inline
+pd_combine_src (float sa, float s, float da, float d)
+{
+    return s;
+}
+
+MAKE_COMBINERS (src, pd_combine_src, pd_combine_src)
+
 MAKE_PD_COMBINERS (clear,			ZERO,				ZERO)
-MAKE_PD_COMBINERS (src,				ONE,				ZERO)
 MAKE_PD_COMBINERS (dst,				ZERO,				ONE)
 MAKE_PD_COMBINERS (over,			ONE,				INV_SA)
 MAKE_PD_COMBINERS (over_reverse,		INV_DA,				ONE)
@@ -641,167 +641,12 @@ combine_multiply_ca (pixman_implementation_t *imp,
 	}								\
     }
 
-/*
- * Screen
- *
- *      ad * as * B(d/ad, s/as)
- *    = ad * as * (d/ad + s/as - s/as * d/ad)
- *    = ad * s + as * d - s * d
- */
-static inline int32_t
-blend_screen (int32_t d, int32_t ad, int32_t s, int32_t as)
-{
-    return s * ad + d * as - s * d;
-}
-
 PDF_SEPARABLE_BLEND_MODE (screen)
-
-/*
- * Overlay
- *
- *     ad * as * B(d/ad, s/as)
- *   = ad * as * Hardlight (s, d)
- *   = if (d / ad < 0.5)
- *         as * ad * Multiply (s/as, 2 * d/ad)
- *     else
- *         as * ad * Screen (s/as, 2 * d / ad - 1)
- *   = if (d < 0.5 * ad)
- *         as * ad * s/as * 2 * d /ad
- *     else
- *         as * ad * (s/as + 2 * d / ad - 1 - s / as * (2 * d / ad - 1))
- *   = if (2 * d < ad)
- *         2 * s * d
- *     else
- *         ad * s + 2 * as * d - as * ad - ad * s * (2 * d / ad - 1)
- *   = if (2 * d < ad)
- *         2 * s * d
- *     else
- *         as * ad - 2 * (ad - d) * (as - s)
- */
-static inline int32_t
-blend_overlay (int32_t d, int32_t ad, int32_t s, int32_t as)
-{
-    uint32_t r;
-
-    if (2 * d < ad)
-	r = 2 * s * d;
-    else
-	r = as * ad - 2 * (ad - d) * (as - s);
-
-    return r;
-}
-
 PDF_SEPARABLE_BLEND_MODE (overlay)
-
-/*
- * Darken
- *
- *     ad * as * B(d/ad, s/as)
- *   = ad * as * MIN(d/ad, s/as)
- *   = MIN (as * d, ad * s)
- */
-static inline int32_t
-blend_darken (int32_t d, int32_t ad, int32_t s, int32_t as)
-{
-    s = ad * s;
-    d = as * d;
-
-    return s > d ? d : s;
-}
-
 PDF_SEPARABLE_BLEND_MODE (darken)
-
-/*
- * Lighten
- *
- *     ad * as * B(d/ad, s/as)
- *   = ad * as * MAX(d/ad, s/as)
- *   = MAX (as * d, ad * s)
- */
-static inline int32_t
-blend_lighten (int32_t d, int32_t ad, int32_t s, int32_t as)
-{
-    s = ad * s;
-    d = as * d;
-    
-    return s > d ? s : d;
-}
-
 PDF_SEPARABLE_BLEND_MODE (lighten)
-
-/*
- * Hard light
- *
- *     ad * as * B(d/ad, s/as)
- *   = if (s/as <= 0.5)
- *         ad * as * Multiply (d/ad, 2 * s/as)
- *     else
- *         ad * as * Screen (d/ad, 2 * s/as - 1)
- *   = if 2 * s <= as
- *         ad * as * d/ad * 2 * s / as
- *     else
- *         ad * as * (d/ad + (2 * s/as - 1) + d/ad * (2 * s/as - 1))
- *   = if 2 * s <= as
- *         2 * s * d
- *     else
- *         as * ad - 2 * (ad - d) * (as - s)
- */
-static inline int32_t
-blend_hard_light (int32_t d, int32_t ad, int32_t s, int32_t as)
-{
-    if (2 * s < as)
-	return 2 * s * d;
-    else
-	return as * ad - 2 * (ad - d) * (as - s);
-}
-
 PDF_SEPARABLE_BLEND_MODE (hard_light)
-
-/*
- * Difference
- *
- *     ad * as * B(s/as, d/ad)
- *   = ad * as * abs (s/as - d/ad)
- *   = if (s/as <= d/ad)
- *         ad * as * (d/ad - s/as)
- *     else
- *         ad * as * (s/as - d/ad)
- *   = if (ad * s <= as * d)
- *        as * d - ad * s
- *     else
- *        ad * s - as * d
- */
-static inline int32_t
-blend_difference (int32_t d, int32_t ad, int32_t s, int32_t as)
-{
-    int32_t das = d * as;
-    int32_t sad = s * ad;
-
-    if (sad < das)
-	return das - sad;
-    else
-	return sad - das;
-}
-
 PDF_SEPARABLE_BLEND_MODE (difference)
-
-/*
- * Exclusion
- *
- *     ad * as * B(s/as, d/ad)
- *   = ad * as * (d/ad + s/as - 2 * d/ad * s/as)
- *   = as * d + ad * s - 2 * s * d
- */
-
-/* This can be made faster by writing it directly and not using
- * PDF_SEPARABLE_BLEND_MODE, but that's a performance optimization */
-
-static inline int32_t
-blend_exclusion (int32_t d, int32_t ad, int32_t s, int32_t as)
-{
-    return s * ad + d * as - 2 * d * s;
-}
-
 PDF_SEPARABLE_BLEND_MODE (exclusion)
 
 #undef PDF_SEPARABLE_BLEND_MODE
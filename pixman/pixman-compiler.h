@@ -24,6 +24,13 @@
 #  define unlikely(expr)  (expr)
 #endif
 
+/* Hints that the cache line holding addr will be read soon */
+#if defined (__GNUC__)
+#  define PIXMAN_PREFETCH(addr) __builtin_prefetch (addr)
+#else
+#  define PIXMAN_PREFETCH(addr) do { } while (0)
+#endif
+
 #if defined (__GNUC__)
 #  define MAYBE_UNUSED  __attribute__((unused))
 #else
@@ -230,3 +237,87 @@
 #    error "Unknown thread local support for this system. Pixman will not work with multiple threads. Define PIXMAN_NO_TLS to acknowledge and accept this limitation and compile pixman without thread-safety support."
 
 #endif
+
+/* Atomics
+ *
+ * pixman_atomic_add() returns the new value, pixman_atomic_cas() and
+ * pixman_atomic_cas_ptr() return whether *p was @o and is now @n. All
+ * of them are full memory barriers.
+ *
+ * pixman_atomic_load() and pixman_atomic_store() access a 32 bit
+ * integer that other threads may access at the same time. They are
+ * not barriers, so they suit flags that order no other data.
+ */
+#if defined(__GNUC__)
+
+#   define PIXMAN_HAVE_ATOMICS
+#   define pixman_atomic_add(p, v)					\
+    __sync_add_and_fetch ((p), (v))
+#   define pixman_atomic_cas(p, o, n)					\
+    __sync_bool_compare_and_swap ((p), (o), (n))
+#   define pixman_atomic_cas_ptr(p, o, n)				\
+    __sync_bool_compare_and_swap ((p), (o), (n))
+#   if defined(__ATOMIC_RELAXED)
+#      define pixman_atomic_load(p)					\
+    __atomic_load_n ((p), __ATOMIC_RELAXED)
+#      define pixman_atomic_store(p, v)					\
+    __atomic_store_n ((p), (v), __ATOMIC_RELAXED)
+#   else
+#      define pixman_atomic_load(p)					\
+    (*(volatile int32_t *)(p))
+#      define pixman_atomic_store(p, v)					\
+    (*(volatile int32_t *)(p) = (v))
+#   endif
+
+#elif defined(_MSC_VER)
+
+#   include <intrin.h>
+#   define PIXMAN_HAVE_ATOMICS
+#   define pixman_atomic_add(p, v)					\
+    (_InterlockedExchangeAdd ((volatile long *)(p), (v)) + (v))
+#   define pixman_atomic_cas(p, o, n)					\
+    (_InterlockedCompareExchange ((volatile long *)(p), (n), (o)) == (o))
+#   define pixman_atomic_cas_ptr(p, o, n)				\
+    (_InterlockedCompareExchangePointer ((void * volatile *)(p), (n), (o)) == (o))
+#   define pixman_atomic_load(p)					\
+    (*(volatile long *)(p))
+#   define pixman_atomic_store(p, v)					\
+    (*(volatile long *)(p) = (v))
+
+#else
+
+/* Not thread-safe, see the note on threads in pixman.h */
+#   define pixman_atomic_add(p, v)					\
+    (*(p) += (v))
+#   define pixman_atomic_cas(p, o, n)					\
+    (*(p) == (o) ? (*(p) = (n), 1) : 0)
+#   define pixman_atomic_cas_ptr(p, o, n)				\
+    pixman_atomic_cas (p, o, n)
+#   define pixman_atomic_load(p)					\
+    (*(p))
+#   define pixman_atomic_store(p, v)					\
+    (*(p) = (v))
+
+#endif
+
+/* Waits while *p is @value, now and then giving up the processor in
+ * case the thread that is going to change it isn't running.
+ */
+void
+_pixman_spin_wait (volatile int32_t *p, int32_t value);
+
+/* Spinlocks, for short critical sections only */
+typedef volatile int32_t pixman_spinlock_t;
+
+static force_inline void
+pixman_spin_lock (pixman_spinlock_t *lock)
+{
+    while (!pixman_atomic_cas (lock, 0, 1))
+	_pixman_spin_wait (lock, 1);
+}
+
+static force_inline void
+pixman_spin_unlock (pixman_spinlock_t *lock)
+{
+    pixman_atomic_cas (lock, 1, 0);
+}
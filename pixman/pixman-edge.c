@@ -24,6 +24,7 @@
 #include <config.h>
 #endif
 
+#include <stdlib.h>
 #include <string.h>
 
 #include "pixman-private.h"
@@ -59,8 +60,10 @@
 
 #ifdef PIXMAN_FB_ACCESSORS
 #define PIXMAN_RASTERIZE_EDGES pixman_rasterize_edges_accessors
+#define PIXMAN_RASTERIZE_TRAPEZOID_ANALYTIC pixman_rasterize_trapezoid_analytic_accessors
 #else
 #define PIXMAN_RASTERIZE_EDGES pixman_rasterize_edges_no_accessors
+#define PIXMAN_RASTERIZE_TRAPEZOID_ANALYTIC pixman_rasterize_trapezoid_analytic_no_accessors
 #endif
 
 /*
@@ -335,6 +338,343 @@ rasterize_edges_8 (pixman_image_t *image,
     }
 }
 
+/*
+ * 8 bit alpha, exact area coverage
+ *
+ * A trapezoid is walked one pixel row at a time.  Within the row each
+ * edge is cut at the pixel boundaries it crosses, and every piece adds
+ * the area it leaves on its right inside its own pixel to a cell, and
+ * its full height to the cover of all pixels further right.  A running
+ * sum over the cells then gives the covered area of every pixel in the
+ * row.  Pixels between the two edges have no cells of their own, so
+ * they get a single constant which is stored with one span fill.
+ *
+ * Areas are in units of 2^-24 of a pixel.
+ */
+
+#define CELL_FULL (1 << 24)
+
+/* Beyond this, lines are only ever compared against the image bounds */
+#define CELL_X_LIMIT ((pixman_fixed_48_16_t) 1 << 40)
+
+typedef struct
+{
+    int32_t *		 area;	/* n cells */
+    int32_t *		 cover;	/* n + 1 cells */
+    int			 n;
+    pixman_fixed_48_16_t lo;	/* left edge of the first cell */
+    pixman_fixed_48_16_t hi;	/* right edge of the last cell */
+} coverage_cells_t;
+
+/* Cells touched by one edge in the current row */
+typedef struct
+{
+    int min, max;
+} cell_span_t;
+
+static pixman_fixed_48_16_t
+line_x (const pixman_line_fixed_t *line, pixman_fixed_t y)
+{
+    double x;
+
+    x = line->p1.x + ((double) y - line->p1.y) *
+	((double) line->p2.x - line->p1.x) /
+	((double) line->p2.y - line->p1.y);
+
+    if (x < -CELL_X_LIMIT)
+	return -CELL_X_LIMIT;
+    if (x > CELL_X_LIMIT)
+	return CELL_X_LIMIT;
+
+    return (pixman_fixed_48_16_t) x;
+}
+
+static force_inline void
+add_cell (coverage_cells_t *cells, cell_span_t *span, int sign,
+	  int i, pixman_fixed_48_16_t frac, int32_t h)
+{
+    cells->area[i] += sign * (int32_t) (((int64_t) h * (pixman_fixed_1 - frac)) >> 8);
+    cells->cover[i + 1] += sign * (h << 8);
+
+    if (i < span->min)
+	span->min = i;
+    if (i + 1 > span->max)
+	span->max = i + 1;
+}
+
+static force_inline void
+add_cover (coverage_cells_t *cells, cell_span_t *span, int sign, int32_t h)
+{
+    cells->cover[0] += sign * (h << 8);
+
+    span->min = 0;
+    if (span->max < 0)
+	span->max = 0;
+}
+
+/* Add the piece of an edge going from @xa to @xb over a height of @h
+ * within one pixel row. @sign is 1 for a left edge and -1 for a right
+ * edge.
+ */
+static void
+add_edge (coverage_cells_t *cells, cell_span_t *span, int sign,
+	  pixman_fixed_48_16_t xa, pixman_fixed_48_16_t xb, int32_t h)
+{
+    pixman_fixed_48_16_t dx, u, v, end, col;
+    int32_t y, y_next;
+    int i;
+
+    if (xa > xb)
+    {
+	pixman_fixed_48_16_t tmp = xa;
+
+	xa = xb;
+	xb = tmp;
+    }
+
+    if (xa == xb)
+    {
+	if (xa < cells->lo)
+	{
+	    add_cover (cells, span, sign, h);
+	}
+	else if (xa < cells->hi)
+	{
+	    i = (xa - cells->lo) >> 16;
+	    col = cells->lo + ((pixman_fixed_48_16_t) i << 16);
+
+	    add_cell (cells, span, sign, i, xa - col, h);
+	}
+
+	return;
+    }
+
+    dx = xb - xa;
+    u = xa;
+    y = 0;
+
+    /* Left of the image the edge covers everything to its right */
+    if (u < cells->lo)
+    {
+	v = MIN (xb, cells->lo);
+	y = (v == xb) ? h : (int32_t) ((v - xa) * h / dx);
+
+	add_cover (cells, span, sign, y);
+
+	u = v;
+    }
+
+    end = MIN (xb, cells->hi);
+
+    while (u < end)
+    {
+	i = (u - cells->lo) >> 16;
+	col = cells->lo + ((pixman_fixed_48_16_t) i << 16);
+
+	v = MIN (end, col + pixman_fixed_1);
+	y_next = (v == xb) ? h : (int32_t) ((v - xa) * h / dx);
+
+	add_cell (cells, span, sign, i, ((u + v) >> 1) - col, y_next - y);
+
+	u = v;
+	y = y_next;
+    }
+}
+
+static force_inline int
+coverage_to_alpha (int32_t c)
+{
+    if (c <= 0)
+	return 0;
+    if (c >= CELL_FULL)
+	return 255;
+
+    return ((uint32_t) c * 255 + (CELL_FULL >> 1)) >> 24;
+}
+
+/* Add the cells in [@from, @to) to the row and clear them */
+static int32_t
+sweep_cells (pixman_image_t *image, uint8_t *ap, coverage_cells_t *cells,
+	     int from, int to, int32_t acc)
+{
+    int i;
+
+    for (i = from; i < to; ++i)
+    {
+	int a;
+
+	acc += cells->cover[i];
+	a = coverage_to_alpha (acc + cells->area[i]);
+
+	cells->cover[i] = 0;
+	cells->area[i] = 0;
+
+	if (a)
+	    WRITE (image, ap + i, clip255 (READ (image, ap + i) + a));
+    }
+
+    return acc;
+}
+
+static void
+fill_cells (pixman_image_t *image, uint8_t *ap, int from, int to, int32_t acc)
+{
+    int a = coverage_to_alpha (acc);
+
+    if (from >= to || !a)
+	return;
+
+    if (a == 255)
+	MEMSET_WRAPPED (image, ap + from, 0xff, to - from);
+    else
+	ADD_SATURATE_8 (ap + from, a, to - from);
+}
+
+static void
+add_cells_to_row (pixman_image_t *image, uint8_t *ap, coverage_cells_t *cells,
+		  cell_span_t *l, cell_span_t *r)
+{
+    cell_span_t *s1, *s2;
+    int32_t acc;
+    int i;
+
+    if (l->max < l->min)
+	l->min = l->max = cells->n;
+    if (r->max < r->min)
+	r->min = r->max = cells->n;
+
+    s1 = l->min <= r->min ? l : r;
+    s2 = l->min <= r->min ? r : l;
+
+    if (s1->max < s2->min)
+    {
+	/* The edges are apart, the pixels between them form one span */
+	acc = sweep_cells (image, ap, cells, s1->min, s1->max, 0);
+
+	acc += cells->cover[s1->max];
+	cells->cover[s1->max] = 0;
+
+	fill_cells (image, ap, s1->max, s2->min, acc);
+
+	acc = sweep_cells (image, ap, cells, s2->min, s2->max, acc);
+	i = s2->max;
+    }
+    else
+    {
+	i = MAX (s1->max, s2->max);
+	acc = sweep_cells (image, ap, cells, s1->min, i, 0);
+    }
+
+    /* Only non-zero when the right edge is beyond the image */
+    acc += cells->cover[i];
+    cells->cover[i] = 0;
+
+    fill_cells (image, ap, i, cells->n, acc);
+}
+
+#ifndef PIXMAN_FB_ACCESSORS
+static
+#endif
+void
+PIXMAN_RASTERIZE_TRAPEZOID_ANALYTIC (pixman_image_t            *image,
+				     pixman_fixed_t             top,
+				     pixman_fixed_t             bottom,
+				     const pixman_line_fixed_t *left,
+				     const pixman_line_fixed_t *right)
+{
+    int32_t stack_cells[512];
+    coverage_cells_t cells;
+    pixman_fixed_48_16_t xl0, xr0, xl1, xr1, xmin, xmax;
+    uint32_t *line;
+    int stride = image->bits.rowstride;
+    int width = image->bits.width;
+    int32_t *buf;
+    int x0, x1;
+    pixman_fixed_t y;
+
+    xl0 = line_x (left, top);
+    xr0 = line_x (right, top);
+    xl1 = line_x (left, bottom);
+    xr1 = line_x (right, bottom);
+
+    xmin = MIN (MIN (xl0, xl1), MIN (xr0, xr1));
+    xmax = MAX (MAX (xl0, xl1), MAX (xr0, xr1));
+
+    x0 = MAX (xmin, 0) >> 16;
+    x1 = MIN ((xmax + pixman_fixed_1 - pixman_fixed_e) >> 16, width);
+
+    if (x0 >= x1)
+	return;
+
+    cells.n = x1 - x0;
+    cells.lo = (pixman_fixed_48_16_t) x0 << 16;
+    cells.hi = (pixman_fixed_48_16_t) x1 << 16;
+
+    buf = stack_cells;
+    if (2 * cells.n + 1 > (int) (sizeof (stack_cells) / sizeof (stack_cells[0])))
+    {
+	if (!(buf = pixman_malloc_ab (2 * cells.n + 1, sizeof (int32_t))))
+	    return;
+    }
+
+    memset (buf, 0, (2 * cells.n + 1) * sizeof (int32_t));
+    cells.area = buf;
+    cells.cover = buf + cells.n;
+
+    line = image->bits.bits + pixman_fixed_to_int (top) * stride;
+
+    for (y = top; y < bottom; )
+    {
+	pixman_fixed_t y_next = MIN (pixman_fixed_floor (y) + pixman_fixed_1,
+				     bottom);
+	int32_t h = y_next - y;
+	pixman_fixed_48_16_t d0, d1;
+	cell_span_t l = { INT32_MAX, -1 }, r = { INT32_MAX, -1 };
+
+	xl1 = line_x (left, y_next);
+	xr1 = line_x (right, y_next);
+
+	d0 = xr0 - xl0;
+	d1 = xr1 - xl1;
+
+	if (d0 >= 0 && d1 >= 0)
+	{
+	    add_edge (&cells, &l, 1, xl0, xl1, h);
+	    add_edge (&cells, &r, -1, xr0, xr1, h);
+	}
+	else if (d0 > 0 || d1 > 0)
+	{
+	    /* The edges cross within the row, only the part where the
+	     * left edge is on the left counts.
+	     */
+	    int32_t hm = d0 * h / (d0 - d1);
+	    pixman_fixed_48_16_t xlm = xl0 + (xl1 - xl0) * hm / h;
+	    pixman_fixed_48_16_t xrm = xr0 + (xr1 - xr0) * hm / h;
+
+	    if (d0 > 0)
+	    {
+		add_edge (&cells, &l, 1, xl0, xlm, hm);
+		add_edge (&cells, &r, -1, xr0, xrm, hm);
+	    }
+	    else
+	    {
+		add_edge (&cells, &l, 1, xlm, xl1, h - hm);
+		add_edge (&cells, &r, -1, xrm, xr1, h - hm);
+	    }
+	}
+
+	add_cells_to_row (image, (uint8_t *) line + x0, &cells, &l, &r);
+
+	xl0 = xl1;
+	xr0 = xr1;
+	y = y_next;
+	line += stride;
+    }
+
+    if (buf != stack_cells)
+	free (buf);
+}
+
 #ifndef PIXMAN_FB_ACCESSORS
 static
 #endif
@@ -373,13 +713,73 @@ pixman_rasterize_edges (pixman_image_t *image,
                         pixman_fixed_t  t,
                         pixman_fixed_t  b)
 {
+    pixman_box32_t box;
+
     return_if_fail (image->type == BITS);
     return_if_fail (PIXMAN_FORMAT_TYPE (image->bits.format) == PIXMAN_TYPE_A);
-    
+
+    box.x1 = 0;
+    box.y1 = pixman_fixed_to_int (t);
+    box.x2 = image->bits.width;
+    box.y2 = pixman_fixed_to_int (pixman_fixed_ceil (b)) + 1;
+
+    _pixman_image_invalidate_mipmap (image);
+
+    _pixman_image_access (image, &box, 1, 0, 0,
+			  PIXMAN_ACCESS_READ | PIXMAN_ACCESS_WRITE, FALSE);
+
     if (image->bits.read_func || image->bits.write_func)
 	pixman_rasterize_edges_accessors (image, l, r, t, b);
     else
 	pixman_rasterize_edges_no_accessors (image, l, r, t, b);
+
+    _pixman_image_access (image, &box, 1, 0, 0,
+			  PIXMAN_ACCESS_READ | PIXMAN_ACCESS_WRITE, TRUE);
+}
+
+/* Add the exact coverage of the trapezoid between @top and @bottom and
+ * bounded by @left and @right to an 8 bpp alpha image.
+ */
+void
+_pixman_rasterize_trapezoid_analytic (pixman_image_t            *image,
+                                      pixman_fixed_t             top,
+                                      pixman_fixed_t             bottom,
+                                      const pixman_line_fixed_t *left,
+                                      const pixman_line_fixed_t *right)
+{
+    pixman_box32_t box;
+
+    if (top < 0)
+	top = 0;
+    if (pixman_fixed_to_int (bottom) >= image->bits.height)
+	bottom = pixman_int_to_fixed (image->bits.height);
+
+    if (bottom <= top)
+	return;
+
+    box.x1 = 0;
+    box.y1 = pixman_fixed_to_int (top);
+    box.x2 = image->bits.width;
+    box.y2 = pixman_fixed_to_int (pixman_fixed_ceil (bottom));
+
+    _pixman_image_invalidate_mipmap (image);
+
+    _pixman_image_access (image, &box, 1, 0, 0,
+			  PIXMAN_ACCESS_READ | PIXMAN_ACCESS_WRITE, FALSE);
+
+    if (image->bits.read_func || image->bits.write_func)
+    {
+	pixman_rasterize_trapezoid_analytic_accessors (
+	    image, top, bottom, left, right);
+    }
+    else
+    {
+	pixman_rasterize_trapezoid_analytic_no_accessors (
+	    image, top, bottom, left, right);
+    }
+
+    _pixman_image_access (image, &box, 1, 0, 0,
+			  PIXMAN_ACCESS_READ | PIXMAN_ACCESS_WRITE, TRUE);
 }
 
 #endif
@@ -1122,6 +1122,240 @@ fast_composite_over_n_1_0565 (pixman_implementation_t *imp,
     }
 }
 
+/*
+ * Separable PDF blend modes with a solid source. The source terms are
+ * worked out once per composite, or once per mask value, and the
+ * results are the same as those of the combiners in
+ * pixman-combine32.c.
+ */
+typedef struct
+{
+    uint32_t src;
+    int32_t  sa, isa;
+    int32_t  red, green, blue;
+} solid_blend_t;
+
+typedef uint32_t (* solid_blend_pixel_t) (const solid_blend_t *sb, uint32_t d);
+
+static force_inline void
+solid_blend_init (solid_blend_t *sb, uint32_t src)
+{
+    sb->src = src;
+    sb->sa = ALPHA_8 (src);
+    sb->isa = MASK - sb->sa;
+    sb->red = RED_8 (src);
+    sb->green = GREEN_8 (src);
+    sb->blue = BLUE_8 (src);
+}
+
+/* da * 0xff + sa * 0xff - sa * da, which needs no clamping */
+static force_inline uint32_t
+solid_blend_alpha (const solid_blend_t *sb, int32_t da)
+{
+    return DIV_ONE_UN8 (sb->sa * MASK + sb->isa * da) << A_SHIFT;
+}
+
+static force_inline uint32_t
+solid_blend_channel (const solid_blend_t *sb, int32_t s, int32_t d, int32_t da,
+		     int32_t (* blend) (int32_t d, int32_t ad,
+					int32_t s, int32_t as))
+{
+    int32_t r = sb->isa * d + (MASK - da) * s + blend (d, da, s, sb->sa);
+
+    return DIV_ONE_UN8 (CLIP (r, 0, 255 * 255));
+}
+
+static force_inline uint32_t
+solid_blend_separable (const solid_blend_t *sb, uint32_t d,
+		       int32_t (* blend) (int32_t d, int32_t ad,
+					  int32_t s, int32_t as))
+{
+    int32_t da = ALPHA_8 (d);
+
+    return solid_blend_alpha (sb, da) |
+	solid_blend_channel (sb, sb->red, RED_8 (d), da, blend) << R_SHIFT |
+	solid_blend_channel (sb, sb->green, GREEN_8 (d), da, blend) << G_SHIFT |
+	solid_blend_channel (sb, sb->blue, BLUE_8 (d), da, blend);
+}
+
+/*
+ * Screen and exclusion come down to 255 * s + (255 - s) * d and
+ * 255 * s + (255 - 2 * s) * d, which are always in range and do not
+ * depend on the destination alpha.
+ */
+static force_inline uint32_t
+solid_blend_linear_channel (int32_t s, int32_t d, int32_t n)
+{
+    return DIV_ONE_UN8 (MASK * s + (MASK - n * s) * d);
+}
+
+static force_inline uint32_t
+solid_blend_linear (const solid_blend_t *sb, uint32_t d, int32_t n)
+{
+    return solid_blend_alpha (sb, ALPHA_8 (d)) |
+	solid_blend_linear_channel (sb->red, RED_8 (d), n) << R_SHIFT |
+	solid_blend_linear_channel (sb->green, GREEN_8 (d), n) << G_SHIFT |
+	solid_blend_linear_channel (sb->blue, BLUE_8 (d), n);
+}
+
+static force_inline uint32_t
+solid_blend_screen (const solid_blend_t *sb, uint32_t d)
+{
+    return solid_blend_linear (sb, d, 1);
+}
+
+static force_inline uint32_t
+solid_blend_exclusion (const solid_blend_t *sb, uint32_t d)
+{
+    return solid_blend_linear (sb, d, 2);
+}
+
+static force_inline uint32_t
+solid_blend_multiply (const solid_blend_t *sb, uint32_t d)
+{
+    uint32_t ss = sb->src;
+    uint32_t dest_ia = ALPHA_8 (~d);
+
+    UN8x4_MUL_UN8_ADD_UN8x4_MUL_UN8 (ss, dest_ia, d, sb->isa);
+    UN8x4_MUL_UN8x4 (d, sb->src);
+    UN8x4_ADD_UN8x4 (d, ss);
+
+    return d;
+}
+
+/* x8r8g8b8 and x8b8g8r8 destinations are blended as opaque */
+static force_inline uint32_t
+solid_blend_dest_alpha (pixman_image_t *dest_image)
+{
+    return PIXMAN_FORMAT_A (dest_image->bits.format) ? 0 : A_MASK;
+}
+
+static force_inline void
+solid_blend_n_8888 (pixman_implementation_t *imp,
+		    pixman_composite_info_t *info,
+		    solid_blend_pixel_t      blend_pixel)
+{
+    PIXMAN_COMPOSITE_ARGS (info);
+    uint32_t src, dest_alpha;
+    uint32_t *dst_line, *dst;
+    int dst_stride;
+    solid_blend_t sb;
+    int32_t w;
+
+    src = _pixman_image_get_solid (imp, src_image, dest_image->bits.format);
+
+    /* A clear source leaves the destination alone in every mode */
+    if (src == 0)
+	return;
+
+    solid_blend_init (&sb, src);
+    dest_alpha = solid_blend_dest_alpha (dest_image);
+
+    PIXMAN_IMAGE_GET_LINE (dest_image, dest_x, dest_y, uint32_t, dst_stride, dst_line, 1);
+
+    while (height--)
+    {
+	dst = dst_line;
+	dst_line += dst_stride;
+	w = width;
+
+	while (w--)
+	{
+	    *dst = blend_pixel (&sb, *dst | dest_alpha);
+	    dst++;
+	}
+    }
+}
+
+static force_inline void
+solid_blend_n_8_8888 (pixman_implementation_t *imp,
+		      pixman_composite_info_t *info,
+		      solid_blend_pixel_t      blend_pixel)
+{
+    PIXMAN_COMPOSITE_ARGS (info);
+    uint32_t src, dest_alpha;
+    uint32_t *dst_line, *dst;
+    uint8_t *mask_line, *mask, m, last_m;
+    int dst_stride, mask_stride;
+    solid_blend_t sb, masked;
+    int32_t w;
+
+    src = _pixman_image_get_solid (imp, src_image, dest_image->bits.format);
+
+    if (src == 0)
+	return;
+
+    solid_blend_init (&sb, src);
+    masked = sb;
+    last_m = 0xff;
+    dest_alpha = solid_blend_dest_alpha (dest_image);
+
+    PIXMAN_IMAGE_GET_LINE (dest_image, dest_x, dest_y, uint32_t, dst_stride, dst_line, 1);
+    PIXMAN_IMAGE_GET_LINE (mask_image, mask_x, mask_y, uint8_t, mask_stride, mask_line, 1);
+
+    while (height--)
+    {
+	dst = dst_line;
+	dst_line += dst_stride;
+	mask = mask_line;
+	mask_line += mask_stride;
+	w = width;
+
+	while (w--)
+	{
+	    m = *mask++;
+	    if (m == 0xff)
+	    {
+		*dst = blend_pixel (&sb, *dst | dest_alpha);
+	    }
+	    else if (m)
+	    {
+		/* Antialiased edges tend to repeat mask values */
+		if (m != last_m)
+		{
+		    solid_blend_init (&masked, in (src, m));
+		    last_m = m;
+		}
+		*dst = blend_pixel (&masked, *dst | dest_alpha);
+	    }
+	    dst++;
+	}
+    }
+}
+
+#define SOLID_BLEND_FAST_PATHS(name, blend_pixel)			\
+    static void								\
+    fast_composite_ ## name ## _n_8888 (pixman_implementation_t *imp,	\
+					pixman_composite_info_t *info)	\
+    {									\
+	solid_blend_n_8888 (imp, info, blend_pixel);			\
+    }									\
+									\
+    static void								\
+    fast_composite_ ## name ## _n_8_8888 (pixman_implementation_t *imp, \
+					  pixman_composite_info_t *info) \
+    {									\
+	solid_blend_n_8_8888 (imp, info, blend_pixel);			\
+    }
+
+#define SOLID_BLEND_SEPARABLE(name)					\
+    static force_inline uint32_t					\
+    solid_blend_ ## name (const solid_blend_t *sb, uint32_t d)		\
+    {									\
+	return solid_blend_separable (sb, d, blend_ ## name);		\
+    }									\
+									\
+    SOLID_BLEND_FAST_PATHS (name, solid_blend_ ## name)
+
+SOLID_BLEND_FAST_PATHS (multiply, solid_blend_multiply)
+SOLID_BLEND_FAST_PATHS (screen, solid_blend_screen)
+SOLID_BLEND_FAST_PATHS (exclusion, solid_blend_exclusion)
+SOLID_BLEND_SEPARABLE (overlay)
+SOLID_BLEND_SEPARABLE (darken)
+SOLID_BLEND_SEPARABLE (lighten)
+SOLID_BLEND_SEPARABLE (hard_light)
+SOLID_BLEND_SEPARABLE (difference)
+
 /*
  * Simple bitblt
  */
@@ -1182,6 +1416,285 @@ fast_composite_src_memcpy (pixman_implementation_t *imp,
     }
 }
 
+/*
+ * a16b16g16r16 paths. These work on 16 bit integers, so they don't
+ * need to go through the float pipeline of the general implementation.
+ * Converting down keeps the top byte of each channel, which is what
+ * storing the float value does.
+ */
+static force_inline uint64_t
+expand_8888_to_16161616 (uint32_t s)
+{
+    uint64_t a = s >> 24;
+    uint64_t r = (s >> 16) & 0xff;
+    uint64_t g = (s >> 8) & 0xff;
+    uint64_t b = s & 0xff;
+
+    return ((a << 48) | (b << 32) | (g << 16) | r) * 0x101;
+}
+
+static force_inline uint32_t
+contract_16161616_to_8888 (uint64_t s)
+{
+    return (uint32_t)(((s >> 56) << 24)		|
+		      (((s >> 8) & 0xff) << 16)	|
+		      (((s >> 24) & 0xff) << 8)	|
+		      ((s >> 40) & 0xff));
+}
+
+/* x * y / 65535, rounded */
+static force_inline uint32_t
+mul_un16 (uint32_t x, uint32_t y)
+{
+    uint32_t t = x * y + 0x8000;
+
+    return (t + (t >> 16)) >> 16;
+}
+
+static force_inline uint64_t
+add_16161616 (uint64_t s, uint64_t d)
+{
+    uint64_t result = 0;
+    int shift;
+
+    for (shift = 0; shift < 64; shift += 16)
+    {
+	uint32_t c = ((s >> shift) & 0xffff) + ((d >> shift) & 0xffff);
+
+	result |= (uint64_t)MIN (c, 0xffff) << shift;
+    }
+
+    return result;
+}
+
+static force_inline uint64_t
+over_16161616 (uint64_t s, uint64_t d)
+{
+    uint32_t ia = 0xffff - (s >> 48);
+    uint64_t result = 0;
+    int shift;
+
+    if (ia == 0)
+	return s;
+
+    for (shift = 0; shift < 64; shift += 16)
+    {
+	uint32_t c = ((s >> shift) & 0xffff) +
+	    mul_un16 ((d >> shift) & 0xffff, ia);
+
+	result |= (uint64_t)MIN (c, 0xffff) << shift;
+    }
+
+    return result;
+}
+
+static void
+fast_composite_src_8888_16161616 (pixman_implementation_t *imp,
+				  pixman_composite_info_t *info)
+{
+    PIXMAN_COMPOSITE_ARGS (info);
+    uint64_t    *dst_line, *dst;
+    uint32_t    *src_line, *src;
+    uint32_t    alpha;
+    int dst_stride, src_stride;
+    int32_t w;
+
+    alpha = PIXMAN_FORMAT_A (src_image->bits.format) ? 0 : 0xff000000;
+
+    PIXMAN_IMAGE_GET_LINE (dest_image, dest_x, dest_y, uint64_t, dst_stride, dst_line, 1);
+    PIXMAN_IMAGE_GET_LINE (src_image, src_x, src_y, uint32_t, src_stride, src_line, 1);
+
+    while (height--)
+    {
+	dst = dst_line;
+	dst_line += dst_stride;
+	src = src_line;
+	src_line += src_stride;
+	w = width;
+
+	while (w--)
+	    *dst++ = expand_8888_to_16161616 (*src++ | alpha);
+    }
+}
+
+static void
+fast_composite_src_16161616_8888 (pixman_implementation_t *imp,
+				  pixman_composite_info_t *info)
+{
+    PIXMAN_COMPOSITE_ARGS (info);
+    uint32_t    *dst_line, *dst;
+    uint64_t    *src_line, *src;
+    int dst_stride, src_stride;
+    int32_t w;
+
+    PIXMAN_IMAGE_GET_LINE (dest_image, dest_x, dest_y, uint32_t, dst_stride, dst_line, 1);
+    PIXMAN_IMAGE_GET_LINE (src_image, src_x, src_y, uint64_t, src_stride, src_line, 1);
+
+    while (height--)
+    {
+	dst = dst_line;
+	dst_line += dst_stride;
+	src = src_line;
+	src_line += src_stride;
+	w = width;
+
+	while (w--)
+	    *dst++ = contract_16161616_to_8888 (*src++);
+    }
+}
+
+static void
+fast_composite_over_8888_16161616 (pixman_implementation_t *imp,
+				   pixman_composite_info_t *info)
+{
+    PIXMAN_COMPOSITE_ARGS (info);
+    uint64_t    *dst_line, *dst;
+    uint32_t    *src_line, *src, s;
+    int dst_stride, src_stride;
+    int32_t w;
+
+    PIXMAN_IMAGE_GET_LINE (dest_image, dest_x, dest_y, uint64_t, dst_stride, dst_line, 1);
+    PIXMAN_IMAGE_GET_LINE (src_image, src_x, src_y, uint32_t, src_stride, src_line, 1);
+
+    while (height--)
+    {
+	dst = dst_line;
+	dst_line += dst_stride;
+	src = src_line;
+	src_line += src_stride;
+	w = width;
+
+	while (w--)
+	{
+	    s = *src++;
+	    if (s >= 0xff000000)
+		*dst = expand_8888_to_16161616 (s);
+	    else if (s)
+		*dst = over_16161616 (expand_8888_to_16161616 (s), *dst);
+	    dst++;
+	}
+    }
+}
+
+static void
+fast_composite_over_16161616_16161616 (pixman_implementation_t *imp,
+				       pixman_composite_info_t *info)
+{
+    PIXMAN_COMPOSITE_ARGS (info);
+    uint64_t    *dst_line, *dst;
+    uint64_t    *src_line, *src, s;
+    int dst_stride, src_stride;
+    int32_t w;
+
+    PIXMAN_IMAGE_GET_LINE (dest_image, dest_x, dest_y, uint64_t, dst_stride, dst_line, 1);
+    PIXMAN_IMAGE_GET_LINE (src_image, src_x, src_y, uint64_t, src_stride, src_line, 1);
+
+    while (height--)
+    {
+	dst = dst_line;
+	dst_line += dst_stride;
+	src = src_line;
+	src_line += src_stride;
+	w = width;
+
+	while (w--)
+	{
+	    s = *src++;
+	    if (s)
+		*dst = over_16161616 (s, *dst);
+	    dst++;
+	}
+    }
+}
+
+static void
+fast_composite_add_16161616_16161616 (pixman_implementation_t *imp,
+				      pixman_composite_info_t *info)
+{
+    PIXMAN_COMPOSITE_ARGS (info);
+    uint64_t    *dst_line, *dst;
+    uint64_t    *src_line, *src, s;
+    int dst_stride, src_stride;
+    int32_t w;
+
+    PIXMAN_IMAGE_GET_LINE (dest_image, dest_x, dest_y, uint64_t, dst_stride, dst_line, 1);
+    PIXMAN_IMAGE_GET_LINE (src_image, src_x, src_y, uint64_t, src_stride, src_line, 1);
+
+    while (height--)
+    {
+	dst = dst_line;
+	dst_line += dst_stride;
+	src = src_line;
+	src_line += src_stride;
+	w = width;
+
+	while (w--)
+	{
+	    s = *src++;
+	    if (s)
+		*dst = add_16161616 (s, *dst);
+	    dst++;
+	}
+    }
+}
+
+/*
+ * Conversions between rgba_float and rgba_half. Both formats store
+ * r, g, b, a in memory, so each channel converts on its own. Values are
+ * not clamped, so colors outside [0, 1] survive the round trip.
+ */
+static void
+fast_composite_src_rgbaf_rgbah (pixman_implementation_t *imp,
+				pixman_composite_info_t *info)
+{
+    PIXMAN_COMPOSITE_ARGS (info);
+    pixman_float_bits_t *src, *src_line;
+    uint16_t *dst, *dst_line;
+    int dst_stride, src_stride;
+    int32_t w;
+
+    PIXMAN_IMAGE_GET_LINE (dest_image, dest_x, dest_y, uint16_t, dst_stride, dst_line, 4);
+    PIXMAN_IMAGE_GET_LINE (src_image, src_x, src_y, pixman_float_bits_t, src_stride, src_line, 4);
+
+    while (height--)
+    {
+	dst = dst_line;
+	dst_line += dst_stride;
+	src = src_line;
+	src_line += src_stride;
+	w = width * 4;
+
+	while (w--)
+	    *dst++ = pixman_float_to_half ((src++)->f);
+    }
+}
+
+static void
+fast_composite_src_rgbah_rgbaf (pixman_implementation_t *imp,
+				pixman_composite_info_t *info)
+{
+    PIXMAN_COMPOSITE_ARGS (info);
+    pixman_float_bits_t *dst, *dst_line;
+    uint16_t *src, *src_line;
+    int dst_stride, src_stride;
+    int32_t w;
+
+    PIXMAN_IMAGE_GET_LINE (dest_image, dest_x, dest_y, pixman_float_bits_t, dst_stride, dst_line, 4);
+    PIXMAN_IMAGE_GET_LINE (src_image, src_x, src_y, uint16_t, src_stride, src_line, 4);
+
+    while (height--)
+    {
+	dst = dst_line;
+	dst_line += dst_stride;
+	src = src_line;
+	src_line += src_stride;
+	w = width * 4;
+
+	while (w--)
+	    (dst++)->f = pixman_half_to_float (*src++);
+    }
+}
+
 FAST_NEAREST (8888_8888_cover, 8888, 8888, uint32_t, uint32_t, SRC, COVER)
 FAST_NEAREST (8888_8888_none, 8888, 8888, uint32_t, uint32_t, SRC, NONE)
 FAST_NEAREST (8888_8888_pad, 8888, 8888, uint32_t, uint32_t, SRC, PAD)
@@ -1204,6 +1717,141 @@ FAST_NEAREST (8888_565_pad, 8888, 0565, uint32_t, uint16_t, OVER, PAD)
 FAST_NEAREST (8888_565_normal, 8888, 0565, uint32_t, uint16_t, OVER, NORMAL)
 
 #define REPEAT_MIN_WIDTH    32
+#define REPEAT_MIN_HEIGHT   16
+#define REPEAT_BUFFER_SIZE  (128 * 1024)
+#define REPEAT_STACK_SIZE   (16 * 1024)
+
+/* Lays out source rows sy .. sy + n_rows - 1, wrapped around the tile,
+ * one per buffer row. Each row starts at source column sx and repeats
+ * out to row_bytes, doubling up what has been copied so far.
+ */
+static void
+expand_tile_rows (bits_image_t *src,
+		  int           sx,
+		  int           sy,
+		  uint8_t *     buffer,
+		  int           stride,
+		  int           row_bytes,
+		  int           n_rows)
+{
+    int bpp = PIXMAN_FORMAT_BPP (src->format) >> 3;
+    int tile_bytes = src->width * bpp;
+    int phase = sx * bpp;
+    int y, n, c;
+
+    for (y = 0; y < n_rows; ++y)
+    {
+	uint8_t *s = (uint8_t *)(src->bits + MOD (sy + y, src->height) * src->rowstride);
+	uint8_t *d = buffer + y * stride;
+
+	n = MIN (tile_bytes - phase, row_bytes);
+	memcpy (d, s + phase, n);
+
+	if (n < row_bytes)
+	{
+	    c = MIN (phase, row_bytes - n);
+	    memcpy (d + n, s, c);
+	    n += c;
+	}
+
+	while (n < row_bytes)
+	{
+	    c = MIN (n, row_bytes - n);
+	    memcpy (d + n, d, c);
+	    n += c;
+	}
+    }
+}
+
+/* Composites a source that is narrower than the destination by
+ * expanding its tiles into a buffer as wide as the composite, so that
+ * func runs once per band of rows instead of once per tile per row.
+ * When whole tiles fit in the buffer it is filled once and every band
+ * reuses it; otherwise narrow sources are refilled for each band.
+ * Returns FALSE when the source does not qualify.
+ */
+static pixman_bool_t
+fast_composite_tiled_repeat_expanded (pixman_implementation_t *imp,
+				      pixman_composite_func_t  func,
+				      pixman_composite_info_t *info)
+{
+    PIXMAN_COMPOSITE_ARGS (info);
+    pixman_composite_info_t info2 = *info;
+    bits_image_t *src = &src_image->bits;
+    pixman_image_t expanded_image;
+    uint32_t stack_buffer[REPEAT_STACK_SIZE / sizeof (uint32_t)];
+    uint8_t *buffer;
+    int bpp = PIXMAN_FORMAT_BPP (src->format);
+    int sx, sy, stride, row_bytes, max_rows, n_rows, y, h;
+    pixman_bool_t refill;
+
+    if ((bpp & 7) || src->indexed || src->width >= width)
+	return FALSE;
+
+    sx = MOD (src_x, src->width);
+    sy = MOD (src_y, src->height);
+    row_bytes = width * (bpp >> 3);
+    stride = (row_bytes + 15) & ~15;
+    max_rows = REPEAT_BUFFER_SIZE / stride;
+
+    if (max_rows >= src->height)
+    {
+	n_rows = src->height;
+	while (n_rows < REPEAT_MIN_HEIGHT && n_rows + src->height <= max_rows)
+	    n_rows += src->height;
+
+	refill = FALSE;
+    }
+    else if (max_rows > 0 && src->width < REPEAT_MIN_WIDTH)
+    {
+	n_rows = MIN (max_rows, REPEAT_MIN_HEIGHT);
+	refill = TRUE;
+    }
+    else
+    {
+	return FALSE;
+    }
+
+    n_rows = MIN (n_rows, height);
+
+    if (stride * n_rows <= (int) sizeof (stack_buffer))
+	buffer = (uint8_t *)stack_buffer;
+    else if (!(buffer = malloc (stride * n_rows)))
+	return FALSE;
+
+    _pixman_bits_image_init (&expanded_image, src->format,
+			     width, n_rows, (uint32_t *)buffer,
+			     stride / (int) sizeof (uint32_t),
+			     PIXMAN_BITS_NO_CLEAR);
+    _pixman_image_validate (&expanded_image);
+
+    info2.src_image = &expanded_image;
+    info2.src_x = 0;
+    info2.src_y = 0;
+
+    expand_tile_rows (src, sx, sy, buffer, stride, row_bytes, n_rows);
+
+    for (y = 0; y < height; y += h)
+    {
+	h = MIN (n_rows, height - y);
+
+	if (refill && y > 0)
+	    expand_tile_rows (src, sx, sy + y, buffer, stride, row_bytes, h);
+
+	info2.mask_y = mask_y + y;
+	info2.dest_y = dest_y + y;
+	info2.height = h;
+
+	func (imp, &info2);
+    }
+
+    _pixman_image_fini (&expanded_image);
+
+    if (buffer != (uint8_t *)stack_buffer)
+	free (buffer);
+
+    return TRUE;
+}
 
 static void
 fast_composite_tiled_repeat (pixman_implementation_t *imp,
@@ -1216,6 +1864,7 @@ fast_composite_tiled_repeat (pixman_implementation_t *imp,
     int32_t sx, sy;
     int32_t width_remain;
     int32_t num_pixels;
+    int32_t num_rows;
     int32_t src_width;
     int32_t i, j;
     pixman_image_t extended_src_image;
@@ -1247,6 +1896,9 @@ fast_composite_tiled_repeat (pixman_implementation_t *imp,
 	dest_image->common.extended_format_code, info->dest_flags,
 	&imp, &func);
 
+    if (fast_composite_tiled_repeat_expanded (imp, func, info))
+	return;
+
     src_bpp = PIXMAN_FORMAT_BPP (src_image->bits.format);
 
     if (src_image->bits.width < REPEAT_MIN_WIDTH		&&
@@ -1266,7 +1918,7 @@ fast_composite_tiled_repeat (pixman_implementation_t *imp,
 	/* Initialize/validate stack-allocated temporary image */
 	_pixman_bits_image_init (&extended_src_image, src_image->bits.format,
 				 src_width, 1, &extended_src[0], src_stride,
-				 FALSE);
+				 PIXMAN_BITS_NO_CLEAR);
 	_pixman_image_validate (&extended_src_image);
 
 	info2.src_image = &extended_src_image;
@@ -1281,11 +1933,18 @@ fast_composite_tiled_repeat (pixman_implementation_t *imp,
     sx = src_x;
     sy = src_y;
 
-    while (--height >= 0)
+    while (height > 0)
     {
 	sx = MOD (sx, src_width);
 	sy = MOD (sy, src_image->bits.height);
 
+	/* Without the extension, rows up to the bottom of the tile are
+	 * contiguous in the source and go in one call.
+	 */
+	num_rows = need_src_extension ? 1 : src_image->bits.height - sy;
+	if (num_rows > height)
+	    num_rows = height;
+
 	if (need_src_extension)
 	{
 	    if (src_bpp == 32)
@@ -1345,7 +2004,7 @@ fast_composite_tiled_repeat (pixman_implementation_t *imp,
 
 	    info2.src_x = sx;
 	    info2.width = num_pixels;
-	    info2.height = 1;
+	    info2.height = num_rows;
 
 	    func (imp, &info2);
 
@@ -1356,11 +2015,12 @@ fast_composite_tiled_repeat (pixman_implementation_t *imp,
 	}
 
 	sx = src_x;
-	sy++;
+	sy += num_rows;
+	height -= num_rows;
 	info2.mask_x = info->mask_x;
-	info2.mask_y++;
+	info2.mask_y += num_rows;
 	info2.dest_x = info->dest_x;
-	info2.dest_y++;
+	info2.dest_y += num_rows;
     }
 
     if (need_src_extension)
@@ -1568,7 +2228,10 @@ fast_composite_scaled_nearest (pixman_implementation_t *imp,
 
 #define CACHE_LINE_SIZE 64
 
-#define FAST_SIMPLE_ROTATE(suffix, pix_type)                                  \
+#define ROTATE_SRC(s, d)	(s)
+#define ROTATE_OVER(s, d)	over (s, d)
+
+#define FAST_SIMPLE_ROTATE(suffix, pix_type, combine)                         \
                                                                               \
 static void                                                                   \
 blt_rotated_90_trivial_##suffix (pix_type       *dst,                         \
@@ -1585,7 +2248,8 @@ blt_rotated_90_trivial_##suffix (pix_type       *dst,                         \
 	pix_type *d = dst + dst_stride * y;                                   \
 	for (x = 0; x < w; x++)                                               \
 	{                                                                     \
-	    *d++ = *s;                                                        \
+	    *d = combine (*s, *d);                                            \
+	    d++;                                                              \
 	    s += src_stride;                                                  \
 	}                                                                     \
     }                                                                         \
@@ -1606,7 +2270,8 @@ blt_rotated_270_trivial_##suffix (pix_type       *dst,                        \
 	pix_type *d = dst + dst_stride * y;                                   \
 	for (x = 0; x < w; x++)                                               \
 	{                                                                     \
-	    *d++ = *s;                                                        \
+	    *d = combine (*s, *d);                                            \
+	    d++;                                                              \
 	    s -= src_stride;                                                  \
 	}                                                                     \
     }                                                                         \
@@ -1761,56 +2426,264 @@ blt_rotated_270_##suffix (pix_type       *dst,                                \
 }                                                                             \
                                                                               \
 static void                                                                   \
-fast_composite_rotate_90_##suffix (pixman_implementation_t *imp,              \
-				   pixman_composite_info_t *info)	      \
-{									      \
-    PIXMAN_COMPOSITE_ARGS (info);					      \
-    pix_type       *dst_line;						      \
-    pix_type       *src_line;                                                 \
-    int             dst_stride, src_stride;                                   \
-    int             src_x_t, src_y_t;                                         \
-                                                                              \
-    PIXMAN_IMAGE_GET_LINE (dest_image, dest_x, dest_y, pix_type,              \
-			   dst_stride, dst_line, 1);                          \
-    src_x_t = -src_y + pixman_fixed_to_int (                                  \
-				src_image->common.transform->matrix[0][2] +   \
-				pixman_fixed_1 / 2 - pixman_fixed_e) - height;\
-    src_y_t = src_x + pixman_fixed_to_int (                                   \
-				src_image->common.transform->matrix[1][2] +   \
-				pixman_fixed_1 / 2 - pixman_fixed_e);         \
-    PIXMAN_IMAGE_GET_LINE (src_image, src_x_t, src_y_t, pix_type,             \
-			   src_stride, src_line, 1);                          \
-    blt_rotated_90_##suffix (dst_line, dst_stride, src_line, src_stride,      \
-			     width, height);                                  \
+blt_flipped_##suffix (pix_type       *dst,                                    \
+		      int             dst_stride,                             \
+		      const pix_type *src,                                    \
+		      int             src_stride,                             \
+		      int             w,                                      \
+		      int             h)                                      \
+{                                                                             \
+    int x, y;                                                                 \
+                                                                              \
+    /* src points at the last pixel of the first row, and src_stride is       \
+     * negative when the rows are also taken bottom up                        \
+     */                                                                       \
+    for (y = 0; y < h; y++)                                                   \
+    {                                                                         \
+	const pix_type *s = src + src_stride * y;                             \
+	pix_type *d = dst + dst_stride * y;                                   \
+	for (x = 0; x < w; x++)                                               \
+	    d[x] = combine (s[-x], d[x]);                                     \
+    }                                                                         \
+}                                                                             \
+                                                                              \
+static void                                                                   \
+blt_rows_##suffix (pix_type       *dst,                                       \
+		   int             dst_stride,                                \
+		   const pix_type *src,                                       \
+		   int             src_stride,                                \
+		   int             w,                                         \
+		   int             h)                                         \
+{                                                                             \
+    int x, y;                                                                 \
+    for (y = 0; y < h; y++)                                                   \
+    {                                                                         \
+	const pix_type *s = src + src_stride * y;                             \
+	pix_type *d = dst + dst_stride * y;                                   \
+	for (x = 0; x < w; x++)                                               \
+	    d[x] = combine (s[x], d[x]);                                      \
+    }                                                                         \
 }                                                                             \
                                                                               \
 static void                                                                   \
-fast_composite_rotate_270_##suffix (pixman_implementation_t *imp,             \
-				    pixman_composite_info_t *info)            \
-{                                                                             \
+fast_composite_rotate_##suffix (pixman_implementation_t *imp,                 \
+				pixman_composite_info_t *info)                \
+{									      \
     PIXMAN_COMPOSITE_ARGS (info);					      \
     pix_type       *dst_line;						      \
     pix_type       *src_line;                                                 \
     int             dst_stride, src_stride;                                   \
     int             src_x_t, src_y_t;                                         \
+    uint32_t        src_flags = info->src_flags;                              \
                                                                               \
     PIXMAN_IMAGE_GET_LINE (dest_image, dest_x, dest_y, pix_type,              \
 			   dst_stride, dst_line, 1);                          \
-    src_x_t = src_y + pixman_fixed_to_int (                                   \
-				src_image->common.transform->matrix[0][2] +   \
-				pixman_fixed_1 / 2 - pixman_fixed_e);         \
-    src_y_t = -src_x + pixman_fixed_to_int (                                  \
-				src_image->common.transform->matrix[1][2] +   \
-				pixman_fixed_1 / 2 - pixman_fixed_e) - width; \
+    simple_rotate_get_src_origin (src_image, src_flags, src_x, src_y,         \
+				  width, height, &src_x_t, &src_y_t);         \
     PIXMAN_IMAGE_GET_LINE (src_image, src_x_t, src_y_t, pix_type,             \
 			   src_stride, src_line, 1);                          \
-    blt_rotated_270_##suffix (dst_line, dst_stride, src_line, src_stride,     \
+                                                                              \
+    if (src_flags & FAST_PATH_ROTATE_90_TRANSFORM)                            \
+    {                                                                         \
+	blt_rotated_90_##suffix (dst_line, dst_stride, src_line, src_stride,  \
+				 width, height);                              \
+    }                                                                         \
+    else if (src_flags & FAST_PATH_ROTATE_270_TRANSFORM)                      \
+    {                                                                         \
+	blt_rotated_270_##suffix (dst_line, dst_stride, src_line, src_stride, \
+				  width, height);                             \
+    }                                                                         \
+    else if (src_flags & FAST_PATH_ROTATE_180_TRANSFORM)                      \
+    {                                                                         \
+	src_line += src_stride * (height - 1) + width - 1;                    \
+	blt_flipped_##suffix (dst_line, dst_stride, src_line, -src_stride,    \
 			      width, height);                                 \
+    }                                                                         \
+    else if (src_flags & FAST_PATH_FLIP_X_TRANSFORM)                          \
+    {                                                                         \
+	blt_flipped_##suffix (dst_line, dst_stride, src_line + width - 1,     \
+			      src_stride, width, height);                     \
+    }                                                                         \
+    else                                                                      \
+    {                                                                         \
+	blt_rows_##suffix (dst_line, dst_stride,                              \
+			   src_line + src_stride * (height - 1),              \
+			   -src_stride, width, height);                       \
+    }                                                                         \
+}
+
+FAST_SIMPLE_ROTATE (8, uint8_t, ROTATE_SRC)
+FAST_SIMPLE_ROTATE (565, uint16_t, ROTATE_SRC)
+FAST_SIMPLE_ROTATE (8888, uint32_t, ROTATE_SRC)
+FAST_SIMPLE_ROTATE (over_8888, uint32_t, ROTATE_OVER)
+
+/*
+ * Fused single-pass kernels
+ *
+ * For common operator/format combinations that have no dedicated fast
+ * path, fetching, combining and storing each pixel in a single loop
+ * avoids the three scanline buffers and the indirect calls of the
+ * general implementation's general_composite_rect(). The per-pixel
+ * arithmetic is the same as in the unified alpha combiners in
+ * pixman-combine32.c, so the results are identical to those of the
+ * three-pass path.
+ *
+ * Where the destination is a8r8g8b8 or x8r8g8b8 the general path already
+ * combines in place with the SIMD combiners, and fused scalar code does
+ * not beat it. The kernels are therefore only instantiated for r5g6b5
+ * destinations, where the general path also has to convert the whole
+ * destination scanline in and out. The operators are those that
+ * lowlevel-blt-bench reports as reaching the general path for such
+ * destinations; as these have no alpha, operators like IN or ATOP are
+ * reduced to SRC or OVER before the lookup. Porter-Duff operators treat the color channels alike,
+ * so one kernel serves both the ARGB and the ABGR family of formats.
+ */
+static force_inline uint32_t
+fused_out_reverse (uint32_t s, uint32_t d)
+{
+    uint32_t a = ALPHA_8 (~s);
+
+    UN8x4_MUL_UN8 (d, a);
+
+    return d;
+}
+
+static force_inline uint32_t
+fused_add (uint32_t s, uint32_t d)
+{
+    UN8x4_ADD_UN8x4 (d, s);
+
+    return d;
+}
+
+static force_inline void
+fused_composite_mainloop (pixman_composite_info_t *info,
+			  int                      src_bpp,
+			  int                      dst_bpp,
+			  pixman_bool_t            have_mask,
+			  uint32_t (* load_src) (const void *),
+			  uint32_t (* load_dst) (const void *),
+			  void     (* store_dst) (void *, uint32_t),
+			  uint32_t (* combine) (uint32_t, uint32_t))
+{
+    PIXMAN_COMPOSITE_ARGS (info);
+    uint8_t *src_line, *dst_line, *mask_line = NULL;
+    int src_stride, dst_stride, mask_stride = 0;
+    int32_t w;
+
+    PIXMAN_IMAGE_GET_LINE (src_image, src_x, src_y, uint8_t, src_stride, src_line, src_bpp);
+    PIXMAN_IMAGE_GET_LINE (dest_image, dest_x, dest_y, uint8_t, dst_stride, dst_line, dst_bpp);
+    if (have_mask)
+	PIXMAN_IMAGE_GET_LINE (mask_image, mask_x, mask_y, uint8_t, mask_stride, mask_line, 1);
+
+    while (height--)
+    {
+	const uint8_t *src = src_line;
+	const uint8_t *mask = mask_line;
+	uint8_t *dst = dst_line;
+
+	src_line += src_stride;
+	dst_line += dst_stride;
+	if (have_mask)
+	    mask_line += mask_stride;
+
+	for (w = width; w > 0; w--)
+	{
+	    uint32_t s = load_src (src);
+
+	    if (have_mask)
+	    {
+		uint32_t m = *mask++;
+
+		if (m != 0xff)
+		    UN8x4_MUL_UN8 (s, m);
+	    }
+
+	    store_dst (dst, combine (s, load_dst (dst)));
+
+	    src += src_bpp;
+	    dst += dst_bpp;
+	}
+    }
+}
+
+static force_inline uint32_t
+fused_load_8888 (const void *p)
+{
+    return *(const uint32_t *)p;
+}
+
+static force_inline uint32_t
+fused_load_x888 (const void *p)
+{
+    return convert_x888_to_8888 (*(const uint32_t *)p);
 }
 
-FAST_SIMPLE_ROTATE (8, uint8_t)
-FAST_SIMPLE_ROTATE (565, uint16_t)
-FAST_SIMPLE_ROTATE (8888, uint32_t)
+static force_inline uint32_t
+fused_load_0565 (const void *p)
+{
+    return convert_0565_to_8888 (*(const uint16_t *)p);
+}
+
+static force_inline void
+fused_store_0565 (void *p, uint32_t v)
+{
+    *(uint16_t *)p = convert_8888_to_0565 (v);
+}
+
+#define FUSED_COMPOSITE(op, s, s_bpp, d, d_bpp)				\
+    static void								\
+    fused_composite_ ## op ## _ ## s ## _ ## d (				\
+	pixman_implementation_t *imp,					\
+	pixman_composite_info_t *info)					\
+    {									\
+	fused_composite_mainloop (info, s_bpp, d_bpp, FALSE,		\
+				  fused_load_ ## s, fused_load_ ## d,	\
+				  fused_store_ ## d, fused_ ## op);	\
+    }									\
+									\
+    static void								\
+    fused_composite_ ## op ## _ ## s ## _8_ ## d (			\
+	pixman_implementation_t *imp,					\
+	pixman_composite_info_t *info)					\
+    {									\
+	fused_composite_mainloop (info, s_bpp, d_bpp, TRUE,		\
+				  fused_load_ ## s, fused_load_ ## d,	\
+				  fused_store_ ## d, fused_ ## op);	\
+    }
+
+#define FUSED_COMPOSITE_ALL_FORMATS(op)					\
+    FUSED_COMPOSITE (op, 8888, 4, 0565, 2)				\
+    FUSED_COMPOSITE (op, x888, 4, 0565, 2)				\
+    FUSED_COMPOSITE (op, 0565, 2, 0565, 2)
+
+FUSED_COMPOSITE_ALL_FORMATS (out_reverse)
+FUSED_COMPOSITE_ALL_FORMATS (add)
+
+#define FUSED_FAST_PATH(op, name, s, s_name, d, d_name)			\
+    PIXMAN_STD_FAST_PATH (op, s, null, d,				\
+			  fused_composite_ ## name ## _ ## s_name ## _ ## d_name), \
+    PIXMAN_STD_FAST_PATH (op, s, a8, d,					\
+			  fused_composite_ ## name ## _ ## s_name ## _8_ ## d_name)
+
+#define FUSED_FAST_PATHS_FAMILY(op, name, argb, xrgb, rgb565)		\
+    FUSED_FAST_PATH (op, name, argb,   8888, rgb565, 0565),		\
+    FUSED_FAST_PATH (op, name, xrgb,   x888, rgb565, 0565),		\
+    FUSED_FAST_PATH (op, name, rgb565, 0565, rgb565, 0565)
+
+#define FUSED_FAST_PATHS(op, name)					\
+    FUSED_FAST_PATHS_FAMILY (op, name, a8r8g8b8, x8r8g8b8, r5g6b5),	\
+    FUSED_FAST_PATHS_FAMILY (op, name, a8b8g8r8, x8b8g8r8, b5g6r5)
+
+#define SOLID_BLEND_FAST_PATH(op, name)					\
+    PIXMAN_STD_FAST_PATH (op, solid, null, a8r8g8b8, fast_composite_ ## name ## _n_8888), \
+    PIXMAN_STD_FAST_PATH (op, solid, null, x8r8g8b8, fast_composite_ ## name ## _n_8888), \
+    PIXMAN_STD_FAST_PATH (op, solid, null, a8b8g8r8, fast_composite_ ## name ## _n_8888), \
+    PIXMAN_STD_FAST_PATH (op, solid, null, x8b8g8r8, fast_composite_ ## name ## _n_8888), \
+    PIXMAN_STD_FAST_PATH (op, solid, a8, a8r8g8b8, fast_composite_ ## name ## _n_8_8888), \
+    PIXMAN_STD_FAST_PATH (op, solid, a8, x8r8g8b8, fast_composite_ ## name ## _n_8_8888), \
+    PIXMAN_STD_FAST_PATH (op, solid, a8, a8b8g8r8, fast_composite_ ## name ## _n_8_8888), \
+    PIXMAN_STD_FAST_PATH (op, solid, a8, x8b8g8r8, fast_composite_ ## name ## _n_8_8888)
 
 static const pixman_fast_path_t c_fast_paths[] =
 {
@@ -1877,8 +2750,46 @@ static const pixman_fast_path_t c_fast_paths[] =
     PIXMAN_STD_FAST_PATH (SRC, x1r5g5b5, null, x1r5g5b5, fast_composite_src_memcpy),
     PIXMAN_STD_FAST_PATH (SRC, a1r5g5b5, null, x1r5g5b5, fast_composite_src_memcpy),
     PIXMAN_STD_FAST_PATH (SRC, a8, null, a8, fast_composite_src_memcpy),
+    PIXMAN_WIDE_FAST_PATH (SRC, a16b16g16r16, null, a16b16g16r16, fast_composite_src_memcpy),
+    PIXMAN_WIDE_FAST_PATH (SRC, a8r8g8b8, null, a16b16g16r16, fast_composite_src_8888_16161616),
+    PIXMAN_WIDE_FAST_PATH (SRC, x8r8g8b8, null, a16b16g16r16, fast_composite_src_8888_16161616),
+    PIXMAN_WIDE_FAST_PATH (SRC, a16b16g16r16, null, a8r8g8b8, fast_composite_src_16161616_8888),
+    PIXMAN_WIDE_FAST_PATH (SRC, a16b16g16r16, null, x8r8g8b8, fast_composite_src_16161616_8888),
+    PIXMAN_WIDE_FAST_PATH (OVER, a8r8g8b8, null, a16b16g16r16, fast_composite_over_8888_16161616),
+    PIXMAN_WIDE_FAST_PATH (OVER, a16b16g16r16, null, a16b16g16r16, fast_composite_over_16161616_16161616),
+    PIXMAN_WIDE_FAST_PATH (ADD, a16b16g16r16, null, a16b16g16r16, fast_composite_add_16161616_16161616),
+    PIXMAN_WIDE_FAST_PATH (SRC, rgba_float, null, rgba_float, fast_composite_src_memcpy),
+    PIXMAN_WIDE_FAST_PATH (SRC, rgb_float, null, rgb_float, fast_composite_src_memcpy),
+    PIXMAN_WIDE_FAST_PATH (SRC, rgba_half, null, rgba_half, fast_composite_src_memcpy),
+    PIXMAN_WIDE_FAST_PATH (SRC, rgba_float, null, rgba_half, fast_composite_src_rgbaf_rgbah),
+    PIXMAN_WIDE_FAST_PATH (SRC, rgba_half, null, rgba_float, fast_composite_src_rgbah_rgbaf),
     PIXMAN_STD_FAST_PATH (IN, a8, null, a8, fast_composite_in_8_8),
     PIXMAN_STD_FAST_PATH (IN, solid, a8, a8, fast_composite_in_n_8_8),
+    SOLID_BLEND_FAST_PATH (MULTIPLY, multiply),
+    SOLID_BLEND_FAST_PATH (SCREEN, screen),
+    SOLID_BLEND_FAST_PATH (OVERLAY, overlay),
+    SOLID_BLEND_FAST_PATH (DARKEN, darken),
+    SOLID_BLEND_FAST_PATH (LIGHTEN, lighten),
+    SOLID_BLEND_FAST_PATH (HARD_LIGHT, hard_light),
+    SOLID_BLEND_FAST_PATH (DIFFERENCE, difference),
+    SOLID_BLEND_FAST_PATH (EXCLUSION, exclusion),
+    FUSED_FAST_PATHS (OUT_REVERSE, out_reverse),
+    FUSED_FAST_PATHS (ADD, add),
+
+    /* Ahead of the nearest paths, which also take 180 degrees and flips */
+    SIMPLE_ROTATE_FAST_PATH (SRC, a8r8g8b8, a8r8g8b8, fast_composite_rotate_8888),
+    SIMPLE_ROTATE_FAST_PATH (SRC, a8r8g8b8, x8r8g8b8, fast_composite_rotate_8888),
+    SIMPLE_ROTATE_FAST_PATH (SRC, x8r8g8b8, x8r8g8b8, fast_composite_rotate_8888),
+    SIMPLE_ROTATE_FAST_PATH (SRC, a8b8g8r8, a8b8g8r8, fast_composite_rotate_8888),
+    SIMPLE_ROTATE_FAST_PATH (SRC, a8b8g8r8, x8b8g8r8, fast_composite_rotate_8888),
+    SIMPLE_ROTATE_FAST_PATH (SRC, x8b8g8r8, x8b8g8r8, fast_composite_rotate_8888),
+    SIMPLE_ROTATE_FAST_PATH (SRC, r5g6b5, r5g6b5, fast_composite_rotate_565),
+    SIMPLE_ROTATE_FAST_PATH (SRC, b5g6r5, b5g6r5, fast_composite_rotate_565),
+    SIMPLE_ROTATE_FAST_PATH (SRC, a8, a8, fast_composite_rotate_8),
+    SIMPLE_ROTATE_FAST_PATH (OVER, a8r8g8b8, a8r8g8b8, fast_composite_rotate_over_8888),
+    SIMPLE_ROTATE_FAST_PATH (OVER, a8r8g8b8, x8r8g8b8, fast_composite_rotate_over_8888),
+    SIMPLE_ROTATE_FAST_PATH (OVER, a8b8g8r8, a8b8g8r8, fast_composite_rotate_over_8888),
+    SIMPLE_ROTATE_FAST_PATH (OVER, a8b8g8r8, x8b8g8r8, fast_composite_rotate_over_8888),
 
     SIMPLE_NEAREST_FAST_PATH (SRC, x8r8g8b8, x8r8g8b8, 8888_8888),
     SIMPLE_NEAREST_FAST_PATH (SRC, a8r8g8b8, x8r8g8b8, 8888_8888),
@@ -1935,39 +2846,13 @@ static const pixman_fast_path_t c_fast_paths[] =
     NEAREST_FAST_PATH (OVER, x8b8g8r8, a8b8g8r8),
     NEAREST_FAST_PATH (OVER, a8b8g8r8, a8b8g8r8),
 
-#define SIMPLE_ROTATE_FLAGS(angle)					  \
-    (FAST_PATH_ROTATE_ ## angle ## _TRANSFORM	|			  \
-     FAST_PATH_NEAREST_FILTER			|			  \
-     FAST_PATH_SAMPLES_COVER_CLIP_NEAREST	|			  \
-     FAST_PATH_STANDARD_FLAGS)
-
-#define SIMPLE_ROTATE_FAST_PATH(op,s,d,suffix)				  \
-    {   PIXMAN_OP_ ## op,						  \
-	PIXMAN_ ## s, SIMPLE_ROTATE_FLAGS (90),				  \
-	PIXMAN_null, 0,							  \
-	PIXMAN_ ## d, FAST_PATH_STD_DEST_FLAGS,				  \
-	fast_composite_rotate_90_##suffix,				  \
-    },									  \
-    {   PIXMAN_OP_ ## op,						  \
-	PIXMAN_ ## s, SIMPLE_ROTATE_FLAGS (270),			  \
-	PIXMAN_null, 0,							  \
-	PIXMAN_ ## d, FAST_PATH_STD_DEST_FLAGS,				  \
-	fast_composite_rotate_270_##suffix,				  \
-    }
-
-    SIMPLE_ROTATE_FAST_PATH (SRC, a8r8g8b8, a8r8g8b8, 8888),
-    SIMPLE_ROTATE_FAST_PATH (SRC, a8r8g8b8, x8r8g8b8, 8888),
-    SIMPLE_ROTATE_FAST_PATH (SRC, x8r8g8b8, x8r8g8b8, 8888),
-    SIMPLE_ROTATE_FAST_PATH (SRC, r5g6b5, r5g6b5, 565),
-    SIMPLE_ROTATE_FAST_PATH (SRC, a8, a8, 8),
-
     /* Simple repeat fast path entry. */
     {	PIXMAN_OP_any,
 	PIXMAN_any,
-	(FAST_PATH_STANDARD_FLAGS | FAST_PATH_ID_TRANSFORM | FAST_PATH_BITS_IMAGE |
-	 FAST_PATH_NORMAL_REPEAT),
+	((FAST_PATH_STANDARD_FLAGS & ~FAST_PATH_NARROW_FORMAT) |
+	 FAST_PATH_ID_TRANSFORM | FAST_PATH_BITS_IMAGE | FAST_PATH_NORMAL_REPEAT),
 	PIXMAN_any, 0,
-	PIXMAN_any, FAST_PATH_STD_DEST_FLAGS,
+	PIXMAN_any, FAST_PATH_STD_DEST_FLAGS & ~FAST_PATH_NARROW_FORMAT,
 	fast_composite_tiled_repeat
     },
 
@@ -2846,6 +3731,153 @@ bits_image_fetch_separable_convolution_affine (pixman_image_t * image,
 
 static const uint8_t zero[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
 
+static force_inline uint32_t
+fetch_bilinear_pixel (bits_image_t *		bits,
+		      pixman_fixed_t		x,
+		      pixman_fixed_t		y,
+		      convert_pixel_t		convert_pixel,
+		      pixman_format_code_t	format,
+		      pixman_repeat_t		repeat_mode)
+{
+    int x1, y1, x2, y2;
+    uint32_t tl, tr, bl, br;
+    int32_t distx, disty;
+    int width = bits->width;
+    int height = bits->height;
+    const uint8_t *row1;
+    const uint8_t *row2;
+
+    x1 = x - pixman_fixed_1 / 2;
+    y1 = y - pixman_fixed_1 / 2;
+
+    distx = pixman_fixed_to_bilinear_weight (x1);
+    disty = pixman_fixed_to_bilinear_weight (y1);
+
+    y1 = pixman_fixed_to_int (y1);
+    y2 = y1 + 1;
+    x1 = pixman_fixed_to_int (x1);
+    x2 = x1 + 1;
+
+    if (repeat_mode != PIXMAN_REPEAT_NONE)
+    {
+	uint32_t mask;
+
+	mask = PIXMAN_FORMAT_A (format)? 0 : 0xff000000;
+
+	repeat (repeat_mode, &x1, width);
+	repeat (repeat_mode, &y1, height);
+	repeat (repeat_mode, &x2, width);
+	repeat (repeat_mode, &y2, height);
+
+	row1 = (uint8_t *)bits->bits + bits->rowstride * 4 * y1;
+	row2 = (uint8_t *)bits->bits + bits->rowstride * 4 * y2;
+
+	tl = convert_pixel (row1, x1) | mask;
+	tr = convert_pixel (row1, x2) | mask;
+	bl = convert_pixel (row2, x1) | mask;
+	br = convert_pixel (row2, x2) | mask;
+    }
+    else
+    {
+	uint32_t mask1, mask2;
+	int bpp;
+
+	/* Note: PIXMAN_FORMAT_BPP() returns an unsigned value,
+	 * which means if you use it in expressions, those
+	 * expressions become unsigned themselves. Since
+	 * the variables below can be negative in some cases,
+	 * that will lead to crashes on 64 bit architectures.
+	 *
+	 * So this line makes sure bpp is signed
+	 */
+	bpp = PIXMAN_FORMAT_BPP (format);
+
+	if (x1 >= width || x2 < 0 || y1 >= height || y2 < 0)
+	    return 0;
+
+	if (y2 == 0)
+	{
+	    row1 = zero;
+	    mask1 = 0;
+	}
+	else
+	{
+	    row1 = (uint8_t *)bits->bits + bits->rowstride * 4 * y1;
+	    row1 += bpp / 8 * x1;
+
+	    mask1 = PIXMAN_FORMAT_A (format)? 0 : 0xff000000;
+	}
+
+	if (y1 == height - 1)
+	{
+	    row2 = zero;
+	    mask2 = 0;
+	}
+	else
+	{
+	    row2 = (uint8_t *)bits->bits + bits->rowstride * 4 * y2;
+	    row2 += bpp / 8 * x1;
+
+	    mask2 = PIXMAN_FORMAT_A (format)? 0 : 0xff000000;
+	}
+
+	if (x2 == 0)
+	{
+	    tl = 0;
+	    bl = 0;
+	}
+	else
+	{
+	    tl = convert_pixel (row1, 0) | mask1;
+	    bl = convert_pixel (row2, 0) | mask2;
+	}
+
+	if (x1 == width - 1)
+	{
+	    tr = 0;
+	    br = 0;
+	}
+	else
+	{
+	    tr = convert_pixel (row1, 1) | mask1;
+	    br = convert_pixel (row2, 1) | mask2;
+	}
+    }
+
+    return bilinear_interpolation (tl, tr, bl, br, distx, disty);
+}
+
+static force_inline uint32_t
+fetch_nearest_pixel (bits_image_t *		bits,
+		     pixman_fixed_t		x,
+		     pixman_fixed_t		y,
+		     convert_pixel_t		convert_pixel,
+		     pixman_format_code_t	format,
+		     pixman_repeat_t		repeat_mode)
+{
+    int width = bits->width;
+    int height = bits->height;
+    int x0 = pixman_fixed_to_int (x - pixman_fixed_e);
+    int y0 = pixman_fixed_to_int (y - pixman_fixed_e);
+    uint32_t mask = PIXMAN_FORMAT_A (format)? 0 : 0xff000000;
+    const uint8_t *row;
+
+    if (repeat_mode == PIXMAN_REPEAT_NONE)
+    {
+	if (y0 < 0 || y0 >= height || x0 < 0 || x0 >= width)
+	    return 0;
+    }
+    else
+    {
+	repeat (repeat_mode, &x0, width);
+	repeat (repeat_mode, &y0, height);
+    }
+
+    row = (uint8_t *)bits->bits + bits->rowstride * 4 * y0;
+
+    return convert_pixel (row, x0) | mask;
+}
+
 static force_inline void
 bits_image_fetch_bilinear_affine (pixman_image_t * image,
 				  int              offset,
@@ -2861,7 +3893,6 @@ bits_image_fetch_bilinear_affine (pixman_image_t * image,
     pixman_fixed_t x, y;
     pixman_fixed_t ux, uy;
     pixman_vector_t v;
-    bits_image_t *bits = &image->bits;
     int i;
 
     /* reference point is the center of the pixel */
@@ -2880,121 +3911,12 @@ bits_image_fetch_bilinear_affine (pixman_image_t * image,
 
     for (i = 0; i < width; ++i)
     {
-	int x1, y1, x2, y2;
-	uint32_t tl, tr, bl, br;
-	int32_t distx, disty;
-	int width = image->bits.width;
-	int height = image->bits.height;
-	const uint8_t *row1;
-	const uint8_t *row2;
-
-	if (mask && !mask[i])
-	    goto next;
-
-	x1 = x - pixman_fixed_1 / 2;
-	y1 = y - pixman_fixed_1 / 2;
-
-	distx = pixman_fixed_to_bilinear_weight (x1);
-	disty = pixman_fixed_to_bilinear_weight (y1);
-
-	y1 = pixman_fixed_to_int (y1);
-	y2 = y1 + 1;
-	x1 = pixman_fixed_to_int (x1);
-	x2 = x1 + 1;
-
-	if (repeat_mode != PIXMAN_REPEAT_NONE)
-	{
-	    uint32_t mask;
-
-	    mask = PIXMAN_FORMAT_A (format)? 0 : 0xff000000;
-
-	    repeat (repeat_mode, &x1, width);
-	    repeat (repeat_mode, &y1, height);
-	    repeat (repeat_mode, &x2, width);
-	    repeat (repeat_mode, &y2, height);
-
-	    row1 = (uint8_t *)bits->bits + bits->rowstride * 4 * y1;
-	    row2 = (uint8_t *)bits->bits + bits->rowstride * 4 * y2;
-
-	    tl = convert_pixel (row1, x1) | mask;
-	    tr = convert_pixel (row1, x2) | mask;
-	    bl = convert_pixel (row2, x1) | mask;
-	    br = convert_pixel (row2, x2) | mask;
-	}
-	else
+	if (!mask || mask[i])
 	{
-	    uint32_t mask1, mask2;
-	    int bpp;
-
-	    /* Note: PIXMAN_FORMAT_BPP() returns an unsigned value,
-	     * which means if you use it in expressions, those
-	     * expressions become unsigned themselves. Since
-	     * the variables below can be negative in some cases,
-	     * that will lead to crashes on 64 bit architectures.
-	     *
-	     * So this line makes sure bpp is signed
-	     */
-	    bpp = PIXMAN_FORMAT_BPP (format);
-
-	    if (x1 >= width || x2 < 0 || y1 >= height || y2 < 0)
-	    {
-		buffer[i] = 0;
-		goto next;
-	    }
-
-	    if (y2 == 0)
-	    {
-		row1 = zero;
-		mask1 = 0;
-	    }
-	    else
-	    {
-		row1 = (uint8_t *)bits->bits + bits->rowstride * 4 * y1;
-		row1 += bpp / 8 * x1;
-
-		mask1 = PIXMAN_FORMAT_A (format)? 0 : 0xff000000;
-	    }
-
-	    if (y1 == height - 1)
-	    {
-		row2 = zero;
-		mask2 = 0;
-	    }
-	    else
-	    {
-		row2 = (uint8_t *)bits->bits + bits->rowstride * 4 * y2;
-		row2 += bpp / 8 * x1;
-
-		mask2 = PIXMAN_FORMAT_A (format)? 0 : 0xff000000;
-	    }
-
-	    if (x2 == 0)
-	    {
-		tl = 0;
-		bl = 0;
-	    }
-	    else
-	    {
-		tl = convert_pixel (row1, 0) | mask1;
-		bl = convert_pixel (row2, 0) | mask2;
-	    }
-
-	    if (x1 == width - 1)
-	    {
-		tr = 0;
-		br = 0;
-	    }
-	    else
-	    {
-		tr = convert_pixel (row1, 1) | mask1;
-		br = convert_pixel (row2, 1) | mask2;
-	    }
+	    buffer[i] = fetch_bilinear_pixel (
+		&image->bits, x, y, convert_pixel, format, repeat_mode);
 	}
 
-	buffer[i] = bilinear_interpolation (
-	    tl, tr, bl, br, distx, disty);
-
-    next:
 	x += ux;
 	y += uy;
     }
@@ -3015,7 +3937,6 @@ bits_image_fetch_nearest_affine (pixman_image_t * image,
     pixman_fixed_t x, y;
     pixman_fixed_t ux, uy;
     pixman_vector_t v;
-    bits_image_t *bits = &image->bits;
     int i;
 
     /* reference point is the center of the pixel */
@@ -3034,40 +3955,79 @@ bits_image_fetch_nearest_affine (pixman_image_t * image,
 
     for (i = 0; i < width; ++i)
     {
-	int width, height, x0, y0;
-	const uint8_t *row;
-
-	if (mask && !mask[i])
-	    goto next;
-	
-	width = image->bits.width;
-	height = image->bits.height;
-	x0 = pixman_fixed_to_int (x - pixman_fixed_e);
-	y0 = pixman_fixed_to_int (y - pixman_fixed_e);
-
-	if (repeat_mode == PIXMAN_REPEAT_NONE &&
-	    (y0 < 0 || y0 >= height || x0 < 0 || x0 >= width))
+	if (!mask || mask[i])
 	{
-	    buffer[i] = 0;
+	    buffer[i] = fetch_nearest_pixel (
+		&image->bits, x, y, convert_pixel, format, repeat_mode);
 	}
-	else
+
+	x += ux;
+	y += uy;
+    }
+}
+
+/* Same as the affine fetchers, except that the sample position of
+ * each pixel is divided by the homogeneous coordinate. The division
+ * rounds like the one in the general fetcher, so the results are the
+ * same.
+ */
+static force_inline void
+bits_image_fetch_projective (pixman_image_t * image,
+			     int              offset,
+			     int              line,
+			     int              width,
+			     uint32_t *       buffer,
+			     const uint32_t * mask,
+
+			     convert_pixel_t	convert_pixel,
+			     pixman_format_code_t	format,
+			     pixman_repeat_t	repeat_mode,
+			     pixman_bool_t	bilinear)
+{
+    pixman_fixed_t x, y, w;
+    pixman_fixed_t ux, uy, uw;
+    pixman_vector_t v;
+    int i;
+
+    /* reference point is the center of the pixel */
+    v.vector[0] = pixman_int_to_fixed (offset) + pixman_fixed_1 / 2;
+    v.vector[1] = pixman_int_to_fixed (line) + pixman_fixed_1 / 2;
+    v.vector[2] = pixman_fixed_1;
+
+    if (!pixman_transform_point_3d (image->common.transform, &v))
+	return;
+
+    ux = image->common.transform->matrix[0][0];
+    uy = image->common.transform->matrix[1][0];
+    uw = image->common.transform->matrix[2][0];
+
+    x = v.vector[0];
+    y = v.vector[1];
+    w = v.vector[2];
+
+    for (i = 0; i < width; ++i)
+    {
+	if (!mask || mask[i])
 	{
-	    uint32_t mask = PIXMAN_FORMAT_A (format)? 0 : 0xff000000;
+	    pixman_fixed_t x0, y0;
 
-	    if (repeat_mode != PIXMAN_REPEAT_NONE)
+	    projective_divide (x, y, w, &x0, &y0);
+
+	    if (bilinear)
 	    {
-		repeat (repeat_mode, &x0, width);
-		repeat (repeat_mode, &y0, height);
+		buffer[i] = fetch_bilinear_pixel (
+		    &image->bits, x0, y0, convert_pixel, format, repeat_mode);
+	    }
+	    else
+	    {
+		buffer[i] = fetch_nearest_pixel (
+		    &image->bits, x0, y0, convert_pixel, format, repeat_mode);
 	    }
-
-	    row = (uint8_t *)bits->bits + bits->rowstride * 4 * y0;
-
-	    buffer[i] = convert_pixel (row, x0) | mask;
 	}
 
-    next:
 	x += ux;
 	y += uy;
+	w += uw;
     }
 }
 
@@ -3142,10 +4102,27 @@ convert_r5g6b5 (const uint8_t *row, int x)
 	return iter->buffer;						\
     }
 
+#define MAKE_PROJECTIVE_FETCHER(name, filter, format, repeat_mode, bilinear) \
+    static uint32_t *							\
+    bits_image_fetch_ ## filter ## _projective_ ## name (		\
+	pixman_iter_t *iter, const uint32_t * mask)			\
+    {									\
+	bits_image_fetch_projective (iter->image,			\
+				     iter->x, iter->y++,		\
+				     iter->width,			\
+				     iter->buffer, mask,		\
+				     convert_ ## format,		\
+				     PIXMAN_ ## format,			\
+				     repeat_mode, bilinear);		\
+	return iter->buffer;						\
+    }
+
 #define MAKE_FETCHERS(name, format, repeat_mode)			\
     MAKE_NEAREST_FETCHER (name, format, repeat_mode)			\
     MAKE_BILINEAR_FETCHER (name, format, repeat_mode)			\
-    MAKE_SEPARABLE_CONVOLUTION_FETCHER (name, format, repeat_mode)
+    MAKE_SEPARABLE_CONVOLUTION_FETCHER (name, format, repeat_mode)	\
+    MAKE_PROJECTIVE_FETCHER (name, nearest, format, repeat_mode, FALSE) \
+    MAKE_PROJECTIVE_FETCHER (name, bilinear, format, repeat_mode, TRUE)
 
 MAKE_FETCHERS (pad_a8r8g8b8,     a8r8g8b8, PIXMAN_REPEAT_PAD)
 MAKE_FETCHERS (none_a8r8g8b8,    a8r8g8b8, PIXMAN_REPEAT_NONE)
@@ -3257,10 +4234,26 @@ static const pixman_iter_info_t fast_iters[] =
       NULL, bits_image_fetch_nearest_affine_ ## name, NULL		\
     },
 
+#define GENERAL_PROJECTIVE_FLAGS					\
+    (FAST_PATH_NO_ALPHA_MAP		|				\
+     FAST_PATH_NO_ACCESSORS		|				\
+     FAST_PATH_HAS_TRANSFORM		|				\
+     FAST_PATH_PROJECTIVE_TRANSFORM)
+
+#define PROJECTIVE_FAST_PATH(name, format, repeat, filter, FILTER)	\
+    { PIXMAN_ ## format,						\
+      GENERAL_PROJECTIVE_FLAGS | FAST_PATH_ ## FILTER ## _FILTER |	\
+      FAST_PATH_ ## repeat ## _REPEAT,					\
+      ITER_NARROW | ITER_SRC,						\
+      NULL, bits_image_fetch_ ## filter ## _projective_ ## name, NULL	\
+    },
+
 #define AFFINE_FAST_PATHS(name, format, repeat)				\
     SEPARABLE_CONVOLUTION_AFFINE_FAST_PATH(name, format, repeat)	\
     BILINEAR_AFFINE_FAST_PATH(name, format, repeat)			\
-    NEAREST_AFFINE_FAST_PATH(name, format, repeat)
+    NEAREST_AFFINE_FAST_PATH(name, format, repeat)			\
+    PROJECTIVE_FAST_PATH(name, format, repeat, bilinear, BILINEAR)	\
+    PROJECTIVE_FAST_PATH(name, format, repeat, nearest, NEAREST)
     
     AFFINE_FAST_PATHS (pad_a8r8g8b8, a8r8g8b8, PAD)
     AFFINE_FAST_PATHS (none_a8r8g8b8, a8r8g8b8, NONE)
@@ -3285,7 +4278,8 @@ static const pixman_iter_info_t fast_iters[] =
 pixman_implementation_t *
 _pixman_implementation_create_fast_path (pixman_implementation_t *fallback)
 {
-    pixman_implementation_t *imp = _pixman_implementation_create (fallback, c_fast_paths);
+    pixman_implementation_t *imp =
+	_pixman_implementation_create ("fast", fallback, c_fast_paths);
 
     imp->fill = fast_path_fill;
     imp->iter_info = fast_iters;
@@ -109,6 +109,11 @@ static const op_info_t op_flags[PIXMAN_N_OPERATORS] =
 
 #define SCANLINE_BUFFER_LENGTH 8192
 
+/* How many rows ahead of the one being composited the source, mask
+ * and destination get prefetched
+ */
+#define PREFETCH_ROWS 4
+
 static pixman_bool_t
 operator_needs_division (pixman_op_t op)
 {
@@ -216,6 +221,16 @@ general_composite_rect  (pixman_implementation_t *imp,
     {
 	uint32_t *s, *m, *d;
 
+	if (i + PREFETCH_ROWS < height)
+	{
+	    _pixman_bits_image_prefetch_scanline (
+		src_image, src_x, src_y + i + PREFETCH_ROWS, width);
+	    _pixman_bits_image_prefetch_scanline (
+		mask_image, mask_x, mask_y + i + PREFETCH_ROWS, width);
+	    _pixman_bits_image_prefetch_scanline (
+		dest_image, dest_x, dest_y + i + PREFETCH_ROWS, width);
+	}
+
 	m = mask_iter.get_scanline (&mask_iter, NULL);
 	s = src_iter.get_scanline (&src_iter, m);
 	d = dest_iter.get_scanline (&dest_iter, NULL);
@@ -242,15 +257,40 @@ static const pixman_fast_path_t general_fast_path[] =
     { PIXMAN_OP_NONE }
 };
 
+static void
+general_downsample_2x2 (pixman_implementation_t *imp,
+			uint32_t *               dest,
+			const uint32_t *         top,
+			const uint32_t *         bottom,
+			int                      width)
+{
+    while (width--)
+    {
+	/* Four 8 bit channels plus the rounding term fit in 10 bits */
+	uint32_t rb = (top[0] & 0x00ff00ff) + (top[1] & 0x00ff00ff) +
+	    (bottom[0] & 0x00ff00ff) + (bottom[1] & 0x00ff00ff) + 0x00020002;
+	uint32_t ag = ((top[0] >> 8) & 0x00ff00ff) + ((top[1] >> 8) & 0x00ff00ff) +
+	    ((bottom[0] >> 8) & 0x00ff00ff) + ((bottom[1] >> 8) & 0x00ff00ff) +
+	    0x00020002;
+
+	*dest++ = ((rb >> 2) & 0x00ff00ff) | ((ag << 6) & 0xff00ff00);
+
+	top += 2;
+	bottom += 2;
+    }
+}
+
 pixman_implementation_t *
 _pixman_implementation_create_general (void)
 {
-    pixman_implementation_t *imp = _pixman_implementation_create (NULL, general_fast_path);
+    pixman_implementation_t *imp =
+	_pixman_implementation_create ("general", NULL, general_fast_path);
 
     _pixman_setup_combiner_functions_32 (imp);
     _pixman_setup_combiner_functions_float (imp);
 
     imp->iter_info = general_iters;
+    imp->downsample_2x2 = general_downsample_2x2;
 
     return imp;
 }
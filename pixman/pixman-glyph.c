@@ -31,8 +31,8 @@
 
 #include <stdlib.h>
 
-typedef struct glyph_metrics_t glyph_metrics_t;
 typedef struct glyph_t glyph_t;
+typedef struct shard_t shard_t;
 
 #define TOMBSTONE ((glyph_t *)0x1)
 
@@ -41,7 +41,31 @@ typedef struct glyph_t glyph_t;
 #define N_GLYPHS_HIGH_WATER  (16384)
 #define N_GLYPHS_LOW_WATER   (8192)
 #define HASH_SIZE (2 * N_GLYPHS_HIGH_WATER)
-#define HASH_MASK (HASH_SIZE - 1)
+
+/* Threads
+ *
+ * The table is split into shards with a lock each; lookups, insertions
+ * and removals only lock the shard the glyph hashes to. An insertion
+ * that finds its shard at the high water mark evicts down to the low
+ * water mark, so a shard never fills up however long the cache stays
+ * frozen. Evicted and removed glyphs go on the shard's removed list,
+ * since a thread that has the cache frozen may still be using them,
+ * and are only freed once no thread has: the thaw that brings the
+ * freeze count to zero swaps it for EVICTING, which holds off new
+ * freezes, and then empties the removed lists.
+ *
+ * Composites mark the glyphs they use instead of moving them in the
+ * most recently used list, and eviction gives marked glyphs a second
+ * chance, which approximates least recently used order without taking
+ * a lock per glyph.
+ */
+#define N_SHARDS		16
+#define SHARD_SIZE		(HASH_SIZE / N_SHARDS)
+#define SHARD_MASK		(SHARD_SIZE - 1)
+#define SHARD_HIGH_WATER	(N_GLYPHS_HIGH_WATER / N_SHARDS)
+#define SHARD_LOW_WATER		(N_GLYPHS_LOW_WATER / N_SHARDS)
+
+#define EVICTING		(-1)
 
 struct glyph_t
 {
@@ -51,15 +75,24 @@ struct glyph_t
     int			origin_y;
     pixman_image_t *	image;
     pixman_link_t	mru_link;
+    int32_t		used;
 };
 
-struct pixman_glyph_cache_t
+struct shard_t
 {
+    pixman_spinlock_t	lock;
     int			n_glyphs;
     int			n_tombstones;
-    int			freeze_count;
     pixman_list_t	mru;
-    glyph_t *		glyphs[HASH_SIZE];
+    pixman_list_t	removed;
+    glyph_t *		glyphs[SHARD_SIZE];
+};
+
+struct pixman_glyph_cache_t
+{
+    volatile int32_t	freeze_count;
+    volatile int32_t	need_trim;
+    shard_t		shards[N_SHARDS];
 };
 
 static void
@@ -91,16 +124,23 @@ hash (const void *font_key, const void *glyph_key)
     return key;
 }
 
+/* The low bits of the hash pick the shard, the rest the slot */
+static shard_t *
+get_shard (pixman_glyph_cache_t *cache, unsigned idx)
+{
+    return &cache->shards[idx & (N_SHARDS - 1)];
+}
+
 static glyph_t *
-lookup_glyph (pixman_glyph_cache_t *cache,
-	      void                 *font_key,
-	      void                 *glyph_key)
+lookup_glyph (shard_t *shard,
+	      unsigned idx,
+	      void    *font_key,
+	      void    *glyph_key)
 {
-    unsigned idx;
     glyph_t *g;
 
-    idx = hash (font_key, glyph_key);
-    while ((g = cache->glyphs[idx++ & HASH_MASK]))
+    idx /= N_SHARDS;
+    while ((g = shard->glyphs[idx++ & SHARD_MASK]))
     {
 	if (g != TOMBSTONE			&&
 	    g->font_key == font_key		&&
@@ -114,88 +154,156 @@ lookup_glyph (pixman_glyph_cache_t *cache,
 }
 
 static void
-insert_glyph (pixman_glyph_cache_t *cache,
-	      glyph_t              *glyph)
+insert_glyph (shard_t *shard,
+	      glyph_t *glyph)
 {
     unsigned idx;
     glyph_t **loc;
 
-    idx = hash (glyph->font_key, glyph->glyph_key);
+    idx = hash (glyph->font_key, glyph->glyph_key) / N_SHARDS;
 
     /* Note: we assume that there is room in the table. If there isn't,
      * this will be an infinite loop.
      */
     do
     {
-	loc = &cache->glyphs[idx++ & HASH_MASK];
+	loc = &shard->glyphs[idx++ & SHARD_MASK];
     } while (*loc && *loc != TOMBSTONE);
 
     if (*loc == TOMBSTONE)
-	cache->n_tombstones--;
-    cache->n_glyphs++;
+	shard->n_tombstones--;
+    shard->n_glyphs++;
 
     *loc = glyph;
 }
 
 static void
-remove_glyph (pixman_glyph_cache_t *cache,
-	      glyph_t              *glyph)
+remove_glyph (shard_t *shard,
+	      glyph_t *glyph)
 {
     unsigned idx;
 
-    idx = hash (glyph->font_key, glyph->glyph_key);
-    while (cache->glyphs[idx & HASH_MASK] != glyph)
+    idx = hash (glyph->font_key, glyph->glyph_key) / N_SHARDS;
+    while (shard->glyphs[idx & SHARD_MASK] != glyph)
 	idx++;
 
-    cache->glyphs[idx & HASH_MASK] = TOMBSTONE;
-    cache->n_tombstones++;
-    cache->n_glyphs--;
+    shard->glyphs[idx & SHARD_MASK] = TOMBSTONE;
+    shard->n_tombstones++;
+    shard->n_glyphs--;
 
     /* Eliminate tombstones if possible */
-    if (cache->glyphs[(idx + 1) & HASH_MASK] == NULL)
+    if (shard->glyphs[(idx + 1) & SHARD_MASK] == NULL)
     {
-	while (cache->glyphs[idx & HASH_MASK] == TOMBSTONE)
+	while (shard->glyphs[idx & SHARD_MASK] == TOMBSTONE)
 	{
-	    cache->glyphs[idx & HASH_MASK] = NULL;
-	    cache->n_tombstones--;
+	    shard->glyphs[idx & SHARD_MASK] = NULL;
+	    shard->n_tombstones--;
 	    idx--;
 	}
     }
 }
 
+/* Reinsert all glyphs to get rid of the tombstones */
 static void
-clear_table (pixman_glyph_cache_t *cache)
+rehash_shard (shard_t *shard)
 {
-    int i;
+    pixman_link_t *link;
+
+    memset (shard->glyphs, 0, sizeof (shard->glyphs));
+    shard->n_glyphs = 0;
+    shard->n_tombstones = 0;
+
+    for (link = shard->mru.head;
+	 link != (pixman_link_t *)&shard->mru;
+	 link = link->next)
+    {
+	insert_glyph (shard, CONTAINER_OF (glyph_t, mru_link, link));
+    }
+}
 
-    for (i = 0; i < HASH_SIZE; ++i)
+static void
+free_list (pixman_list_t *list)
+{
+    while (list->head != (pixman_link_t *)list)
+	free_glyph (CONTAINER_OF (glyph_t, mru_link, list->head));
+}
+
+/* Moves the least recently used glyphs to the removed list until the
+ * shard is down to its low water mark. Called with the shard locked.
+ */
+static void
+evict_glyphs (shard_t *shard)
+{
+    while (shard->n_glyphs > SHARD_LOW_WATER)
     {
-	glyph_t *glyph = cache->glyphs[i];
+	glyph_t *glyph = CONTAINER_OF (glyph_t, mru_link, shard->mru.tail);
 
-	if (glyph && glyph != TOMBSTONE)
-	    free_glyph (glyph);
+	if (pixman_atomic_load (&glyph->used))
+	{
+	    pixman_atomic_store (&glyph->used, FALSE);
+	    pixman_list_move_to_front (&shard->mru, &glyph->mru_link);
+	    continue;
+	}
+
+	remove_glyph (shard, glyph);
+	pixman_list_move_to_front (&shard->removed, &glyph->mru_link);
+    }
+
+    if (shard->n_tombstones > SHARD_LOW_WATER)
+	rehash_shard (shard);
+}
+
+/* Only called while no thread has the cache frozen */
+static void
+trim_shard (shard_t *shard)
+{
+    pixman_spin_lock (&shard->lock);
+    free_list (&shard->removed);
+    pixman_spin_unlock (&shard->lock);
+}
+
+static void
+trim_cache (pixman_glyph_cache_t *cache)
+{
+    int i;
 
-	cache->glyphs[i] = NULL;
+    if (!pixman_atomic_load (&cache->need_trim) ||
+	!pixman_atomic_cas (&cache->freeze_count, 0, EVICTING))
+    {
+	return;
     }
 
-    cache->n_glyphs = 0;
-    cache->n_tombstones = 0;
+    pixman_atomic_store (&cache->need_trim, FALSE);
+
+    for (i = 0; i < N_SHARDS; ++i)
+	trim_shard (&cache->shards[i]);
+
+    pixman_atomic_cas (&cache->freeze_count, EVICTING, 0);
 }
 
 PIXMAN_EXPORT pixman_glyph_cache_t *
 pixman_glyph_cache_create (void)
 {
     pixman_glyph_cache_t *cache;
+    int i;
 
     if (!(cache = malloc (sizeof *cache)))
 	return NULL;
 
-    memset (cache->glyphs, 0, sizeof (cache->glyphs));
-    cache->n_glyphs = 0;
-    cache->n_tombstones = 0;
     cache->freeze_count = 0;
+    cache->need_trim = FALSE;
 
-    pixman_list_init (&cache->mru);
+    for (i = 0; i < N_SHARDS; ++i)
+    {
+	shard_t *shard = &cache->shards[i];
+
+	shard->lock = 0;
+	shard->n_glyphs = 0;
+	shard->n_tombstones = 0;
+	pixman_list_init (&shard->mru);
+	pixman_list_init (&shard->removed);
+	memset (shard->glyphs, 0, sizeof (shard->glyphs));
+    }
 
     return cache;
 }
@@ -203,9 +311,15 @@ pixman_glyph_cache_create (void)
 PIXMAN_EXPORT void
 pixman_glyph_cache_destroy (pixman_glyph_cache_t *cache)
 {
+    int i;
+
     return_if_fail (cache->freeze_count == 0);
 
-    clear_table (cache);
+    for (i = 0; i < N_SHARDS; ++i)
+    {
+	free_list (&cache->shards[i].mru);
+	free_list (&cache->shards[i].removed);
+    }
 
     free (cache);
 }
@@ -213,31 +327,22 @@ pixman_glyph_cache_destroy (pixman_glyph_cache_t *cache)
 PIXMAN_EXPORT void
 pixman_glyph_cache_freeze (pixman_glyph_cache_t  *cache)
 {
-    cache->freeze_count++;
+    int32_t count;
+
+    do
+    {
+	_pixman_spin_wait (&cache->freeze_count, EVICTING);
+
+	count = pixman_atomic_load (&cache->freeze_count);
+    } while (count == EVICTING ||
+	     !pixman_atomic_cas (&cache->freeze_count, count, count + 1));
 }
 
 PIXMAN_EXPORT void
 pixman_glyph_cache_thaw (pixman_glyph_cache_t  *cache)
 {
-    if (--cache->freeze_count == 0					&&
-	cache->n_glyphs + cache->n_tombstones > N_GLYPHS_HIGH_WATER)
-    {
-	if (cache->n_tombstones > N_GLYPHS_HIGH_WATER)
-	{
-	    /* More than half the entries are
-	     * tombstones. Just dump the whole table.
-	     */
-	    clear_table (cache);
-	}
-
-	while (cache->n_glyphs > N_GLYPHS_LOW_WATER)
-	{
-	    glyph_t *glyph = CONTAINER_OF (glyph_t, mru_link, cache->mru.tail);
-
-	    remove_glyph (cache, glyph);
-	    free_glyph (glyph);
-	}
-    }
+    if (pixman_atomic_add (&cache->freeze_count, -1) == 0)
+	trim_cache (cache);
 }
 
 PIXMAN_EXPORT const void *
@@ -245,7 +350,15 @@ pixman_glyph_cache_lookup (pixman_glyph_cache_t  *cache,
 			   void                  *font_key,
 			   void                  *glyph_key)
 {
-    return lookup_glyph (cache, font_key, glyph_key);
+    unsigned idx = hash (font_key, glyph_key);
+    shard_t *shard = get_shard (cache, idx);
+    glyph_t *glyph;
+
+    pixman_spin_lock (&shard->lock);
+    glyph = lookup_glyph (shard, idx, font_key, glyph_key);
+    pixman_spin_unlock (&shard->lock);
+
+    return glyph;
 }
 
 PIXMAN_EXPORT const void *
@@ -256,18 +369,17 @@ pixman_glyph_cache_insert (pixman_glyph_cache_t  *cache,
 			   int                    origin_y,
 			   pixman_image_t        *image)
 {
-    glyph_t *glyph;
+    glyph_t *glyph, *result;
     int32_t width, height;
+    shard_t *shard;
+    unsigned idx;
 
-    return_val_if_fail (cache->freeze_count > 0, NULL);
+    return_val_if_fail (pixman_atomic_load (&cache->freeze_count) > 0, NULL);
     return_val_if_fail (image->type == BITS, NULL);
 
     width = image->bits.width;
     height = image->bits.height;
 
-    if (cache->n_glyphs >= HASH_SIZE)
-	return NULL;
-
     if (!(glyph = malloc (sizeof *glyph)))
 	return NULL;
 
@@ -275,6 +387,7 @@ pixman_glyph_cache_insert (pixman_glyph_cache_t  *cache,
     glyph->glyph_key = glyph_key;
     glyph->origin_x = origin_x;
     glyph->origin_y = origin_y;
+    glyph->used = FALSE;
 
     if (!(glyph->image = pixman_image_create_bits (
 	      image->bits.format, width, height, NULL, -1)))
@@ -293,12 +406,42 @@ pixman_glyph_cache_insert (pixman_glyph_cache_t  *cache,
 	pixman_image_set_component_alpha (glyph->image, TRUE);
     }
 
-    pixman_list_prepend (&cache->mru, &glyph->mru_link);
-
     _pixman_image_validate (glyph->image);
-    insert_glyph (cache, glyph);
 
-    return glyph;
+    /* The copy is made without the lock, so another thread may have
+     * inserted the same glyph in the meantime.
+     */
+    idx = hash (font_key, glyph_key);
+    shard = get_shard (cache, idx);
+
+    pixman_spin_lock (&shard->lock);
+
+    if (!(result = lookup_glyph (shard, idx, font_key, glyph_key)))
+    {
+	if (shard->n_glyphs >= SHARD_HIGH_WATER)
+	{
+	    evict_glyphs (shard);
+	    pixman_atomic_store (&cache->need_trim, TRUE);
+	}
+
+	if (shard->n_glyphs + shard->n_tombstones >= SHARD_SIZE - 1)
+	    rehash_shard (shard);
+
+	pixman_list_prepend (&shard->mru, &glyph->mru_link);
+	insert_glyph (shard, glyph);
+
+	result = glyph;
+    }
+
+    pixman_spin_unlock (&shard->lock);
+
+    if (result != glyph)
+    {
+	pixman_image_unref (glyph->image);
+	free (glyph);
+    }
+
+    return result;
 }
 
 PIXMAN_EXPORT void
@@ -306,14 +449,27 @@ pixman_glyph_cache_remove (pixman_glyph_cache_t  *cache,
 			   void                  *font_key,
 			   void                  *glyph_key)
 {
+    unsigned idx = hash (font_key, glyph_key);
+    shard_t *shard = get_shard (cache, idx);
     glyph_t *glyph;
 
-    if ((glyph = lookup_glyph (cache, font_key, glyph_key)))
+    pixman_spin_lock (&shard->lock);
+
+    /* Other threads may still be using the glyph */
+    if ((glyph = lookup_glyph (shard, idx, font_key, glyph_key)))
     {
-	remove_glyph (cache, glyph);
+	remove_glyph (shard, glyph);
 
-	free_glyph (glyph);
+	pixman_list_unlink (&glyph->mru_link);
+	pixman_list_prepend (&shard->removed, &glyph->mru_link);
+
+	pixman_atomic_store (&cache->need_trim, TRUE);
     }
+
+    pixman_spin_unlock (&shard->lock);
+
+    if (glyph)
+	trim_cache (cache);
 }
 
 PIXMAN_EXPORT void
@@ -414,10 +570,19 @@ pixman_composite_glyphs_no_mask (pixman_op_t            op,
     pixman_composite_func_t func = NULL;
     pixman_implementation_t *implementation = NULL;
     pixman_composite_info_t info;
+    pixman_box32_t *access_boxes;
+    pixman_bool_t access;
+    uint64_t start = 0, n_pixels = 0;
+    pixman_bool_t trace = _pixman_trace_enabled;
+    int n_access_boxes;
     int i;
 
+    if (unlikely (trace))
+	start = _pixman_get_time_ns ();
+
     _pixman_image_validate (src);
     _pixman_image_validate (dest);
+    _pixman_image_invalidate_mipmap (dest);
     
     dest_format = dest->common.extended_format_code;
     dest_flags = dest->common.flags;
@@ -438,6 +603,19 @@ pixman_composite_glyphs_no_mask (pixman_op_t            op,
     info.src_flags = src->common.flags;
     info.dest_flags = dest->common.flags;
 
+    access_boxes = pixman_region32_rectangles (&region, &n_access_boxes);
+    access = (_pixman_image_has_scanline_access (src) ||
+	      _pixman_image_has_scanline_access (dest));
+
+    if (unlikely (access))
+    {
+	_pixman_image_access (src, access_boxes, n_access_boxes,
+			      src_x - dest_x, src_y - dest_y,
+			      PIXMAN_ACCESS_READ, FALSE);
+	_pixman_image_access (dest, access_boxes, n_access_boxes, 0, 0,
+			      PIXMAN_ACCESS_READ | PIXMAN_ACCESS_WRITE, FALSE);
+    }
+
     for (i = 0; i < n_glyphs; ++i)
     {
 	glyph_t *glyph = (glyph_t *)glyphs[i].glyph;
@@ -487,15 +665,34 @@ pixman_composite_glyphs_no_mask (pixman_op_t            op,
 		info.mask_flags = glyph_flags;
 
 		func (implementation, &info);
+
+		n_pixels += (uint64_t)info.width * info.height;
 	    }
 
 	    pbox++;
 	}
-	pixman_list_move_to_front (&cache->mru, &glyph->mru_link);
+	if (!pixman_atomic_load (&glyph->used))
+	    pixman_atomic_store (&glyph->used, TRUE);
+    }
+
+    if (unlikely (access))
+    {
+	_pixman_image_access (src, access_boxes, n_access_boxes,
+			      src_x - dest_x, src_y - dest_y,
+			      PIXMAN_ACCESS_READ, TRUE);
+	_pixman_image_access (dest, access_boxes, n_access_boxes, 0, 0,
+			      PIXMAN_ACCESS_READ | PIXMAN_ACCESS_WRITE, TRUE);
     }
 
 out:
     pixman_region32_fini (&region);
+
+    if (unlikely (trace))
+    {
+	_pixman_trace_composite (
+	    PIXMAN_TRACE_COMPOSITE_GLYPHS, op, src, PIXMAN_null, dest,
+	    n_glyphs, n_pixels, implementation, start);
+    }
 }
 
 static void
@@ -608,7 +805,8 @@ add_glyphs (pixman_glyph_cache_t *cache,
 
 	    func (implementation, &info);
 
-	    pixman_list_move_to_front (&cache->mru, &glyph->mru_link);
+	    if (!pixman_atomic_load (&glyph->used))
+		pixman_atomic_store (&glyph->used, TRUE);
 	}
     }
 
@@ -654,6 +852,11 @@ pixman_composite_glyphs (pixman_op_t            op,
 			 const pixman_glyph_t  *glyphs)
 {
     pixman_image_t *mask;
+    uint64_t start = 0;
+    pixman_bool_t trace = _pixman_trace_enabled;
+
+    if (unlikely (trace))
+	start = _pixman_get_time_ns ();
 
     if (!(mask = pixman_image_create_bits (mask_format, width, height, NULL, -1)))
 	return;
@@ -673,4 +876,11 @@ pixman_composite_glyphs (pixman_op_t            op,
 			      width, height);
 
     pixman_image_unref (mask);
+
+    if (unlikely (trace))
+    {
+	_pixman_trace_composite (
+	    PIXMAN_TRACE_COMPOSITE_GLYPHS, op, src, mask_format, dest,
+	    n_glyphs, (uint64_t)width * height, NULL, start);
+    }
 }
@@ -128,7 +128,7 @@ _pixman_image_init (pixman_image_t *image)
     common->client_clip = FALSE;
     common->destroy_func = NULL;
     common->destroy_data = NULL;
-    common->dirty = TRUE;
+    common->dirty = IMAGE_DIRTY_ALL;
 }
 
 pixman_bool_t
@@ -136,9 +136,7 @@ _pixman_image_fini (pixman_image_t *image)
 {
     image_common_t *common = (image_common_t *)image;
 
-    common->ref_count--;
-
-    if (common->ref_count == 0)
+    if (pixman_atomic_add (&common->ref_count, -1) == 0)
     {
 	if (image->common.destroy_func)
 	    image->common.destroy_func (image, image->common.destroy_data);
@@ -169,8 +167,13 @@ _pixman_image_fini (pixman_image_t *image)
 		image->common.property_changed == gradient_property_changed);
 	}
 
-	if (image->type == BITS && image->bits.free_me)
-	    free (image->bits.free_me);
+	if (image->type == BITS)
+	{
+	    _pixman_bits_image_fini_mipmap (&image->bits);
+
+	    if (image->bits.free_me)
+		free (image->bits.free_me);
+	}
 
 	return TRUE;
     }
@@ -178,6 +181,100 @@ _pixman_image_fini (pixman_image_t *image)
     return FALSE;
 }
 
+/* Freed images are kept in a small per-thread pool so that programs
+ * creating many short-lived images, such as solid fills, don't go
+ * through the allocator each time. The pool needs a destructor that
+ * frees its images when the thread exits, so it is only there with
+ * pthreads; elsewhere images go straight back to the allocator.
+ */
+#if defined(HAVE_PTHREADS) && !defined(PIXMAN_NO_TLS)
+
+#include <pthread.h>
+
+#define IMAGE_POOL_SIZE 8
+
+typedef struct
+{
+    int			n_images;
+    pixman_image_t *	images[IMAGE_POOL_SIZE];
+} image_pool_t;
+
+static pthread_once_t image_pool_once = PTHREAD_ONCE_INIT;
+static pthread_key_t image_pool_key;
+static pixman_bool_t image_pool_key_created;
+
+static void
+image_pool_destroy (void *data)
+{
+    image_pool_t *pool = data;
+
+    while (pool->n_images)
+	free (pool->images[--pool->n_images]);
+
+    free (pool);
+}
+
+static void
+image_pool_make_key (void)
+{
+    image_pool_key_created =
+	pthread_key_create (&image_pool_key, image_pool_destroy) == 0;
+}
+
+static image_pool_t *
+get_image_pool (void)
+{
+    image_pool_t *pool;
+
+    if (pthread_once (&image_pool_once, image_pool_make_key) != 0 ||
+	!image_pool_key_created)
+    {
+	return NULL;
+    }
+
+    pool = pthread_getspecific (image_pool_key);
+    if (!pool && (pool = calloc (1, sizeof (image_pool_t))))
+    {
+	if (pthread_setspecific (image_pool_key, pool) != 0)
+	{
+	    free (pool);
+	    pool = NULL;
+	}
+    }
+
+    return pool;
+}
+
+pixman_image_t *
+_pixman_image_allocate (void)
+{
+    image_pool_t *pool = get_image_pool ();
+    pixman_image_t *image;
+
+    if (pool && pool->n_images)
+	image = pool->images[--pool->n_images];
+    else
+	image = malloc (sizeof (pixman_image_t));
+
+    if (image)
+	_pixman_image_init (image);
+
+    return image;
+}
+
+static void
+image_release (pixman_image_t *image)
+{
+    image_pool_t *pool = get_image_pool ();
+
+    if (pool && pool->n_images < IMAGE_POOL_SIZE)
+	pool->images[pool->n_images++] = image;
+    else
+	free (image);
+}
+
+#else
+
 pixman_image_t *
 _pixman_image_allocate (void)
 {
@@ -189,17 +286,25 @@ _pixman_image_allocate (void)
     return image;
 }
 
+static void
+image_release (pixman_image_t *image)
+{
+    free (image);
+}
+
+#endif
+
 static void
 image_property_changed (pixman_image_t *image)
 {
-    image->common.dirty = TRUE;
+    image->common.dirty = IMAGE_DIRTY_ALL;
 }
 
 /* Ref Counting */
 PIXMAN_EXPORT pixman_image_t *
 pixman_image_ref (pixman_image_t *image)
 {
-    image->common.ref_count++;
+    pixman_atomic_add (&image->common.ref_count, 1);
 
     return image;
 }
@@ -210,7 +315,7 @@ pixman_image_unref (pixman_image_t *image)
 {
     if (_pixman_image_fini (image))
     {
-	free (image);
+	image_release (image);
 	return TRUE;
     }
 
@@ -261,10 +366,28 @@ pixman_disable_out_of_bounds_workaround (void)
 {
 }
 
-static void
-compute_image_info (pixman_image_t *image)
+/* The flags that only depend on the transform and the filter */
+#define GEOMETRY_FLAGS							\
+    (FAST_PATH_ID_TRANSFORM			|			\
+     FAST_PATH_HAS_TRANSFORM			|			\
+     FAST_PATH_AFFINE_TRANSFORM			|			\
+     FAST_PATH_SCALE_TRANSFORM			|			\
+     FAST_PATH_X_UNIT_POSITIVE			|			\
+     FAST_PATH_Y_UNIT_ZERO			|			\
+     FAST_PATH_ROTATE_90_TRANSFORM		|			\
+     FAST_PATH_ROTATE_180_TRANSFORM		|			\
+     FAST_PATH_ROTATE_270_TRANSFORM		|			\
+     FAST_PATH_FLIP_X_TRANSFORM			|			\
+     FAST_PATH_FLIP_Y_TRANSFORM			|			\
+     FAST_PATH_PROJECTIVE_TRANSFORM		|			\
+     FAST_PATH_NEAREST_FILTER			|			\
+     FAST_PATH_BILINEAR_FILTER			|			\
+     FAST_PATH_NO_CONVOLUTION_FILTER		|			\
+     FAST_PATH_SEPARABLE_CONVOLUTION_FILTER)
+
+static uint32_t
+compute_geometry_flags (pixman_image_t *image)
 {
-    pixman_format_code_t code;
     uint32_t flags = 0;
 
     /* Transform */
@@ -288,11 +411,16 @@ compute_image_info (pixman_image_t *image)
 	    if (image->common.transform->matrix[0][1] == 0 &&
 		image->common.transform->matrix[1][0] == 0)
 	    {
-		if (image->common.transform->matrix[0][0] == -pixman_fixed_1 &&
-		    image->common.transform->matrix[1][1] == -pixman_fixed_1)
-		{
+		pixman_fixed_t m00 = image->common.transform->matrix[0][0];
+		pixman_fixed_t m11 = image->common.transform->matrix[1][1];
+
+		if (m00 == -pixman_fixed_1 && m11 == -pixman_fixed_1)
 		    flags |= FAST_PATH_ROTATE_180_TRANSFORM;
-		}
+		else if (m00 == -pixman_fixed_1 && m11 == pixman_fixed_1)
+		    flags |= FAST_PATH_FLIP_X_TRANSFORM;
+		else if (m00 == pixman_fixed_1 && m11 == -pixman_fixed_1)
+		    flags |= FAST_PATH_FLIP_Y_TRANSFORM;
+
 		flags |= FAST_PATH_SCALE_TRANSFORM;
 	    }
 	    else if (image->common.transform->matrix[0][0] == 0 &&
@@ -307,6 +435,10 @@ compute_image_info (pixman_image_t *image)
 		    flags |= FAST_PATH_ROTATE_270_TRANSFORM;
 	    }
 	}
+	else
+	{
+	    flags |= FAST_PATH_PROJECTIVE_TRANSFORM;
+	}
 
 	if (image->common.transform->matrix[0][0] > 0)
 	    flags |= FAST_PATH_X_UNIT_POSITIVE;
@@ -341,10 +473,12 @@ compute_image_info (pixman_image_t *image)
 	     !pixman_fixed_frac (image->common.transform->matrix[0][2] |
 				 image->common.transform->matrix[1][2])) &&
 	    (
-		/* ... combined with a simple rotation */
+		/* ... combined with a simple rotation or flip */
 		(flags & (FAST_PATH_ROTATE_90_TRANSFORM |
 			  FAST_PATH_ROTATE_180_TRANSFORM |
-			  FAST_PATH_ROTATE_270_TRANSFORM)) ||
+			  FAST_PATH_ROTATE_270_TRANSFORM |
+			  FAST_PATH_FLIP_X_TRANSFORM |
+			  FAST_PATH_FLIP_Y_TRANSFORM)) ||
 		/* ... or combined with a simple non-rotated translation */
 		(image->common.transform->matrix[0][0] == pixman_fixed_1 &&
 		 image->common.transform->matrix[1][1] == pixman_fixed_1 &&
@@ -382,6 +516,15 @@ compute_image_info (pixman_image_t *image)
 	break;
     }
 
+    return flags;
+}
+
+static void
+compute_image_info (pixman_image_t *image)
+{
+    pixman_format_code_t code;
+    uint32_t flags = compute_geometry_flags (image);
+
     /* Repeat mode */
     switch (image->common.repeat)
     {
@@ -460,6 +603,13 @@ compute_image_info (pixman_image_t *image)
 
 	if (PIXMAN_FORMAT_IS_WIDE (image->bits.format))
 	    flags &= ~FAST_PATH_NARROW_FORMAT;
+
+	if ((image->bits.bits_flags & PIXMAN_BITS_WRITABLE_PADDING)	||
+	    (int64_t)image->bits.rowstride * 32 ==
+	    (int64_t)image->bits.width * PIXMAN_FORMAT_BPP (image->bits.format))
+	{
+	    flags |= FAST_PATH_CONTIGUOUS_ROWS;
+	}
 	break;
 
     case RADIAL:
@@ -536,7 +686,15 @@ compute_image_info (pixman_image_t *image)
 void
 _pixman_image_validate (pixman_image_t *image)
 {
-    if (image->common.dirty)
+    if (image->common.dirty == IMAGE_DIRTY_GEOMETRY)
+    {
+	/* Only the transform changed; nothing else depends on it */
+	image->common.flags = (image->common.flags & ~GEOMETRY_FLAGS) |
+	    compute_geometry_flags (image);
+
+	image->common.dirty = 0;
+    }
+    else if (image->common.dirty)
     {
 	compute_image_info (image);
 
@@ -548,7 +706,7 @@ _pixman_image_validate (pixman_image_t *image)
 	if (image->common.property_changed)
 	    image->common.property_changed (image);
 
-	image->common.dirty = FALSE;
+	image->common.dirty = 0;
     }
 
     if (image->common.alpha_map)
@@ -657,7 +815,7 @@ pixman_image_set_transform (pixman_image_t *          image,
     result = TRUE;
 
 out:
-    image_property_changed (image);
+    common->dirty |= IMAGE_DIRTY_GEOMETRY;
 
     return result;
 }
@@ -839,6 +997,65 @@ pixman_image_set_accessors (pixman_image_t *           image,
     }
 }
 
+PIXMAN_EXPORT void
+pixman_image_set_scanline_accessors (pixman_image_t *              image,
+				     pixman_scanline_access_func_t begin_access,
+				     pixman_scanline_access_func_t end_access,
+				     void *                        data)
+{
+    return_if_fail (image != NULL);
+
+    if (image->type == BITS)
+    {
+	image->bits.begin_access = begin_access;
+	image->bits.end_access = end_access;
+	image->bits.access_data = data;
+    }
+}
+
+/* Composites that shrink @image by 2 or more with a bilinear filter
+ * sample a prefiltered half, quarter, ... size copy of it instead.
+ */
+PIXMAN_EXPORT void
+pixman_image_set_mipmap (pixman_image_t *image,
+			 pixman_bool_t   mipmap)
+{
+    return_if_fail (image != NULL);
+
+    if (image->type == BITS)
+    {
+	image->bits.mipmap = mipmap;
+
+	if (!mipmap)
+	    _pixman_bits_image_fini_mipmap (&image->bits);
+    }
+}
+
+/* Trapezoids and triangles added to an a8 @image, or drawn through
+ * a temporary a8 mask onto it, get the exact covered area of each
+ * pixel instead of the RENDER sample grid count.
+ */
+PIXMAN_EXPORT void
+pixman_image_set_analytic_coverage (pixman_image_t *image,
+				    pixman_bool_t   analytic)
+{
+    return_if_fail (image != NULL);
+
+    if (image->type == BITS)
+	image->bits.analytic_coverage = analytic;
+}
+
+/* Must be called after changing the bits of a mipmapped image other
+ * than through pixman.
+ */
+PIXMAN_EXPORT void
+pixman_image_invalidate_mipmap (pixman_image_t *image)
+{
+    return_if_fail (image != NULL);
+
+    _pixman_image_invalidate_mipmap (image);
+}
+
 PIXMAN_EXPORT uint32_t *
 pixman_image_get_data (pixman_image_t *image)
 {
@@ -28,7 +28,8 @@
 #include "pixman-private.h"
 
 pixman_implementation_t *
-_pixman_implementation_create (pixman_implementation_t *fallback,
+_pixman_implementation_create (const char               *name,
+			       pixman_implementation_t  *fallback,
 			       const pixman_fast_path_t *fast_paths)
 {
     pixman_implementation_t *imp;
@@ -41,6 +42,7 @@ _pixman_implementation_create (pixman_implementation_t *fallback,
 
 	memset (imp, 0, sizeof *imp);
 
+	imp->name = name;
 	imp->fallback = fallback;
 	imp->fast_paths = fast_paths;
 	
@@ -229,7 +231,8 @@ _pixman_implementation_lookup_combiner (pixman_implementation_t *imp,
     return dummy_combine;
 }
 
-pixman_bool_t
+/* Returns the implementation that did the work, or NULL */
+pixman_implementation_t *
 _pixman_implementation_blt (pixman_implementation_t * imp,
                             uint32_t *                src_bits,
                             uint32_t *                dst_bits,
@@ -251,16 +254,16 @@ _pixman_implementation_blt (pixman_implementation_t * imp,
 			 src_bpp, dst_bpp, src_x, src_y, dest_x, dest_y,
 			 width, height))
 	{
-	    return TRUE;
+	    return imp;
 	}
 
 	imp = imp->fallback;
     }
 
-    return FALSE;
+    return NULL;
 }
 
-pixman_bool_t
+pixman_implementation_t *
 _pixman_implementation_fill (pixman_implementation_t *imp,
                              uint32_t *               bits,
                              int                      stride,
@@ -276,13 +279,29 @@ _pixman_implementation_fill (pixman_implementation_t *imp,
 	if (imp->fill &&
 	    ((*imp->fill) (imp, bits, stride, bpp, x, y, width, height, filler)))
 	{
-	    return TRUE;
+	    return imp;
 	}
 
 	imp = imp->fallback;
     }
 
-    return FALSE;
+    return NULL;
+}
+
+/* Average each 2x2 block of 8888 pixels in @top and @bottom into one
+ * pixel of @dest. The general implementation always provides this.
+ */
+void
+_pixman_implementation_downsample_2x2 (pixman_implementation_t *imp,
+                                       uint32_t *               dest,
+                                       const uint32_t *         top,
+                                       const uint32_t *         bottom,
+                                       int                      width)
+{
+    while (!imp->downsample_2x2)
+	imp = imp->fallback;
+
+    (*imp->downsample_2x2) (imp, dest, top, bottom, width);
 }
 
 static uint32_t *
@@ -390,6 +409,9 @@ _pixman_choose_implementation (void)
 {
     pixman_implementation_t *imp;
 
+    _pixman_composite_stats_init ();
+    _pixman_trace_init ();
+
     imp = _pixman_implementation_create_general();
 
     if (!_pixman_disabled ("fast"))
@@ -27,6 +27,7 @@
 #define PIXMAN_FAST_PATH_H__
 
 #include "pixman-private.h"
+#include <stdlib.h>
 
 #define PIXMAN_REPEAT_COVER -1
 
@@ -53,6 +54,11 @@
  */
 #define REPEAT_NORMAL_MIN_WIDTH			64
 
+/* Entries of the column table used by the bilinear REFLECT main loop
+ * that live on the stack. Longer tables are allocated.
+ */
+#define REFLECT_TABLE_STACK_SIZE		256
+
 static force_inline pixman_bool_t
 repeat (pixman_repeat_t repeat, int *c, int size)
 {
@@ -222,6 +228,37 @@ bilinear_interpolation (uint32_t tl, uint32_t tr,
 #endif
 #endif // BILINEAR_INTERPOLATION_BITS <= 4
 
+/*
+ * Divide a homogeneous sample position by w, rounding towards zero
+ * like ((pixman_fixed_48_16_t)x << 16) / w, but with floating point
+ * division, which is much cheaper than a 64 bit integer one on most
+ * CPUs. The result is exact: both operands are exact doubles, the
+ * quotient is below 2^47, and a quotient that isn't an integer is at
+ * least 1 / |w| away from one, while the rounding error of the
+ * division is below 2^-6 / |w|.
+ */
+static force_inline void
+projective_divide (pixman_fixed_t  x,
+		   pixman_fixed_t  y,
+		   pixman_fixed_t  w,
+		   pixman_fixed_t *x0,
+		   pixman_fixed_t *y0)
+{
+    double dw;
+
+    if (w == 0)
+    {
+	*x0 = 0;
+	*y0 = 0;
+	return;
+    }
+
+    dw = w;
+
+    *x0 = (pixman_fixed_48_16_t)(x * 65536.0 / dw);
+    *y0 = (pixman_fixed_48_16_t)(y * 65536.0 / dw);
+}
+
 /*
  * For each scanline fetched from source image with PAD repeat:
  * - calculate how many pixels need to be padded on the left side
@@ -752,6 +789,81 @@ fast_composite_scaled_nearest  ## scale_func_name (pixman_implementation_t *imp,
 
 /*****************************************************************************/
 
+/*
+ * Rotations by multiples of 90 degrees and flips, with a translation that
+ * maps pixel centers onto pixel centers. The composite function is shared
+ * by all of them and looks at src_flags to find out which one it got.
+ */
+#define SIMPLE_ROTATE_FLAGS(transform)					\
+    (FAST_PATH_ ## transform ## _TRANSFORM	|			\
+     FAST_PATH_NEAREST_FILTER			|			\
+     FAST_PATH_SAMPLES_COVER_CLIP_NEAREST	|			\
+     FAST_PATH_STANDARD_FLAGS)
+
+#define SIMPLE_ROTATE_FAST_PATH_TRANSFORM(op,s,d,transform,func)	\
+    {   PIXMAN_OP_ ## op,						\
+	PIXMAN_ ## s, SIMPLE_ROTATE_FLAGS (transform),			\
+	PIXMAN_null, 0,							\
+	PIXMAN_ ## d, FAST_PATH_STD_DEST_FLAGS,				\
+	func								\
+    }
+
+#define SIMPLE_ROTATE_FAST_PATH(op,s,d,func)				\
+    SIMPLE_ROTATE_FAST_PATH_TRANSFORM (op,s,d,ROTATE_90,func),		\
+    SIMPLE_ROTATE_FAST_PATH_TRANSFORM (op,s,d,ROTATE_180,func),		\
+    SIMPLE_ROTATE_FAST_PATH_TRANSFORM (op,s,d,ROTATE_270,func),		\
+    SIMPLE_ROTATE_FAST_PATH_TRANSFORM (op,s,d,FLIP_X,func),		\
+    SIMPLE_ROTATE_FAST_PATH_TRANSFORM (op,s,d,FLIP_Y,func)
+
+/*
+ * Find the top left corner of the source rectangle that is sampled by a
+ * width x height composite through one of the transforms above.
+ */
+static force_inline void
+simple_rotate_get_src_origin (pixman_image_t *src_image,
+			      uint32_t        src_flags,
+			      int32_t         src_x,
+			      int32_t         src_y,
+			      int32_t         width,
+			      int32_t         height,
+			      int32_t *       origin_x,
+			      int32_t *       origin_y)
+{
+    pixman_transform_t *t = src_image->common.transform;
+    int32_t tx = pixman_fixed_to_int (
+	t->matrix[0][2] + pixman_fixed_1 / 2 - pixman_fixed_e);
+    int32_t ty = pixman_fixed_to_int (
+	t->matrix[1][2] + pixman_fixed_1 / 2 - pixman_fixed_e);
+
+    if (src_flags & FAST_PATH_ROTATE_90_TRANSFORM)
+    {
+	*origin_x = tx - src_y - height;
+	*origin_y = ty + src_x;
+    }
+    else if (src_flags & FAST_PATH_ROTATE_270_TRANSFORM)
+    {
+	*origin_x = tx + src_y;
+	*origin_y = ty - src_x - width;
+    }
+    else if (src_flags & FAST_PATH_ROTATE_180_TRANSFORM)
+    {
+	*origin_x = tx - src_x - width;
+	*origin_y = ty - src_y - height;
+    }
+    else if (src_flags & FAST_PATH_FLIP_X_TRANSFORM)
+    {
+	*origin_x = tx - src_x - width;
+	*origin_y = ty + src_y;
+    }
+    else
+    {
+	*origin_x = tx + src_x;
+	*origin_y = ty - src_y - height;
+    }
+}
+
+/*****************************************************************************/
+
 /*
  * Identify 5 zones in each scanline for bilinear scaling. Depending on
  * whether 2 pixels to be interpolated are fetched from the image itself,
@@ -847,10 +959,15 @@ fast_composite_scaled_bilinear ## scale_func_name (pixman_implementation_t *imp,
     const mask_type_t *mask = &solid_mask;							\
     int src_stride, mask_stride, dst_stride;							\
 												\
-    int src_width;										\
-    pixman_fixed_t src_width_fixed;								\
+    int src_width = 0;									\
+    pixman_fixed_t src_width_fixed = 0;								\
     int max_x;											\
     pixman_bool_t need_src_extension;								\
+    int32_t reflect_stack[REFLECT_TABLE_STACK_SIZE * 3];					\
+    int32_t *reflect_table = NULL;								\
+    src_type_t *reflect_top = NULL, *reflect_bottom = NULL;					\
+    int reflect_first = 0, reflect_len = 0;							\
+    pixman_bool_t reflect_periodic = FALSE;							\
 												\
     PIXMAN_IMAGE_GET_LINE (dest_image, dest_x, dest_y, dst_type_t, dst_stride, dst_line, 1);	\
     if (flags & FLAG_HAVE_SOLID_MASK)								\
@@ -924,6 +1041,58 @@ fast_composite_scaled_bilinear ## scale_func_name (pixman_implementation_t *imp,
 	src_width_fixed = pixman_int_to_fixed (src_width);					\
     }												\
 												\
+    if (PIXMAN_REPEAT_ ## repeat_mode == PIXMAN_REPEAT_REFLECT)					\
+    {												\
+	int reflect_width = src_image->bits.width;						\
+	int64_t reflect_last;									\
+	int i;											\
+												\
+	/* The reflected column of every source pixel the span touches				\
+	 * is the same for all rows, so look them up once. A span that				\
+	 * is wider than a whole period instead samples a row followed				\
+	 * by its mirror image with the NORMAL repeat code below.				\
+	 */											\
+	reflect_first = pixman_fixed_to_int (v.vector[0]);					\
+	reflect_last = ((v.vector[0] + (width - 1) * (int64_t)unit_x) >> 16) + 1;		\
+												\
+	if (reflect_last - reflect_first < 2 * reflect_width)					\
+	{											\
+	    reflect_len = reflect_last - reflect_first + 1;					\
+	}											\
+	else											\
+	{											\
+	    reflect_first = 0;									\
+	    reflect_periodic = TRUE;								\
+												\
+	    src_width = 2 * reflect_width;							\
+	    while (src_width < REPEAT_NORMAL_MIN_WIDTH)						\
+		src_width += 2 * reflect_width;							\
+												\
+	    src_width_fixed = pixman_int_to_fixed (src_width);					\
+	    reflect_len = src_width;								\
+	}											\
+												\
+	reflect_table = reflect_stack;								\
+	if (reflect_len > REFLECT_TABLE_STACK_SIZE)						\
+	{											\
+	    reflect_table = pixman_malloc_abc (							\
+		reflect_len, 3, MAX (sizeof (int32_t), sizeof (src_type_t)));			\
+	    if (!reflect_table)									\
+		return;										\
+	}											\
+												\
+	reflect_top = (src_type_t *)(reflect_table + reflect_len);				\
+	reflect_bottom = reflect_top + reflect_len;						\
+												\
+	for (i = 0; i < reflect_len; i++)							\
+	{											\
+	    int x = reflect_first + i;								\
+												\
+	    repeat (PIXMAN_REPEAT_REFLECT, &x, reflect_width);					\
+	    reflect_table[i] = x;								\
+	}											\
+    }												\
+												\
     while (--height >= 0)									\
     {												\
 	int weight1, weight2;									\
@@ -1070,7 +1239,8 @@ fast_composite_scaled_bilinear ## scale_func_name (pixman_implementation_t *imp,
 			       buf1, buf2, right_pad, weight1, weight2, 0, 0, 0, TRUE);		\
 	    }											\
 	}											\
-	else if (PIXMAN_REPEAT_ ## repeat_mode == PIXMAN_REPEAT_NORMAL)				\
+	else if (PIXMAN_REPEAT_ ## repeat_mode == PIXMAN_REPEAT_NORMAL ||			\
+		 PIXMAN_REPEAT_ ## repeat_mode == PIXMAN_REPEAT_REFLECT)			\
 	{											\
 	    int32_t	    num_pixels;								\
 	    int32_t	    width_remain;							\
@@ -1082,12 +1252,33 @@ fast_composite_scaled_bilinear ## scale_func_name (pixman_implementation_t *imp,
 	    src_type_t	    extended_src_line1[REPEAT_NORMAL_MIN_WIDTH*2];			\
 	    int		    i, j;								\
 												\
-	    repeat (PIXMAN_REPEAT_NORMAL, &y1, src_image->bits.height);				\
-	    repeat (PIXMAN_REPEAT_NORMAL, &y2, src_image->bits.height);				\
+	    repeat (PIXMAN_REPEAT_ ## repeat_mode, &y1, src_image->bits.height);		\
+	    repeat (PIXMAN_REPEAT_ ## repeat_mode, &y2, src_image->bits.height);		\
 	    src_line_top = src_first_line + src_stride * y1;					\
 	    src_line_bottom = src_first_line + src_stride * y2;					\
 												\
-	    if (need_src_extension)								\
+	    if (PIXMAN_REPEAT_ ## repeat_mode == PIXMAN_REPEAT_REFLECT)				\
+	    {											\
+		for (i = 0; i < reflect_len; i++)						\
+		{										\
+		    reflect_top[i] = src_line_top[reflect_table[i]];				\
+		    reflect_bottom[i] = src_line_bottom[reflect_table[i]];			\
+		}										\
+												\
+		if (!reflect_periodic)								\
+		{										\
+		    scanline_func (dst, mask, reflect_top, reflect_bottom, width,		\
+				   weight1, weight2,						\
+				   vx - pixman_int_to_fixed (reflect_first),			\
+				   unit_x, max_vx, FALSE);					\
+		    continue;									\
+		}										\
+												\
+		src_line_top = reflect_top;							\
+		src_line_bottom = reflect_bottom;						\
+	    }											\
+												\
+	    if (PIXMAN_REPEAT_ ## repeat_mode == PIXMAN_REPEAT_NORMAL && need_src_extension)	\
 	    {											\
 		for (i=0; i<src_width;)								\
 		{										\
@@ -1177,6 +1368,9 @@ fast_composite_scaled_bilinear ## scale_func_name (pixman_implementation_t *imp,
 			   weight1, weight2, vx, unit_x, max_vx, FALSE);			\
 	}											\
     }												\
+												\
+    if (reflect_table != reflect_stack)								\
+	free (reflect_table);									\
 }
 
 /* A workaround for old sun studio, see: https://bugs.freedesktop.org/show_bug.cgi?id=32764 */
@@ -1234,6 +1428,17 @@ fast_composite_scaled_bilinear ## scale_func_name (pixman_implementation_t *imp,
 	fast_composite_scaled_bilinear_ ## func ## _normal ## _ ## op,	\
     }
 
+#define SIMPLE_BILINEAR_FAST_PATH_REFLECT(op,s,d,func)			\
+    {   PIXMAN_OP_ ## op,						\
+	PIXMAN_ ## s,							\
+	(SCALED_BILINEAR_FLAGS		|				\
+	 FAST_PATH_REFLECT_REPEAT	|				\
+	 FAST_PATH_X_UNIT_POSITIVE),					\
+	PIXMAN_null, 0,							\
+	PIXMAN_ ## d, FAST_PATH_STD_DEST_FLAGS,				\
+	fast_composite_scaled_bilinear_ ## func ## _reflect ## _ ## op,	\
+    }
+
 #define SIMPLE_BILINEAR_A8_MASK_FAST_PATH_PAD(op,s,d,func)		\
     {   PIXMAN_OP_ ## op,						\
 	PIXMAN_ ## s,							\
@@ -1276,6 +1481,17 @@ fast_composite_scaled_bilinear ## scale_func_name (pixman_implementation_t *imp,
 	fast_composite_scaled_bilinear_ ## func ## _normal ## _ ## op,	\
     }
 
+#define SIMPLE_BILINEAR_A8_MASK_FAST_PATH_REFLECT(op,s,d,func)		\
+    {   PIXMAN_OP_ ## op,						\
+	PIXMAN_ ## s,							\
+	(SCALED_BILINEAR_FLAGS		|				\
+	 FAST_PATH_REFLECT_REPEAT	|				\
+	 FAST_PATH_X_UNIT_POSITIVE),					\
+	PIXMAN_a8, MASK_FLAGS (a8, FAST_PATH_UNIFIED_ALPHA),		\
+	PIXMAN_ ## d, FAST_PATH_STD_DEST_FLAGS,				\
+	fast_composite_scaled_bilinear_ ## func ## _reflect ## _ ## op,	\
+    }
+
 #define SIMPLE_BILINEAR_SOLID_MASK_FAST_PATH_PAD(op,s,d,func)		\
     {   PIXMAN_OP_ ## op,						\
 	PIXMAN_ ## s,							\
@@ -1318,23 +1534,37 @@ fast_composite_scaled_bilinear ## scale_func_name (pixman_implementation_t *imp,
 	fast_composite_scaled_bilinear_ ## func ## _normal ## _ ## op,	\
     }
 
+#define SIMPLE_BILINEAR_SOLID_MASK_FAST_PATH_REFLECT(op,s,d,func)	\
+    {   PIXMAN_OP_ ## op,						\
+	PIXMAN_ ## s,							\
+	(SCALED_BILINEAR_FLAGS		|				\
+	 FAST_PATH_REFLECT_REPEAT	|				\
+	 FAST_PATH_X_UNIT_POSITIVE),					\
+	PIXMAN_solid, MASK_FLAGS (solid, FAST_PATH_UNIFIED_ALPHA),	\
+	PIXMAN_ ## d, FAST_PATH_STD_DEST_FLAGS,				\
+	fast_composite_scaled_bilinear_ ## func ## _reflect ## _ ## op,	\
+    }
+
 /* Prefer the use of 'cover' variant, because it is faster */
 #define SIMPLE_BILINEAR_FAST_PATH(op,s,d,func)				\
     SIMPLE_BILINEAR_FAST_PATH_COVER (op,s,d,func),			\
     SIMPLE_BILINEAR_FAST_PATH_NONE (op,s,d,func),			\
     SIMPLE_BILINEAR_FAST_PATH_PAD (op,s,d,func),			\
-    SIMPLE_BILINEAR_FAST_PATH_NORMAL (op,s,d,func)
+    SIMPLE_BILINEAR_FAST_PATH_NORMAL (op,s,d,func),		\
+    SIMPLE_BILINEAR_FAST_PATH_REFLECT (op,s,d,func)
 
 #define SIMPLE_BILINEAR_A8_MASK_FAST_PATH(op,s,d,func)			\
     SIMPLE_BILINEAR_A8_MASK_FAST_PATH_COVER (op,s,d,func),		\
     SIMPLE_BILINEAR_A8_MASK_FAST_PATH_NONE (op,s,d,func),		\
     SIMPLE_BILINEAR_A8_MASK_FAST_PATH_PAD (op,s,d,func),		\
-    SIMPLE_BILINEAR_A8_MASK_FAST_PATH_NORMAL (op,s,d,func)
+    SIMPLE_BILINEAR_A8_MASK_FAST_PATH_NORMAL (op,s,d,func),		\
+    SIMPLE_BILINEAR_A8_MASK_FAST_PATH_REFLECT (op,s,d,func)
 
 #define SIMPLE_BILINEAR_SOLID_MASK_FAST_PATH(op,s,d,func)		\
     SIMPLE_BILINEAR_SOLID_MASK_FAST_PATH_COVER (op,s,d,func),		\
     SIMPLE_BILINEAR_SOLID_MASK_FAST_PATH_NONE (op,s,d,func),		\
     SIMPLE_BILINEAR_SOLID_MASK_FAST_PATH_PAD (op,s,d,func),		\
-    SIMPLE_BILINEAR_SOLID_MASK_FAST_PATH_NORMAL (op,s,d,func)
+    SIMPLE_BILINEAR_SOLID_MASK_FAST_PATH_NORMAL (op,s,d,func),		\
+    SIMPLE_BILINEAR_SOLID_MASK_FAST_PATH_REFLECT (op,s,d,func)
 
 #endif
@@ -105,6 +105,27 @@ rounded_sdiv_128_by_49 (int64_t   hi,
                         int64_t   div,
                         int64_t  *signed_result_hi)
 {
+#ifdef __SIZEOF_INT128__
+    unsigned __int128 n = ((unsigned __int128)(uint64_t)hi << 64) | lo;
+    unsigned __int128 q;
+    uint64_t udiv = div < 0 ? -(uint64_t)div : (uint64_t)div;
+    int sign = (div < 0) ^ (hi < 0);
+
+    if (hi < 0)
+        n = -n;
+
+    q = n / udiv;
+    if ((uint64_t)(n - q * udiv) * 2 >= udiv)
+        q++;
+
+    if (sign)
+        q = -q;
+
+    if (signed_result_hi)
+        *signed_result_hi = (int64_t)(q >> 64);
+
+    return (int64_t)(uint64_t)q;
+#else
     uint64_t result_lo, result_hi;
     int sign = 0;
     if (div < 0)
@@ -133,6 +154,21 @@ rounded_sdiv_128_by_49 (int64_t   hi,
         *signed_result_hi = result_hi;
     }
     return result_lo;
+#endif
+}
+
+/* signed 64-bit division with the same rounding as above */
+static force_inline int64_t
+rounded_sdiv_64 (int64_t n, int64_t div)
+{
+    uint64_t un = n < 0 ? -(uint64_t)n : (uint64_t)n;
+    uint64_t udiv = div < 0 ? -(uint64_t)div : (uint64_t)div;
+    uint64_t q = un / udiv;
+
+    if ((un - q * udiv) * 2 >= udiv)
+        q++;
+
+    return ((n < 0) ^ (div < 0)) ? -(int64_t)q : (int64_t)q;
 }
 
 /*
@@ -184,6 +220,29 @@ fixed_112_16_to_fixed_48_16 (int64_t hi, int64_t lo, pixman_bool_t *clampflag)
     }
 }
 
+/*
+ * Divide a 64.16 fixed point value, scaled by (2^scalebits), by a 49-bit
+ * divisor and convert the result to 48.16. Most dividends fit in 64 bits
+ * once scaled, and those are divided natively.
+ */
+static force_inline pixman_fixed_48_16_t
+fixed_64_16_div (int64_t        num_hi,
+                 int64_t        num_lo,
+                 int64_t        div,
+                 int            scalebits,
+                 pixman_bool_t *clampflag)
+{
+    int64_t hi, lo, rhi, rlo;
+
+    fixed_64_16_to_int128 (num_hi, num_lo, &hi, &lo, scalebits);
+
+    if (hi == (lo >> 63))
+        return rounded_sdiv_64 (lo, div);
+
+    rlo = rounded_sdiv_128_by_49 (hi, lo, div, &rhi);
+    return fixed_112_16_to_fixed_48_16 (rhi, rlo, clampflag);
+}
+
 /*
  * Transform a point with 31.16 fixed point coordinates from the destination
  * space to a point with 48.16 fixed point coordinates in the source space.
@@ -213,6 +272,13 @@ pixman_transform_point_31_16 (const pixman_transform_t    *t,
     assert (v->v[2] <   ((pixman_fixed_48_16_t)1 << (30 + 16)));
     assert (v->v[2] >= -((pixman_fixed_48_16_t)1 << (30 + 16)));
 
+    if (t->matrix[2][0] == 0 && t->matrix[2][1] == 0 &&
+        t->matrix[2][2] == pixman_fixed_1 && v->v[2] == pixman_fixed_1)
+    {
+        pixman_transform_point_31_16_affine (t, v, result);
+        return TRUE;
+    }
+
     for (i = 0; i < 3; i++)
     {
         tmp[i][0] = (int64_t)t->matrix[i][0] * (v->v[0] >> 16);
@@ -272,31 +338,24 @@ pixman_transform_point_31_16 (const pixman_transform_t    *t,
         if (hi32divbits == 0)
         {
             /* the divisor is small, we can actually keep all the bits */
-            int64_t hi, rhi, lo, rlo;
             int64_t div = (divint << 16) + divfrac;
 
-            fixed_64_16_to_int128 (tmp[0][0], tmp[0][1], &hi, &lo, 32);
-            rlo = rounded_sdiv_128_by_49 (hi, lo, div, &rhi);
-            result->v[0] = fixed_112_16_to_fixed_48_16 (rhi, rlo, &clampflag);
-
-            fixed_64_16_to_int128 (tmp[1][0], tmp[1][1], &hi, &lo, 32);
-            rlo = rounded_sdiv_128_by_49 (hi, lo, div, &rhi);
-            result->v[1] = fixed_112_16_to_fixed_48_16 (rhi, rlo, &clampflag);
+            result->v[0] = fixed_64_16_div (tmp[0][0], tmp[0][1], div, 32,
+                                            &clampflag);
+            result->v[1] = fixed_64_16_div (tmp[1][0], tmp[1][1], div, 32,
+                                            &clampflag);
         }
         else
         {
             /* the divisor needs to be reduced to 48 bits */
-            int64_t hi, rhi, lo, rlo, div;
+            int64_t hi, div;
             int shift = 32 - count_leading_zeros (hi32divbits);
             fixed_64_16_to_int128 (divint, divfrac, &hi, &div, 16 - shift);
 
-            fixed_64_16_to_int128 (tmp[0][0], tmp[0][1], &hi, &lo, 32 - shift);
-            rlo = rounded_sdiv_128_by_49 (hi, lo, div, &rhi);
-            result->v[0] = fixed_112_16_to_fixed_48_16 (rhi, rlo, &clampflag);
-
-            fixed_64_16_to_int128 (tmp[1][0], tmp[1][1], &hi, &lo, 32 - shift);
-            rlo = rounded_sdiv_128_by_49 (hi, lo, div, &rhi);
-            result->v[1] = fixed_112_16_to_fixed_48_16 (rhi, rlo, &clampflag);
+            result->v[0] = fixed_64_16_div (tmp[0][0], tmp[0][1], div,
+                                            32 - shift, &clampflag);
+            result->v[1] = fixed_64_16_div (tmp[1][0], tmp[1][1], div,
+                                            32 - shift, &clampflag);
         }
     }
     result->v[2] = pixman_fixed_1;
@@ -419,6 +478,91 @@ pixman_transform_point (const struct pixman_transform *transform,
            vector->vector[2] == tmp.v[2];
 }
 
+static force_inline pixman_bool_t
+transform_is_affine (const pixman_transform_t *t)
+{
+    return t->matrix[2][0] == 0 &&
+           t->matrix[2][1] == 0 &&
+           t->matrix[2][2] == pixman_fixed_1;
+}
+
+static force_inline pixman_bool_t
+transform_point_31_16 (const pixman_transform_t    *t,
+                       pixman_bool_t                affine,
+                       const pixman_vector_48_16_t *v,
+                       pixman_vector_48_16_t       *result)
+{
+    if (affine && v->v[2] == pixman_fixed_1)
+    {
+        pixman_transform_point_31_16_affine (t, v, result);
+        return TRUE;
+    }
+
+    return pixman_transform_point_31_16 (t, v, result);
+}
+
+/*
+ * Transform n_points points the same way as pixman_transform_point_31_16().
+ * Returns FALSE if any of the results had to be clamped.
+ */
+PIXMAN_EXPORT pixman_bool_t
+pixman_transform_points_31_16 (const pixman_transform_t    *t,
+                               const pixman_vector_48_16_t *v,
+                               pixman_vector_48_16_t       *result,
+                               int                          n_points)
+{
+    pixman_bool_t affine = transform_is_affine (t);
+    pixman_bool_t ok = TRUE;
+    int i;
+
+    for (i = 0; i < n_points; i++)
+    {
+        if (!transform_point_31_16 (t, affine, &v[i], &result[i]))
+            ok = FALSE;
+    }
+
+    return ok;
+}
+
+PIXMAN_EXPORT pixman_bool_t
+pixman_transform_points (const struct pixman_transform *transform,
+                         struct pixman_vector *         vectors,
+                         int                            n_vectors)
+{
+    pixman_bool_t affine = transform_is_affine (transform);
+    pixman_bool_t ok = TRUE;
+    int i;
+
+    for (i = 0; i < n_vectors; i++)
+    {
+        struct pixman_vector *vector = &vectors[i];
+        pixman_vector_48_16_t tmp;
+
+        tmp.v[0] = vector->vector[0];
+        tmp.v[1] = vector->vector[1];
+        tmp.v[2] = vector->vector[2];
+
+        if (!transform_point_31_16 (transform, affine, &tmp, &tmp))
+        {
+            ok = FALSE;
+            continue;
+        }
+
+        vector->vector[0] = tmp.v[0];
+        vector->vector[1] = tmp.v[1];
+        vector->vector[2] = tmp.v[2];
+
+        if (vector->vector[0] != tmp.v[0] ||
+            vector->vector[1] != tmp.v[1] ||
+            vector->vector[2] != tmp.v[2])
+        {
+            ok = FALSE;
+        }
+    }
+
+    return ok;
+}
+
 PIXMAN_EXPORT pixman_bool_t
 pixman_transform_multiply (struct pixman_transform *      dst,
                            const struct pixman_transform *l,
@@ -607,11 +751,11 @@ pixman_transform_bounds (const struct pixman_transform *matrix,
     v[3].vector[1] = F (b->y2);
     v[3].vector[2] = F (1);
 
+    if (!pixman_transform_points (matrix, v, 4))
+	return FALSE;
+
     for (i = 0; i < 4; i++)
     {
-	if (!pixman_transform_point (matrix, &v[i]))
-	    return FALSE;
-
 	x1 = pixman_fixed_to_int (v[i].vector[0]);
 	y1 = pixman_fixed_to_int (v[i].vector[1]);
 	x2 = pixman_fixed_to_int (pixman_fixed_ceil (v[i].vector[0]));
@@ -0,0 +1,296 @@
+/*
+ * Copyright 2026 The pixman authors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <math.h>
+#include <stdlib.h>
+#include "pixman-private.h"
+
+/* Mipmaps
+ *
+ * An image with mipmapping enabled keeps a chain of levels, each one a
+ * 2x2 box reduction of the one before it, with an odd last column or
+ * row paired with itself. The levels are built the first time a
+ * composite needs them.
+ *
+ * A bilinear composite whose affine transform shrinks the image by 2 or
+ * more in both directions samples the deepest level that still leaves a
+ * scale of at least 1, so bilinear filtering never skips source pixels.
+ * Level n pixel i covers source pixels 2^n * i to 2^n * (i + 1), so the
+ * transform for level n is the image transform divided by 2^n.
+ *
+ * pixman drops the levels whenever it writes to the image; clients that
+ * change the bits directly call pixman_image_invalidate_mipmap(). The
+ * levels are 8 bits per channel, so wide formats are not mipmapped.
+ *
+ * Several threads may composite from the same image at once: a level
+ * is published with a compare-and-swap, so a thread that loses the race
+ * to build it drops its own copy, and every composite samples the level
+ * through a private image carrying its own transform.
+ */
+
+#define MIPMAP_FLAGS							\
+    (FAST_PATH_AFFINE_TRANSFORM		|				\
+     FAST_PATH_BILINEAR_FILTER		|				\
+     FAST_PATH_NO_ACCESSORS		|				\
+     FAST_PATH_NO_ALPHA_MAP		|				\
+     FAST_PATH_NARROW_FORMAT)
+
+/* Whether the 2x2 reduction can read the pixels directly */
+static pixman_bool_t
+format_is_8888 (pixman_format_code_t format)
+{
+    switch (PIXMAN_FORMAT_TYPE (format))
+    {
+    case PIXMAN_TYPE_ARGB:
+    case PIXMAN_TYPE_ABGR:
+    case PIXMAN_TYPE_BGRA:
+    case PIXMAN_TYPE_RGBA:
+	break;
+
+    default:
+	return FALSE;
+    }
+
+    return (PIXMAN_FORMAT_BPP (format) == 32	&&
+	    PIXMAN_FORMAT_R (format) == 8	&&
+	    PIXMAN_FORMAT_G (format) == 8	&&
+	    PIXMAN_FORMAT_B (format) == 8);
+}
+
+static pixman_image_t *
+create_level (pixman_implementation_t *imp, pixman_image_t *image)
+{
+    bits_image_t *bits = &image->bits;
+    int width = (bits->width + 1) / 2;
+    int height = (bits->height + 1) / 2;
+    pixman_bool_t direct = format_is_8888 (bits->format);
+    uint32_t *buffer = NULL;
+    pixman_format_code_t format;
+    pixman_image_t *level;
+    int y;
+
+    if (direct)
+	format = bits->format;
+    else if (PIXMAN_FORMAT_A (bits->format))
+	format = PIXMAN_a8r8g8b8;
+    else
+	format = PIXMAN_x8r8g8b8;
+
+    level = pixman_image_create_bits_no_clear (format, width, height, NULL, 0);
+    if (!level)
+	return NULL;
+
+    /* Other formats are fetched as a8r8g8b8 two rows at a time */
+    if (!direct)
+    {
+	buffer = pixman_malloc_ab (bits->width, 2 * sizeof (uint32_t));
+	if (!buffer)
+	{
+	    pixman_image_unref (level);
+	    return NULL;
+	}
+    }
+
+    for (y = 0; y < height; ++y)
+    {
+	uint32_t *dest = level->bits.bits + y * level->bits.rowstride;
+	int y0 = 2 * y;
+	int y1 = MIN (y0 + 1, bits->height - 1);
+	const uint32_t *top, *bottom;
+
+	if (direct)
+	{
+	    top = bits->bits + y0 * bits->rowstride;
+	    bottom = bits->bits + y1 * bits->rowstride;
+	}
+	else
+	{
+	    bits->fetch_scanline_32 (bits, 0, y0, bits->width, buffer, NULL);
+	    top = bottom = buffer;
+
+	    if (y1 != y0)
+	    {
+		bits->fetch_scanline_32 (
+		    bits, 0, y1, bits->width, buffer + bits->width, NULL);
+		bottom = buffer + bits->width;
+	    }
+	}
+
+	_pixman_implementation_downsample_2x2 (
+	    imp, dest, top, bottom, bits->width / 2);
+
+	if (bits->width & 1)
+	{
+	    uint32_t edge_top[2], edge_bottom[2];
+
+	    edge_top[0] = edge_top[1] = top[bits->width - 1];
+	    edge_bottom[0] = edge_bottom[1] = bottom[bits->width - 1];
+
+	    _pixman_implementation_downsample_2x2 (
+		imp, dest + width - 1, edge_top, edge_bottom, 1);
+	}
+    }
+
+    free (buffer);
+
+    pixman_image_set_filter (level, PIXMAN_FILTER_BILINEAR, NULL, 0);
+
+    return level;
+}
+
+void
+_pixman_bits_image_fini_mipmap (bits_image_t *image)
+{
+    int i;
+
+    for (i = 0; i < PIXMAN_MAX_MIPMAP_LEVELS && image->mipmap_levels[i]; ++i)
+    {
+	pixman_image_unref (image->mipmap_levels[i]);
+	image->mipmap_levels[i] = NULL;
+    }
+}
+
+static void
+release_level (pixman_image_t *view, void *level)
+{
+    pixman_image_unref (level);
+}
+
+/* Returns a new reference to an image showing the mipmap level that
+ * should stand in for @image as the source of a composite, with its
+ * transform, repeat and component alpha set up, or NULL when no level
+ * applies.
+ */
+pixman_image_t *
+_pixman_image_select_mipmap (pixman_implementation_t *imp,
+			     pixman_image_t          *image)
+{
+    bits_image_t *bits = &image->bits;
+    pixman_transform_t transform;
+    pixman_image_t *level, *view;
+    double sx, sy, scale;
+    int n, i, j;
+
+    if (image->type != BITS || !bits->mipmap)
+	return NULL;
+
+    if ((image->common.flags & MIPMAP_FLAGS) != MIPMAP_FLAGS	||
+	!image->common.transform				||
+	(image->common.have_clip_region && image->common.clip_sources))
+    {
+	return NULL;
+    }
+
+    transform = *image->common.transform;
+
+    /* Distance in the source between horizontally and vertically
+     * adjacent destination pixels.
+     */
+    sx = hypot (pixman_fixed_to_double (transform.matrix[0][0]),
+		pixman_fixed_to_double (transform.matrix[1][0]));
+    sy = hypot (pixman_fixed_to_double (transform.matrix[0][1]),
+		pixman_fixed_to_double (transform.matrix[1][1]));
+    scale = MIN (sx, sy);
+
+    n = 0;
+    while (n < PIXMAN_MAX_MIPMAP_LEVELS		&&
+	   scale >= (double)(2 << n)		&&
+	   (bits->width > (1 << n) || bits->height > (1 << n)))
+    {
+	n++;
+    }
+
+    /* With odd sizes the levels don't tile like the image does */
+    if (image->common.repeat == PIXMAN_REPEAT_NORMAL ||
+	image->common.repeat == PIXMAN_REPEAT_REFLECT)
+    {
+	while (n > 0 && ((bits->width | bits->height) & ((1 << n) - 1)))
+	    n--;
+    }
+
+    if (n == 0)
+	return NULL;
+
+    for (i = 0; i < n; ++i)
+    {
+	if (bits->mipmap_levels[i])
+	    continue;
+
+	if (i == 0)
+	{
+	    _pixman_image_access (image, NULL, 0, 0, 0,
+				  PIXMAN_ACCESS_READ, FALSE);
+	    level = create_level (imp, image);
+	    _pixman_image_access (image, NULL, 0, 0, 0,
+				  PIXMAN_ACCESS_READ, TRUE);
+	}
+	else
+	{
+	    level = create_level (imp, bits->mipmap_levels[i - 1]);
+	}
+
+	if (!level)
+	    return NULL;
+
+	if (!pixman_atomic_cas_ptr (&bits->mipmap_levels[i], NULL, level))
+	    pixman_image_unref (level);
+    }
+
+    level = bits->mipmap_levels[n - 1];
+
+    for (i = 0; i < 2; ++i)
+    {
+	for (j = 0; j < 3; ++j)
+	{
+	    transform.matrix[i][j] =
+		(transform.matrix[i][j] + (1 << (n - 1))) >> n;
+	}
+    }
+
+    view = pixman_image_create_bits_no_clear (
+	level->bits.format, level->bits.width, level->bits.height,
+	level->bits.bits, level->bits.rowstride * sizeof (uint32_t));
+    if (!view)
+	return NULL;
+
+    pixman_image_set_destroy_function (view, release_level,
+				       pixman_image_ref (level));
+
+    if (!pixman_image_set_transform (view, &transform))
+    {
+	pixman_image_unref (view);
+	return NULL;
+    }
+
+    pixman_image_set_filter (view, PIXMAN_FILTER_BILINEAR, NULL, 0);
+    pixman_image_set_repeat (view, image->common.repeat);
+    pixman_image_set_component_alpha (view, image->common.component_alpha);
+
+    _pixman_image_validate (view);
+
+    return view;
+}
@@ -448,7 +448,7 @@ pixman_implementation_t *
 _pixman_implementation_create_mips_dspr2 (pixman_implementation_t *fallback)
 {
     pixman_implementation_t *imp =
-        _pixman_implementation_create (fallback, mips_dspr2_fast_paths);
+        _pixman_implementation_create ("mips-dspr2", fallback, mips_dspr2_fast_paths);
 
     imp->combine_32[PIXMAN_OP_OVER] = mips_dspr2_combine_over_u;
 
@@ -375,6 +375,10 @@ FAST_BILINEAR_MAINLOOP_COMMON (mips_##name##_pad_##op,                       \
 FAST_BILINEAR_MAINLOOP_COMMON (mips_##name##_normal_##op,                    \
                        scaled_bilinear_scanline_mips_##name##_##op,          \
                        src_type, uint32_t, dst_type, NORMAL,                 \
+                       FLAG_NONE)                                            \
+FAST_BILINEAR_MAINLOOP_COMMON (mips_##name##_reflect_##op,                   \
+                       scaled_bilinear_scanline_mips_##name##_##op,          \
+                       src_type, uint32_t, dst_type, REFLECT,                \
                        FLAG_NONE)
 
 /*****************************************************************************/
@@ -427,6 +431,10 @@ FAST_BILINEAR_MAINLOOP_COMMON (mips_##name##_pad_##op,                        \
 FAST_BILINEAR_MAINLOOP_COMMON (mips_##name##_normal_##op,                     \
                        scaled_bilinear_scanline_mips_##name##_##op,           \
                        src_type, uint8_t, dst_type, NORMAL,                   \
+                       FLAG_HAVE_NON_SOLID_MASK)                              \
+FAST_BILINEAR_MAINLOOP_COMMON (mips_##name##_reflect_##op,                    \
+                       scaled_bilinear_scanline_mips_##name##_##op,           \
+                       src_type, uint8_t, dst_type, REFLECT,                  \
                        FLAG_HAVE_NON_SOLID_MASK)
 
 #endif //PIXMAN_MIPS_DSPR2_H
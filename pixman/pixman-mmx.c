@@ -3731,6 +3731,11 @@ FAST_BILINEAR_MAINLOOP_COMMON (mmx_8888_8888_normal_SRC,
 			       uint32_t, uint32_t, uint32_t,
 			       NORMAL, FLAG_NONE)
 
+FAST_BILINEAR_MAINLOOP_COMMON (mmx_8888_8888_reflect_SRC,
+			       scaled_bilinear_scanline_mmx_8888_8888_SRC,
+			       uint32_t, uint32_t, uint32_t,
+			       REFLECT, FLAG_NONE)
+
 static force_inline void
 scaled_bilinear_scanline_mmx_8888_8888_OVER (uint32_t *       dst,
 					     const uint32_t * mask,
@@ -3781,6 +3786,11 @@ FAST_BILINEAR_MAINLOOP_COMMON (mmx_8888_8888_normal_OVER,
 			       uint32_t, uint32_t, uint32_t,
 			       NORMAL, FLAG_NONE)
 
+FAST_BILINEAR_MAINLOOP_COMMON (mmx_8888_8888_reflect_OVER,
+			       scaled_bilinear_scanline_mmx_8888_8888_OVER,
+			       uint32_t, uint32_t, uint32_t,
+			       REFLECT, FLAG_NONE)
+
 static force_inline void
 scaled_bilinear_scanline_mmx_8888_8_8888_OVER (uint32_t *       dst,
 					       const uint8_t  * mask,
@@ -3853,6 +3863,11 @@ FAST_BILINEAR_MAINLOOP_COMMON (mmx_8888_8_8888_normal_OVER,
 			       uint32_t, uint8_t, uint32_t,
 			       NORMAL, FLAG_HAVE_NON_SOLID_MASK)
 
+FAST_BILINEAR_MAINLOOP_COMMON (mmx_8888_8_8888_reflect_OVER,
+			       scaled_bilinear_scanline_mmx_8888_8_8888_OVER,
+			       uint32_t, uint8_t, uint32_t,
+			       REFLECT, FLAG_HAVE_NON_SOLID_MASK)
+
 static uint32_t *
 mmx_fetch_x8r8g8b8 (pixman_iter_t *iter, const uint32_t *mask)
 {
@@ -4112,7 +4127,8 @@ static const pixman_fast_path_t mmx_fast_paths[] =
 pixman_implementation_t *
 _pixman_implementation_create_mmx (pixman_implementation_t *fallback)
 {
-    pixman_implementation_t *imp = _pixman_implementation_create (fallback, mmx_fast_paths);
+    pixman_implementation_t *imp =
+	_pixman_implementation_create ("mmx", fallback, mmx_fast_paths);
 
     imp->combine_32[PIXMAN_OP_OVER] = mmx_combine_over_u;
     imp->combine_32[PIXMAN_OP_OVER_REVERSE] = mmx_combine_over_reverse_u;
@@ -153,7 +153,7 @@ pixman_implementation_t *
 _pixman_implementation_create_noop (pixman_implementation_t *fallback)
 {
     pixman_implementation_t *imp =
-	_pixman_implementation_create (fallback, noop_fast_paths);
+	_pixman_implementation_create ("noop", fallback, noop_fast_paths);
  
     imp->iter_info = noop_iters;
 
@@ -56,6 +56,11 @@ struct argb_t
     float b;
 };
 
+/* Images are less than 0x7fff pixels wide and high, so after this many
+ * halvings they are down to a single pixel.
+ */
+#define PIXMAN_MAX_MIPMAP_LEVELS 15
+
 typedef void (*fetch_scanline_t) (bits_image_t   *image,
 				  int             x,
 				  int             y,
@@ -88,6 +93,10 @@ typedef enum
 
 typedef void (*property_changed_func_t) (pixman_image_t *image);
 
+/* What _pixman_image_validate() has to recompute */
+#define IMAGE_DIRTY_GEOMETRY	(1 << 0)	/* transform and filter flags */
+#define IMAGE_DIRTY_ALL		(~0U)
+
 struct image_common
 {
     image_type_t                type;
@@ -100,7 +109,7 @@ struct image_common
     pixman_bool_t               clip_sources;       /* Whether the clip applies when
 						     * the image is used as a source
 						     */
-    pixman_bool_t		dirty;
+    uint32_t			dirty;		    /* IMAGE_DIRTY_* bits */
     pixman_transform_t *        transform;
     pixman_repeat_t             repeat;
     pixman_filter_t             filter;
@@ -179,6 +188,7 @@ struct bits_image
     uint32_t *                 bits;
     uint32_t *                 free_me;
     int                        rowstride;  /* in number of uint32_t's */
+    uint32_t                   bits_flags; /* pixman_bits_flags_t */
 
     fetch_scanline_t           fetch_scanline_32;
     fetch_pixel_32_t	       fetch_pixel_32;
@@ -191,6 +201,18 @@ struct bits_image
     /* Used for indirect access to the bits */
     pixman_read_memory_func_t  read_func;
     pixman_write_memory_func_t write_func;
+
+    /* Used for direct access bracketed by begin and end calls */
+    pixman_scanline_access_func_t begin_access;
+    pixman_scanline_access_func_t end_access;
+    void *                        access_data;
+
+    /* Lazily built 2x2 box reductions, see pixman-mipmap.c */
+    pixman_bool_t              mipmap;
+    pixman_image_t *           mipmap_levels[PIXMAN_MAX_MIPMAP_LEVELS];
+
+    /* Trapezoids added to an a8 image cover exact areas, see pixman-edge.c */
+    pixman_bool_t              analytic_coverage;
 };
 
 union pixman_image
@@ -279,12 +301,52 @@ struct pixman_iter_info_t
 void
 _pixman_bits_image_setup_accessors (bits_image_t *image);
 
+void
+_pixman_image_access (pixman_image_t       *image,
+                      const pixman_box32_t *boxes,
+                      int                   n_boxes,
+                      int                   dx,
+                      int                   dy,
+                      uint32_t              access,
+                      pixman_bool_t         end);
+
+static force_inline pixman_bool_t
+_pixman_image_has_scanline_access (pixman_image_t *image)
+{
+    bits_image_t *alpha;
+
+    if (!image || image->type != BITS)
+	return 0;
+
+    alpha = image->common.alpha_map;
+
+    return (image->bits.begin_access || image->bits.end_access ||
+	    (alpha && (alpha->begin_access || alpha->end_access)));
+}
+
+void
+_pixman_bits_image_fini_mipmap (bits_image_t *image);
+
+/* Drop the mipmap levels of an image whose bits pixman is writing to */
+static force_inline void
+_pixman_image_invalidate_mipmap (pixman_image_t *image)
+{
+    if (image->type == BITS && image->bits.mipmap_levels[0])
+	_pixman_bits_image_fini_mipmap (&image->bits);
+}
+
 void
 _pixman_bits_image_src_iter_init (pixman_image_t *image, pixman_iter_t *iter);
 
 void
 _pixman_bits_image_dest_iter_init (pixman_image_t *image, pixman_iter_t *iter);
 
+void
+_pixman_bits_image_prefetch_scanline (pixman_image_t *image,
+				      int             x,
+				      int             y,
+				      int             width);
+
 void
 _pixman_linear_gradient_iter_init (pixman_image_t *image, pixman_iter_t  *iter);
 
@@ -304,7 +366,11 @@ _pixman_bits_image_init (pixman_image_t *     image,
                          int                  height,
                          uint32_t *           bits,
                          int                  rowstride,
-			 pixman_bool_t	      clear);
+			 uint32_t	      bits_flags);
+void
+_pixman_image_init_solid_fill (pixman_image_t *      image,
+                               const pixman_color_t *color);
+
 pixman_bool_t
 _pixman_image_fini (pixman_image_t *image);
 
@@ -398,6 +464,20 @@ pixman_rasterize_edges_accessors (pixman_image_t *image,
                                   pixman_fixed_t  t,
                                   pixman_fixed_t  b);
 
+void
+pixman_rasterize_trapezoid_analytic_accessors (pixman_image_t            *image,
+                                               pixman_fixed_t             top,
+                                               pixman_fixed_t             bottom,
+                                               const pixman_line_fixed_t *left,
+                                               const pixman_line_fixed_t *right);
+
+void
+_pixman_rasterize_trapezoid_analytic (pixman_image_t            *image,
+                                      pixman_fixed_t             top,
+                                      pixman_fixed_t             bottom,
+                                      const pixman_line_fixed_t *left,
+                                      const pixman_line_fixed_t *right);
+
 /*
  * Implementations
  */
@@ -475,6 +555,11 @@ typedef pixman_bool_t (*pixman_fill_func_t) (pixman_implementation_t *imp,
 					     int                      width,
 					     int                      height,
 					     uint32_t                 filler);
+typedef void (*pixman_downsample_func_t) (pixman_implementation_t *imp,
+					  uint32_t *               dest,
+					  const uint32_t *         top,
+					  const uint32_t *         bottom,
+					  int                      width);
 
 void _pixman_setup_combiner_functions_32 (pixman_implementation_t *imp);
 void _pixman_setup_combiner_functions_float (pixman_implementation_t *imp);
@@ -493,6 +578,7 @@ typedef struct
 
 struct pixman_implementation_t
 {
+    const char *		name;
     pixman_implementation_t *	toplevel;
     pixman_implementation_t *	fallback;
     const pixman_fast_path_t *	fast_paths;
@@ -500,6 +586,7 @@ struct pixman_implementation_t
 
     pixman_blt_func_t		blt;
     pixman_fill_func_t		fill;
+    pixman_downsample_func_t	downsample_2x2;
 
     pixman_combine_32_func_t	combine_32[PIXMAN_N_OPERATORS];
     pixman_combine_32_func_t	combine_32_ca[PIXMAN_N_OPERATORS];
@@ -513,7 +600,8 @@ _pixman_image_get_solid (pixman_implementation_t *imp,
                          pixman_format_code_t     format);
 
 pixman_implementation_t *
-_pixman_implementation_create (pixman_implementation_t *fallback,
+_pixman_implementation_create (const char               *name,
+			       pixman_implementation_t  *fallback,
 			       const pixman_fast_path_t *fast_paths);
 
 void
@@ -534,7 +622,7 @@ _pixman_implementation_lookup_combiner (pixman_implementation_t *imp,
 					pixman_bool_t		 component_alpha,
 					pixman_bool_t		 wide);
 
-pixman_bool_t
+pixman_implementation_t *
 _pixman_implementation_blt (pixman_implementation_t *imp,
                             uint32_t *               src_bits,
                             uint32_t *               dst_bits,
@@ -549,7 +637,7 @@ _pixman_implementation_blt (pixman_implementation_t *imp,
                             int                      width,
                             int                      height);
 
-pixman_bool_t
+pixman_implementation_t *
 _pixman_implementation_fill (pixman_implementation_t *imp,
                              uint32_t *               bits,
                              int                      stride,
@@ -560,6 +648,17 @@ _pixman_implementation_fill (pixman_implementation_t *imp,
                              int                      height,
                              uint32_t                 filler);
 
+void
+_pixman_implementation_downsample_2x2 (pixman_implementation_t *imp,
+                                       uint32_t *               dest,
+                                       const uint32_t *         top,
+                                       const uint32_t *         bottom,
+                                       int                      width);
+
+pixman_image_t *
+_pixman_image_select_mipmap (pixman_implementation_t *imp,
+			     pixman_image_t          *image);
+
 void
 _pixman_implementation_iter_init (pixman_implementation_t       *imp,
                                   pixman_iter_t                 *iter,
@@ -623,6 +722,9 @@ _pixman_implementation_disabled (const char *name);
 pixman_implementation_t *
 _pixman_x86_get_implementations (pixman_implementation_t *imp);
 
+size_t
+_pixman_x86_get_cache_size (void);
+
 pixman_implementation_t *
 _pixman_arm_get_implementations (pixman_implementation_t *imp);
 
@@ -700,6 +802,10 @@ _pixman_iter_init_bits_stride (pixman_iter_t *iter, const pixman_iter_info_t *in
 #define FAST_PATH_SAMPLES_COVER_CLIP_BILINEAR	(1 << 24)
 #define FAST_PATH_BITS_IMAGE			(1 << 25)
 #define FAST_PATH_SEPARABLE_CONVOLUTION_FILTER  (1 << 26)
+#define FAST_PATH_CONTIGUOUS_ROWS		(1 << 27)
+#define FAST_PATH_FLIP_X_TRANSFORM		(1 << 28)
+#define FAST_PATH_FLIP_Y_TRANSFORM		(1 << 29)
+#define FAST_PATH_PROJECTIVE_TRANSFORM		(1 << 30)
 
 #define FAST_PATH_PAD_REPEAT						\
     (FAST_PATH_NO_NONE_REPEAT		|				\
@@ -758,6 +864,17 @@ _pixman_iter_init_bits_stride (pixman_iter_t *iter, const pixman_iter_info_t *in
 	    dest, FAST_PATH_STD_DEST_FLAGS,				\
 	    func) }
 
+/* Like PIXMAN_STD_FAST_PATH, but for paths that may involve formats
+ * which the general implementation would composite in floating point.
+ */
+#define PIXMAN_WIDE_FAST_PATH(op, src, mask, dest, func)		\
+    { FAST_PATH (							\
+	    op,								\
+	    src,  SOURCE_FLAGS (src) & ~FAST_PATH_NARROW_FORMAT,	\
+	    mask, MASK_FLAGS (mask, FAST_PATH_UNIFIED_ALPHA),		\
+	    dest, FAST_PATH_STD_DEST_FLAGS & ~FAST_PATH_NARROW_FORMAT,	\
+	    func) }
+
 #define PIXMAN_STD_FAST_PATH_CA(op, src, mask, dest, func)		\
     { FAST_PATH (							\
 	    op,								\
@@ -773,7 +890,13 @@ get_implementation (void)
 {
 #ifndef TOOLCHAIN_SUPPORTS_ATTRIBUTE_CONSTRUCTOR
     if (!global_implementation)
-	global_implementation = _pixman_choose_implementation ();
+    {
+	/* Threads racing here each build a chain; the losers' are
+	 * leaked, as the chain is never freed anyway.
+	 */
+	pixman_atomic_cas_ptr (&global_implementation, NULL,
+			       _pixman_choose_implementation ());
+    }
 #endif
     return global_implementation;
 }
@@ -1008,6 +1131,76 @@ unorm_to_unorm (uint32_t val, int from_bits, int to_bits)
 uint16_t pixman_float_to_unorm (float f, int n_bits);
 float pixman_unorm_to_float (uint16_t u, int n_bits);
 
+/* IEEE half precision, rounding to nearest even. Infinities and NaNs
+ * are kept, denormals are handled exactly.
+ */
+typedef union
+{
+    uint32_t u;
+    float f;
+} pixman_float_bits_t;
+
+static force_inline float
+pixman_half_to_float (uint16_t h)
+{
+    pixman_float_bits_t o, magic;
+
+    magic.u = 113 << 23;
+    o.u = (h & 0x7fff) << 13;
+
+    if ((o.u & (0x7c00 << 13)) == (0x7c00 << 13))
+    {
+	o.u += (255 - 31) << 23;
+    }
+    else if ((o.u & (0x7c00 << 13)) == 0)
+    {
+	o.u += 113 << 23;
+	o.f -= magic.f;
+    }
+    else
+    {
+	o.u += (127 - 15) << 23;
+    }
+
+    o.u |= (uint32_t)(h & 0x8000) << 16;
+
+    return o.f;
+}
+
+static force_inline uint16_t
+pixman_float_to_half (float f)
+{
+    pixman_float_bits_t v, denorm_magic;
+    uint32_t sign;
+    uint16_t h;
+
+    v.f = f;
+    sign = v.u & 0x80000000;
+    v.u ^= sign;
+
+    if (v.u >= (127 + 16) << 23)
+    {
+	/* Too large, infinity or NaN */
+	h = v.u > 255 << 23 ? 0x7e00 : 0x7c00;
+    }
+    else if (v.u < 113 << 23)
+    {
+	/* Denormal or zero; the addition does the rounding */
+	denorm_magic.u = ((127 - 15) + (23 - 10) + 1) << 23;
+	v.f += denorm_magic.f;
+	h = v.u - denorm_magic.u;
+    }
+    else
+    {
+	uint32_t mant_odd = (v.u >> 13) & 1;
+
+	v.u += ((uint32_t)(15 - 127) << 23) + 0xfff + mant_odd;
+	h = v.u >> 13;
+    }
+
+    return h | (sign >> 16);
+}
+
 /*
  * Various debugging code
  */
@@ -1078,6 +1271,12 @@ pixman_transform_point_31_16 (const pixman_transform_t    *t,
                               const pixman_vector_48_16_t *v,
                               pixman_vector_48_16_t       *result);
 
+pixman_bool_t
+pixman_transform_points_31_16 (const pixman_transform_t    *t,
+                               const pixman_vector_48_16_t *v,
+                               pixman_vector_48_16_t       *result,
+                               int                          n_points);
+
 void
 pixman_transform_point_31_16_3d (const pixman_transform_t    *t,
                                  const pixman_vector_48_16_t *v,
@@ -1147,6 +1346,49 @@ void pixman_timer_register (pixman_timer_t *timer);
 
 #endif /* PIXMAN_TIMERS */
 
+uint64_t
+_pixman_get_time_ns (void);
+
+/*
+ * Composite statistics
+ */
+extern pixman_bool_t _pixman_composite_stats_enabled;
+
+void
+_pixman_composite_stats_init (void);
+
+void
+_pixman_composite_stats_record (const pixman_composite_info_t *info,
+				pixman_format_code_t           src_format,
+				pixman_format_code_t           mask_format,
+				pixman_format_code_t           dest_format,
+				pixman_implementation_t       *imp,
+				uint64_t                       n_pixels,
+				uint64_t                       time_ns);
+
+/*
+ * Tracing
+ */
+extern pixman_bool_t _pixman_trace_enabled;
+
+void
+_pixman_trace_init (void);
+
+void
+_pixman_trace_emit (pixman_trace_event_t *event,
+		    uint64_t              start);
+
+void
+_pixman_trace_composite (pixman_trace_call_t      call,
+			 pixman_op_t              op,
+			 pixman_image_t          *src,
+			 pixman_format_code_t     mask_format,
+			 pixman_image_t          *dest,
+			 int                      n_items,
+			 uint64_t                 n_pixels,
+			 pixman_implementation_t *imp,
+			 uint64_t                 start);
+
 #endif /* __ASSEMBLER__ */
 
 #endif /* PIXMAN_PRIVATE_H */
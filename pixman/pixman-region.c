@@ -2588,39 +2588,189 @@ bitmap_addrect (region_type_t *reg,
     return r;
 }
 
-/* Convert bitmap clip mask into clipping region.
- * First, goes through each line and makes boxes by noting the transitions
- * from 0 to 1 and 1 to 0.
+static force_inline int
+count_trailing_zeros (uint32_t x)
+{
+#ifdef HAVE_BUILTIN_CLZ
+    return __builtin_ctz (x);
+#else
+    int n = 0;
+    while (!(x & 1))
+    {
+        n++;
+        x >>= 1;
+    }
+    return n;
+#endif
+}
+
+static force_inline int
+count_leading_zeros (uint32_t x)
+{
+#ifdef HAVE_BUILTIN_CLZ
+    return __builtin_clz (x);
+#else
+    int n = 0;
+    while (!(x & 0x80000000))
+    {
+        n++;
+        x <<= 1;
+    }
+    return n;
+#endif
+}
+
+/* Index of the Screen left most set bit of a non-zero word */
+#ifdef WORDS_BIGENDIAN
+#define FIRST_SCREEN_BIT(w) count_leading_zeros (w)
+#else
+#define FIRST_SCREEN_BIT(w) count_trailing_zeros (w)
+#endif
+
+/* Adds a box for every run of set bits in a row of a 1 bpp bitmap.
+ * Whole words of 0s outside a box and of 1s inside one are skipped,
+ * and the other words are only visited at their 0/1 transitions.
+ */
+static box_type_t *
+bitmap_add_row (region_type_t  *region,
+                box_type_t     *rects,
+                box_type_t    **first_rect,
+                const uint32_t *pw,
+                int             width,
+                int             y)
+{
+    const uint32_t *pw_end = pw + ((width + 31) >> 5);
+    uint32_t w, transitions, inv = 0;
+    int base, ib, rx1 = 0;
+
+    for (base = 0; pw < pw_end; base += 32)
+    {
+        w = READ(pw++);
+
+        /* Inside a box inv is all 1s, so this looks for the next 0
+         * instead of the next 1 */
+        if (!(transitions = w ^ inv))
+            continue;
+
+        /* Clear the bits beyond the end of the line, so that a box
+         * running into them ends at the line end */
+        if (pw == pw_end && (width & 31))
+        {
+            w &= ~SCREEN_SHIFT_RIGHT (0xffffffff, width & 31);
+            transitions = w ^ inv;
+        }
+
+        while (transitions)
+        {
+            ib = FIRST_SCREEN_BIT (transitions);
+
+            if (inv)
+            {
+                rects = bitmap_addrect (region, rects, first_rect,
+                                        rx1, y, base + ib, y + 1);
+                if (rects == NULL)
+                    return NULL;
+            }
+            else
+            {
+                rx1 = base + ib;
+            }
+
+            inv = ~inv;
+
+            /* Bit ib and those visually right of it */
+            transitions = (w ^ inv) & SCREEN_SHIFT_RIGHT (0xffffffff, ib);
+        }
+    }
+
+    /* If the line ended with the last bit set, end the box */
+    if (inv)
+        rects = bitmap_addrect (region, rects, first_rect, rx1, y, width, y + 1);
+
+    return rects;
+}
+
+static force_inline uint32_t
+threshold_word (const uint8_t *row, int n, uint8_t threshold)
+{
+    uint32_t mask0 = 0xffffffff & ~SCREEN_SHIFT_RIGHT(0xffffffff, 1);
+    uint32_t w = 0;
+    int ib;
+
+    for (ib = 0; ib < n; ib++)
+        w |= SCREEN_SHIFT_RIGHT ((row[ib] >= threshold) * mask0, ib);
+
+    return w;
+}
+
+/* Sets the bits of the pixels in an a8 row that are at least @threshold */
+static void
+threshold_row (uint32_t      *pw,
+               const uint8_t *row,
+               int            width,
+               uint8_t        threshold)
+{
+    const uint32_t *p;
+    uint32_t all_or, all_and;
+    int base, i;
+
+    for (base = 0; base + 32 <= width; base += 32)
+    {
+        /* Masks are mostly runs of a single value, which can be
+         * recognized four pixels at a time */
+        p = (const uint32_t *)(row + base);
+        all_or = 0;
+        all_and = 0xffffffff;
+        for (i = 0; i < 8; i++)
+        {
+            all_or |= p[i];
+            all_and &= p[i];
+        }
+
+        if (all_or == all_and && all_or == (all_or & 0xff) * 0x01010101)
+            *pw++ = (all_or & 0xff) >= threshold ? 0xffffffff : 0;
+        else
+            *pw++ = threshold_word (row + base, 32, threshold);
+    }
+
+    if (base < width)
+        *pw = threshold_word (row + base, width - base, threshold);
+}
+
+/* Convert an a1 mask, or an a8 mask cut at @threshold, into a region.
+ * First, goes through each line and makes boxes from the runs of set
+ * pixels.
  * Then it coalesces the current line with the previous if they have boxes
  * at the same X coordinates.
- * Stride is in number of uint32_t per line.
+ * The region must have been initialized empty.
  */
-PIXMAN_EXPORT void
-PREFIX (_init_from_image) (region_type_t *region,
-                           pixman_image_t *image)
+static void
+init_from_mask (region_type_t  *region,
+                pixman_image_t *image,
+                uint8_t         threshold)
 {
-    uint32_t mask0 = 0xffffffff & ~SCREEN_SHIFT_RIGHT(0xffffffff, 1);
     box_type_t *first_rect, *rects, *prect_line_start;
     box_type_t *old_rect, *new_rect;
-    uint32_t *pw, w, *pw_line, *pw_line_end;
+    uint32_t *pw, *pw_line, *row_bits = NULL;
     int	irect_prev_start, irect_line_start;
-    int	h, base, rx1 = 0, crects;
-    int	ib;
-    pixman_bool_t in_box, same;
+    int	h, crects;
+    pixman_bool_t same;
     int width, height, stride;
 
-    PREFIX(_init) (region);
-
     critical_if_fail (region->data);
 
-    return_if_fail (image->type == BITS);
-    return_if_fail (image->bits.format == PIXMAN_a1);
-
     pw_line = pixman_image_get_data (image);
     width = pixman_image_get_width (image);
     height = pixman_image_get_height (image);
     stride = pixman_image_get_stride (image) / 4;
 
+    if (image->bits.format == PIXMAN_a8)
+    {
+        row_bits = pixman_malloc_ab ((width + 31) / 32, sizeof (uint32_t));
+        if (!row_bits)
+            return;
+    }
+
     first_rect = PIXREGION_BOXPTR(region);
     rects = first_rect;
 
@@ -2633,104 +2783,16 @@ PREFIX (_init_from_image) (region_type_t *region,
         pw_line += stride;
         irect_line_start = rects - first_rect;
 
-        /* If the Screen left most bit of the word is set, we're starting in
-         * a box */
-        if (READ(pw) & mask0)
-        {
-            in_box = TRUE;
-            rx1 = 0;
-        }
-        else
+        if (row_bits)
         {
-            in_box = FALSE;
+            threshold_row (row_bits, (uint8_t *)pw, width, threshold);
+            pw = row_bits;
         }
 
-        /* Process all words which are fully in the pixmap */
-        pw_line_end = pw + (width >> 5);
-        for (base = 0; pw < pw_line_end; base += 32)
-        {
-            w = READ(pw++);
-            if (in_box)
-            {
-                if (!~w)
-                    continue;
-            }
-            else
-            {
-                if (!w)
-                    continue;
-            }
-            for (ib = 0; ib < 32; ib++)
-            {
-                /* If the Screen left most bit of the word is set, we're
-                 * starting a box */
-                if (w & mask0)
-                {
-                    if (!in_box)
-                    {
-                        rx1 = base + ib;
-                        /* start new box */
-                        in_box = TRUE;
-                    }
-                }
-                else
-                {
-                    if (in_box)
-                    {
-                        /* end box */
-                        rects = bitmap_addrect (region, rects, &first_rect,
-                                                rx1, h, base + ib, h + 1);
-                        if (rects == NULL)
-                            goto error;
-                        in_box = FALSE;
-                    }
-                }
-                /* Shift the word VISUALLY left one. */
-                w = SCREEN_SHIFT_LEFT(w, 1);
-            }
-        }
+        rects = bitmap_add_row (region, rects, &first_rect, pw, width, h);
+        if (rects == NULL)
+            goto error;
 
-        if (width & 31)
-        {
-            /* Process final partial word on line */
-             w = READ(pw++);
-            for (ib = 0; ib < (width & 31); ib++)
-            {
-                /* If the Screen left most bit of the word is set, we're
-                 * starting a box */
-                if (w & mask0)
-                {
-                    if (!in_box)
-                    {
-                        rx1 = base + ib;
-                        /* start new box */
-                        in_box = TRUE;
-                    }
-                }
-                else
-                {
-                    if (in_box)
-                    {
-                        /* end box */
-                        rects = bitmap_addrect(region, rects, &first_rect,
-					       rx1, h, base + ib, h + 1);
-			if (rects == NULL)
-			    goto error;
-                        in_box = FALSE;
-                    }
-                }
-                /* Shift the word VISUALLY left one. */
-                w = SCREEN_SHIFT_LEFT(w, 1);
-            }
-        }
-        /* If scanline ended with last bit set, end the box */
-        if (in_box)
-        {
-            rects = bitmap_addrect(region, rects, &first_rect,
-				   rx1, h, base + (width & 31), h + 1);
-	    if (rects == NULL)
-		goto error;
-        }
         /* if all rectangles on this line have the same x-coords as
          * those on the previous line, then add 1 to all the previous  y2s and
          * throw away all the rectangles from this line
@@ -2788,5 +2850,43 @@ PREFIX (_init_from_image) (region_type_t *region,
     }
 
  error:
-    return;
+    free (row_bits);
+}
+
+/* Convert bitmap clip mask into clipping region. */
+PIXMAN_EXPORT void
+PREFIX (_init_from_image) (region_type_t *region,
+                           pixman_image_t *image)
+{
+    PREFIX(_init) (region);
+
+    return_if_fail (image->type == BITS);
+    return_if_fail (image->bits.format == PIXMAN_a1);
+
+    init_from_mask (region, image, 1);
+}
+
+/* Convert an a1 or a8 mask into a region containing the pixels whose
+ * value is at least @threshold. For a1 masks, any non-zero threshold
+ * selects the set pixels.
+ */
+PIXMAN_EXPORT void
+PREFIX (_init_from_image_threshold) (region_type_t  *region,
+                                     pixman_image_t *image,
+                                     uint8_t         threshold)
+{
+    PREFIX(_init) (region);
+
+    return_if_fail (image->type == BITS);
+    return_if_fail (image->bits.format == PIXMAN_a1 ||
+                    image->bits.format == PIXMAN_a8);
+
+    if (threshold == 0)
+    {
+        PREFIX(_init_rect) (region, 0, 0,
+                            image->bits.width, image->bits.height);
+        return;
+    }
+
+    init_from_mask (region, image, threshold);
 }
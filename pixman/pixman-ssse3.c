@@ -343,7 +343,7 @@ pixman_implementation_t *
 _pixman_implementation_create_ssse3 (pixman_implementation_t *fallback)
 {
     pixman_implementation_t *imp =
-	_pixman_implementation_create (fallback, ssse3_fast_paths);
+	_pixman_implementation_create ("ssse3", fallback, ssse3_fast_paths);
 
     imp->iter_info = ssse3_iters;
 
@@ -0,0 +1,248 @@
+/*
+ * Copyright 2026 The pixman authors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "pixman-private.h"
+
+/* Runtime composite statistics
+ *
+ * The table is a fixed size open addressed hash keyed on the lookup
+ * signature and the implementation that handled it. Once it is full,
+ * composites with new signatures are counted in n_dropped only.
+ *
+ * Recording is serialized with a spinlock; it is only taken when the
+ * statistics are enabled, so it costs nothing in the normal case.
+ */
+#define N_STATS		1024
+#define STATS_MASK	(N_STATS - 1)
+
+pixman_bool_t _pixman_composite_stats_enabled;
+
+static pixman_composite_stats_t stats_table[N_STATS];
+static int n_used;
+static uint64_t n_dropped;
+
+static pixman_spinlock_t stats_lock;
+
+static uint32_t
+hash_signature (const pixman_composite_stats_t *key)
+{
+    uint32_t h = key->op;
+
+    h = h * 31 + key->src_format;
+    h = h * 31 + key->src_flags;
+    h = h * 31 + key->mask_format;
+    h = h * 31 + key->mask_flags;
+    h = h * 31 + key->dest_format;
+    h = h * 31 + key->dest_flags;
+    h = h * 31 + (uint32_t)(uintptr_t)key->implementation;
+
+    return h ^ (h >> 16);
+}
+
+static pixman_bool_t
+same_signature (const pixman_composite_stats_t *a,
+		const pixman_composite_stats_t *b)
+{
+    return a->op == b->op					&&
+	   a->src_format == b->src_format			&&
+	   a->src_flags == b->src_flags				&&
+	   a->mask_format == b->mask_format			&&
+	   a->mask_flags == b->mask_flags			&&
+	   a->dest_format == b->dest_format			&&
+	   a->dest_flags == b->dest_flags			&&
+	   a->implementation == b->implementation;
+}
+
+void
+_pixman_composite_stats_record (const pixman_composite_info_t *info,
+				pixman_format_code_t           src_format,
+				pixman_format_code_t           mask_format,
+				pixman_format_code_t           dest_format,
+				pixman_implementation_t       *imp,
+				uint64_t                       n_pixels,
+				uint64_t                       time_ns)
+{
+    pixman_composite_stats_t key;
+    uint32_t i;
+
+    /* The counters are copied into new entries along with the key */
+    memset (&key, 0, sizeof (key));
+    key.op = info->op;
+    key.src_format = src_format;
+    key.src_flags = info->src_flags;
+    key.mask_format = mask_format;
+    key.mask_flags = info->mask_flags;
+    key.dest_format = dest_format;
+    key.dest_flags = info->dest_flags;
+    key.implementation = imp->name;
+
+    i = hash_signature (&key) & STATS_MASK;
+
+    pixman_spin_lock (&stats_lock);
+
+    for (;;)
+    {
+	pixman_composite_stats_t *entry = &stats_table[i];
+
+	if (entry->n_calls == 0)
+	{
+	    if (n_used == N_STATS / 2)
+	    {
+		/* Keep the load factor low enough for probing to be cheap */
+		n_dropped++;
+		break;
+	    }
+
+	    *entry = key;
+	    n_used++;
+	}
+	else if (!same_signature (entry, &key))
+	{
+	    i = (i + 1) & STATS_MASK;
+	    continue;
+	}
+
+	entry->n_calls++;
+	entry->n_pixels += n_pixels;
+	entry->time_ns += time_ns;
+	break;
+    }
+
+    pixman_spin_unlock (&stats_lock);
+}
+
+static int
+compare_time (const void *a, const void *b)
+{
+    const pixman_composite_stats_t *sa = a;
+    const pixman_composite_stats_t *sb = b;
+
+    if (sa->time_ns != sb->time_ns)
+	return sa->time_ns < sb->time_ns ? 1 : -1;
+
+    return 0;
+}
+
+static void
+dump_stats (void)
+{
+    pixman_composite_stats_t *stats;
+    int i, n;
+
+    n = pixman_composite_stats_get (NULL, 0);
+    if (!(stats = pixman_malloc_ab (n + 1, sizeof (pixman_composite_stats_t))))
+	return;
+
+    n = pixman_composite_stats_get (stats, n);
+    qsort (stats, n, sizeof (pixman_composite_stats_t), compare_time);
+
+    fprintf (stderr,
+	     "pixman composite statistics (%d signatures, %llu dropped)\n"
+	     "%-10s %3s %-17s %-17s %-17s %10s %12s %10s\n",
+	     n, (unsigned long long)n_dropped,
+	     "impl", "op", "src/flags", "mask/flags", "dest/flags",
+	     "calls", "pixels", "ms");
+
+    for (i = 0; i < n; ++i)
+    {
+	const pixman_composite_stats_t *s = &stats[i];
+
+	fprintf (stderr,
+		 "%-10s %3d %08x/%08x %08x/%08x %08x/%08x "
+		 "%10llu %12llu %10.3f\n",
+		 s->implementation, s->op,
+		 s->src_format, s->src_flags,
+		 s->mask_format, s->mask_flags,
+		 s->dest_format, s->dest_flags,
+		 (unsigned long long)s->n_calls,
+		 (unsigned long long)s->n_pixels,
+		 s->time_ns / 1000000.0);
+    }
+
+    free (stats);
+}
+
+void
+_pixman_composite_stats_init (void)
+{
+    const char *env = getenv ("PIXMAN_COMPOSITE_STATS");
+
+    if (env && *env && strcmp (env, "0") != 0)
+    {
+	_pixman_composite_stats_enabled = TRUE;
+
+	atexit (dump_stats);
+    }
+}
+
+PIXMAN_EXPORT void
+pixman_composite_stats_enable (pixman_bool_t enable)
+{
+    _pixman_composite_stats_enabled = !!enable;
+}
+
+PIXMAN_EXPORT void
+pixman_composite_stats_reset (void)
+{
+    pixman_spin_lock (&stats_lock);
+
+    memset (stats_table, 0, sizeof (stats_table));
+    n_used = 0;
+    n_dropped = 0;
+
+    pixman_spin_unlock (&stats_lock);
+}
+
+/* Copies up to n_stats entries into stats and returns the total
+ * number of signatures recorded so far.
+ */
+PIXMAN_EXPORT int
+pixman_composite_stats_get (pixman_composite_stats_t *stats,
+			    int                       n_stats)
+{
+    int i, n;
+
+    pixman_spin_lock (&stats_lock);
+
+    n = 0;
+    for (i = 0; i < N_STATS; ++i)
+    {
+	if (stats_table[i].n_calls == 0)
+	    continue;
+
+	if (n < n_stats)
+	    stats[n] = stats_table[i];
+	n++;
+    }
+
+    pixman_spin_unlock (&stats_lock);
+
+    return n;
+}
@@ -25,8 +25,48 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#if defined(HAVE_CLOCK_GETTIME)
+#include <time.h>
+#elif defined(_WIN32)
+#include <windows.h>
+#elif defined(HAVE_GETTIMEOFDAY)
+#include <sys/time.h>
+#endif
 #include "pixman-private.h"
 
+/* Monotonic time in nanoseconds. Unlike the PIXMAN_TIMERS machinery
+ * below, this is always compiled in; it is used by the runtime
+ * composite statistics.
+ */
+uint64_t
+_pixman_get_time_ns (void)
+{
+#if defined(HAVE_CLOCK_GETTIME) && defined(CLOCK_MONOTONIC)
+    struct timespec ts;
+
+    clock_gettime (CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec * (uint64_t)1000000000 + ts.tv_nsec;
+#elif defined(_WIN32)
+    static LARGE_INTEGER freq;
+    LARGE_INTEGER count;
+
+    if (!freq.QuadPart)
+	QueryPerformanceFrequency (&freq);
+    QueryPerformanceCounter (&count);
+
+    return (uint64_t)(count.QuadPart * (1000000000.0 / freq.QuadPart));
+#elif defined(HAVE_GETTIMEOFDAY)
+    struct timeval tv;
+
+    gettimeofday (&tv, NULL);
+
+    return tv.tv_sec * (uint64_t)1000000000 + tv.tv_usec * (uint64_t)1000;
+#else
+    return 0;
+#endif
+}
+
 #ifdef PIXMAN_TIMERS
 
 static pixman_timer_t *timers;
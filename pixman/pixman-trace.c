@@ -0,0 +1,119 @@
+/*
+ * Copyright 2026 The pixman authors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#ifdef HAVE_SYS_SDT_H
+#include <sys/sdt.h>
+#endif
+#include "pixman-private.h"
+
+/* Events are only put together when a trace function is installed or
+ * PIXMAN_TRACE is set; otherwise each entry point pays one branch.
+ */
+pixman_bool_t _pixman_trace_enabled;
+
+static pixman_bool_t trace_env;
+static pixman_trace_func_t trace_function;
+static void *trace_data;
+
+void
+_pixman_trace_init (void)
+{
+    const char *env = getenv ("PIXMAN_TRACE");
+
+    if (env && *env && strcmp (env, "0") != 0)
+    {
+	trace_env = TRUE;
+	_pixman_trace_enabled = TRUE;
+    }
+}
+
+PIXMAN_EXPORT void
+pixman_set_trace_function (pixman_trace_func_t function,
+			   void               *data)
+{
+    trace_function = function;
+    trace_data = data;
+
+    _pixman_trace_enabled = trace_env || function != NULL;
+}
+
+void
+_pixman_trace_emit (pixman_trace_event_t *event,
+		    uint64_t              start)
+{
+    pixman_trace_func_t function = trace_function;
+
+    event->time_ns = _pixman_get_time_ns () - start;
+
+#ifdef HAVE_SYS_SDT_H
+    DTRACE_PROBE8 (pixman, call,
+		   event->call, event->op,
+		   event->src_format, event->mask_format, event->dest_format,
+		   event->n_pixels, event->implementation, event->time_ns);
+#endif
+
+    if (function)
+	function (event, trace_data);
+}
+
+static int
+image_bpp (pixman_image_t *image)
+{
+    if (image && image->type == BITS)
+	return PIXMAN_FORMAT_BPP (image->bits.format);
+
+    return 0;
+}
+
+void
+_pixman_trace_composite (pixman_trace_call_t      call,
+			 pixman_op_t              op,
+			 pixman_image_t          *src,
+			 pixman_format_code_t     mask_format,
+			 pixman_image_t          *dest,
+			 int                      n_items,
+			 uint64_t                 n_pixels,
+			 pixman_implementation_t *imp,
+			 uint64_t                 start)
+{
+    pixman_trace_event_t event;
+
+    event.call = call;
+    event.op = op;
+    event.src_format = src ? src->common.extended_format_code : PIXMAN_null;
+    event.mask_format = mask_format;
+    event.dest_format = dest->common.extended_format_code;
+    event.src_bpp = image_bpp (src);
+    event.dest_bpp = image_bpp (dest);
+    event.n_items = n_items;
+    event.n_pixels = n_pixels;
+    event.implementation = imp ? imp->name : NULL;
+
+    _pixman_trace_emit (&event, start);
+}
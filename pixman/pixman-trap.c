@@ -229,6 +229,25 @@ pixman_line_fixed_edge_init (pixman_edge_t *            e,
                       bot->y + y_off_fixed);
 }
 
+static pixman_bool_t
+use_analytic_coverage (pixman_image_t *image)
+{
+    return image->bits.analytic_coverage &&
+	PIXMAN_FORMAT_BPP (image->bits.format) == 8;
+}
+
+static void
+offset_line (pixman_line_fixed_t *line,
+	     pixman_fixed_t x1, pixman_fixed_t y1,
+	     pixman_fixed_t x2, pixman_fixed_t y2,
+	     pixman_fixed_t x_off, pixman_fixed_t y_off)
+{
+    line->p1.x = x1 + x_off;
+    line->p1.y = y1 + y_off;
+    line->p2.x = x2 + x_off;
+    line->p2.y = y2 + y_off;
+}
+
 PIXMAN_EXPORT void
 pixman_add_traps (pixman_image_t *     image,
                   int16_t              x_off,
@@ -252,6 +271,27 @@ pixman_add_traps (pixman_image_t *     image,
     x_off_fixed = pixman_int_to_fixed (x_off);
     y_off_fixed = pixman_int_to_fixed (y_off);
 
+    if (use_analytic_coverage (image))
+    {
+	for (; ntrap--; traps++)
+	{
+	    pixman_line_fixed_t left, right;
+
+	    if (traps->bot.y <= traps->top.y)
+		continue;
+
+	    offset_line (&left, traps->top.l, traps->top.y,
+			 traps->bot.l, traps->bot.y, x_off_fixed, y_off_fixed);
+	    offset_line (&right, traps->top.r, traps->top.y,
+			 traps->bot.r, traps->bot.y, x_off_fixed, y_off_fixed);
+
+	    _pixman_rasterize_trapezoid_analytic (
+		image, left.p1.y, left.p2.y, &left, &right);
+	}
+
+	return;
+    }
+
     while (ntrap--)
     {
 	t = traps->top.y + y_off_fixed;
@@ -362,6 +402,26 @@ pixman_rasterize_trapezoid (pixman_image_t *          image,
     if (!pixman_trapezoid_valid (trap))
 	return;
 
+    if (use_analytic_coverage (image))
+    {
+	pixman_fixed_t x_off_fixed = pixman_int_to_fixed (x_off);
+	pixman_line_fixed_t left, right;
+
+	y_off_fixed = pixman_int_to_fixed (y_off);
+
+	offset_line (&left, trap->left.p1.x, trap->left.p1.y,
+		     trap->left.p2.x, trap->left.p2.y,
+		     x_off_fixed, y_off_fixed);
+	offset_line (&right, trap->right.p1.x, trap->right.p1.y,
+		     trap->right.p2.x, trap->right.p2.y,
+		     x_off_fixed, y_off_fixed);
+
+	_pixman_rasterize_trapezoid_analytic (
+	    image, trap->top + y_off_fixed, trap->bottom + y_off_fixed,
+	    &left, &right);
+	return;
+    }
+
     height = image->bits.height;
     bpp = PIXMAN_FORMAT_BPP (image->bits.format);
 
@@ -489,6 +549,8 @@ pixman_composite_trapezoids (pixman_op_t		op,
 			     int			n_traps,
 			     const pixman_trapezoid_t *	traps)
 {
+    uint64_t start = 0, n_pixels = 0;
+    pixman_bool_t trace = _pixman_trace_enabled;
     int i;
 
     return_if_fail (PIXMAN_FORMAT_TYPE (mask_format) == PIXMAN_TYPE_A);
@@ -496,6 +558,9 @@ pixman_composite_trapezoids (pixman_op_t		op,
     if (n_traps <= 0)
 	return;
 
+    if (unlikely (trace))
+	start = _pixman_get_time_ns ();
+
     _pixman_image_validate (src);
     _pixman_image_validate (dst);
 
@@ -526,6 +591,8 @@ pixman_composite_trapezoids (pixman_op_t		op,
 	if (!(tmp = pixman_image_create_bits (
 		  mask_format, box.x2 - box.x1, box.y2 - box.y1, NULL, -1)))
 	    return;
+
+	tmp->bits.analytic_coverage = dst->bits.analytic_coverage;
 	
 	for (i = 0; i < n_traps; ++i)
 	{
@@ -544,6 +611,15 @@ pixman_composite_trapezoids (pixman_op_t		op,
 				box.x2 - box.x1, box.y2 - box.y1);
 	
 	pixman_image_unref (tmp);
+
+	n_pixels = (uint64_t)(box.x2 - box.x1) * (box.y2 - box.y1);
+    }
+
+    if (unlikely (trace))
+    {
+	_pixman_trace_composite (
+	    PIXMAN_TRACE_COMPOSITE_TRAPEZOIDS, op, src, mask_format, dst,
+	    n_traps, n_pixels, NULL, start);
     }
 }
 
@@ -28,8 +28,32 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+#if defined(_WIN32)
+#include <windows.h>
+#elif defined(HAVE_PTHREADS)
+#include <sched.h>
+#endif
+
 #include "pixman-private.h"
 
+void
+_pixman_spin_wait (volatile int32_t *p, int32_t value)
+{
+    int i = 0;
+
+    while (pixman_atomic_load (p) == value)
+    {
+	if (++i % 64 == 0)
+	{
+#if defined(_WIN32)
+	    Sleep (0);
+#elif defined(HAVE_PTHREADS)
+	    sched_yield ();
+#endif
+	}
+    }
+}
+
 pixman_bool_t
 _pixman_multiply_overflows_size (size_t a, size_t b)
 {
@@ -3115,7 +3115,8 @@ static const pixman_iter_info_t vmx_iters[] =
 pixman_implementation_t *
 _pixman_implementation_create_vmx (pixman_implementation_t *fallback)
 {
-    pixman_implementation_t *imp = _pixman_implementation_create (fallback, vmx_fast_paths);
+    pixman_implementation_t *imp =
+	_pixman_implementation_create ("vmx", fallback, vmx_fast_paths);
 
     /* VMX constants */
     mask_ff000000 = create_mask_32_128 (0xff000000);
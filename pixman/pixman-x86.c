@@ -72,6 +72,12 @@ detect_cpu_features (void)
     return features;
 }
 
+static size_t
+detect_cache_size (void)
+{
+    return 0;
+}
+
 #else
 
 #define _PIXMAN_X86_64							\
@@ -110,7 +116,7 @@ have_cpuid (void)
 }
 
 static void
-pixman_cpuid (uint32_t feature,
+pixman_cpuid (uint32_t feature, uint32_t index,
 	      uint32_t *a, uint32_t *b, uint32_t *c, uint32_t *d)
 {
 #if defined (__GNUC__)
@@ -119,7 +125,7 @@ pixman_cpuid (uint32_t feature,
     __asm__ volatile (
         "cpuid"				"\n\t"
 	: "=a" (*a), "=b" (*b), "=c" (*c), "=d" (*d)
-	: "a" (feature));
+	: "a" (feature), "c" (index));
 #else
     /* On x86-32 we need to be careful about the handling of %ebx
      * and %esp. We can't declare either one as clobbered
@@ -134,13 +140,13 @@ pixman_cpuid (uint32_t feature,
 	"cpuid"				"\n\t"
 	"xchg %%ebx, %1"		"\n\t"
 	: "=a" (*a), "=r" (*b), "=c" (*c), "=d" (*d)
-	: "a" (feature));
+	: "a" (feature), "c" (index));
 #endif
 
 #elif defined (_MSC_VER)
     int info[4];
 
-    __cpuid (info, feature);
+    __cpuidex (info, feature, index);
 
     *a = info[0];
     *b = info[1];
@@ -161,7 +167,7 @@ detect_cpu_features (void)
 	return features;
 
     /* Get feature bits */
-    pixman_cpuid (0x01, &a, &b, &c, &d);
+    pixman_cpuid (0x01, 0, &a, &b, &c, &d);
     if (d & (1 << 15))
 	features |= X86_CMOV;
     if (d & (1 << 23))
@@ -181,7 +187,7 @@ detect_cpu_features (void)
 	/* Get vendor string */
 	memset (vendor, 0, sizeof vendor);
 
-	pixman_cpuid (0x00, &a, &b, &c, &d);
+	pixman_cpuid (0x00, 0, &a, &b, &c, &d);
 	memcpy (vendor + 0, &b, 4);
 	memcpy (vendor + 4, &d, 4);
 	memcpy (vendor + 8, &c, 4);
@@ -189,10 +195,10 @@ detect_cpu_features (void)
 	if (strcmp (vendor, "AuthenticAMD") == 0 ||
 	    strcmp (vendor, "Geode by NSC") == 0)
 	{
-	    pixman_cpuid (0x80000000, &a, &b, &c, &d);
+	    pixman_cpuid (0x80000000, 0, &a, &b, &c, &d);
 	    if (a >= 0x80000001)
 	    {
-		pixman_cpuid (0x80000001, &a, &b, &c, &d);
+		pixman_cpuid (0x80000001, 0, &a, &b, &c, &d);
 
 		if (d & (1 << 22))
 		    features |= X86_MMX_EXTENSIONS;
@@ -203,6 +209,64 @@ detect_cpu_features (void)
     return features;
 }
 
+/* Walk the deterministic cache parameters (leaf 4 on Intel,
+ * 0x8000001d on AMD) and return the size of the last level data or
+ * unified cache, or 0 if the CPU doesn't tell.
+ */
+static size_t
+detect_cache_size (void)
+{
+    uint32_t a, b, c, d;
+    uint32_t leaf, max_leaf, i;
+    char vendor[13];
+    size_t size = 0;
+    int level = 0;
+
+    if (!have_cpuid())
+	return 0;
+
+    memset (vendor, 0, sizeof vendor);
+
+    pixman_cpuid (0x00, 0, &max_leaf, &b, &c, &d);
+    memcpy (vendor + 0, &b, 4);
+    memcpy (vendor + 4, &d, 4);
+    memcpy (vendor + 8, &c, 4);
+
+    leaf = 0x04;
+
+    if (strcmp (vendor, "AuthenticAMD") == 0)
+    {
+	pixman_cpuid (0x80000000, 0, &max_leaf, &b, &c, &d);
+	leaf = 0x8000001d;
+    }
+
+    if (max_leaf < leaf)
+	return 0;
+
+    for (i = 0; i < 16; ++i)
+    {
+	uint32_t type;
+
+	pixman_cpuid (leaf, i, &a, &b, &c, &d);
+
+	type = a & 0x1f;
+	if (type == 0)
+	    break;
+
+	/* Data or unified */
+	if ((type == 1 || type == 3) && (int)((a >> 5) & 0x7) >= level)
+	{
+	    level = (a >> 5) & 0x7;
+	    size = (size_t)((b >> 22) + 1) *		/* ways */
+		   (((b >> 12) & 0x3ff) + 1) *		/* partitions */
+		   ((b & 0xfff) + 1) *			/* line size */
+		   (c + 1);				/* sets */
+	}
+    }
+
+    return size;
+}
+
 #endif
 
 static pixman_bool_t
@@ -220,6 +284,21 @@ have_feature (cpu_features_t feature)
     return (features & feature) == feature;
 }
 
+size_t
+_pixman_x86_get_cache_size (void)
+{
+    static pixman_bool_t initialized;
+    static size_t size;
+
+    if (!initialized)
+    {
+	size = detect_cache_size();
+	initialized = TRUE;
+    }
+
+    return size;
+}
+
 #endif
 
 pixman_implementation_t *
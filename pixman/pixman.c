@@ -53,6 +53,9 @@ struct operator_info_t
 	    (uint8_t)PIXMAN_OP_ ## dest,		\
 	    (uint8_t)PIXMAN_OP_ ## both		}}
 
+/* SATURATE only reduces to DST for an opaque destination if the source
+ * is premultiplied; the combiners add sources whose alpha is zero.
+ */
 static const operator_info_t operator_table[] =
 {
     /*    Neither Opaque         Src Opaque             Dst Opaque             Both Opaque */
@@ -69,7 +72,7 @@ static const operator_info_t operator_table[] =
     PACK (ATOP_REVERSE,          OVER_REVERSE,          IN_REVERSE,            DST),
     PACK (XOR,                   OUT,                   OUT_REVERSE,           CLEAR),
     PACK (ADD,                   ADD,                   ADD,                   ADD),
-    PACK (SATURATE,              OVER_REVERSE,          DST,                   DST),
+    PACK (SATURATE,              OVER_REVERSE,          SATURATE,              DST),
 
     {{ 0 /* 0x0e */ }},
     {{ 0 /* 0x0f */ }},
@@ -140,13 +143,18 @@ optimize_operator (pixman_op_t     op,
     pixman_bool_t is_source_opaque, is_dest_opaque;
 
 #define OPAQUE_SHIFT 13
+#define SAMPLES_OPAQUE_SHIFT 7
     
     COMPILE_TIME_ASSERT (FAST_PATH_IS_OPAQUE == (1 << OPAQUE_SHIFT));
-    
-    is_dest_opaque = (dst_flags & FAST_PATH_IS_OPAQUE);
+    COMPILE_TIME_ASSERT (FAST_PATH_SAMPLES_OPAQUE == (1 << SAMPLES_OPAQUE_SHIFT));
+
+    /* The destination is only read inside its bounds, so its repeat
+     * doesn't matter; opaque samples make it opaque.
+     */
+    is_dest_opaque = (dst_flags & FAST_PATH_SAMPLES_OPAQUE);
     is_source_opaque = ((src_flags & mask_flags) & FAST_PATH_IS_OPAQUE);
 
-    is_dest_opaque >>= OPAQUE_SHIFT - 1;
+    is_dest_opaque >>= SAMPLES_OPAQUE_SHIFT - 1;
     is_source_opaque >>= OPAQUE_SHIFT;
 
     return operator_table[op].opaque_info[is_dest_opaque | is_source_opaque];
@@ -342,6 +350,7 @@ compute_transformed_extents (pixman_transform_t   *transform,
 {
     pixman_fixed_48_16_t tx1, ty1, tx2, ty2;
     pixman_fixed_t x1, y1, x2, y2;
+    pixman_vector_t v[4];
     int i;
 
     x1 = pixman_int_to_fixed (extents->x1) + pixman_fixed_1 / 2;
@@ -359,23 +368,25 @@ compute_transformed_extents (pixman_transform_t   *transform,
 	return TRUE;
     }
 
+    for (i = 0; i < 4; ++i)
+    {
+	v[i].vector[0] = (i & 0x01)? x1 : x2;
+	v[i].vector[1] = (i & 0x02)? y1 : y2;
+	v[i].vector[2] = pixman_fixed_1;
+    }
+
+    if (!pixman_transform_points (transform, v, 4))
+	return FALSE;
+
     tx1 = ty1 = INT64_MAX;
     tx2 = ty2 = INT64_MIN;
 
     for (i = 0; i < 4; ++i)
     {
 	pixman_fixed_48_16_t tx, ty;
-	pixman_vector_t v;
 
-	v.vector[0] = (i & 0x01)? x1 : x2;
-	v.vector[1] = (i & 0x02)? y1 : y2;
-	v.vector[2] = pixman_fixed_1;
-
-	if (!pixman_transform_point (transform, &v))
-	    return FALSE;
-
-	tx = (pixman_fixed_48_16_t)v.vector[0];
-	ty = (pixman_fixed_48_16_t)v.vector[1];
+	tx = (pixman_fixed_48_16_t)v[i].vector[0];
+	ty = (pixman_fixed_48_16_t)v[i].vector[1];
 
 	if (tx < tx1)
 	    tx1 = tx;
@@ -540,6 +551,59 @@ analyze_extent (pixman_image_t       *image,
     return TRUE;
 }
 
+/* Distance in pixels between the rows of a bits image, or 0 if it
+ * isn't a whole number of pixels.
+ */
+static int
+span_stride (pixman_image_t *image)
+{
+    int bpp = PIXMAN_FORMAT_BPP (image->bits.format);
+
+    if (bpp < 8 || (image->bits.rowstride * 32) % bpp != 0)
+	return 0;
+
+    return image->bits.rowstride * 32 / bpp;
+}
+
+#define SPAN_FLAGS							\
+    (FAST_PATH_BITS_IMAGE		|				\
+     FAST_PATH_ID_TRANSFORM		|				\
+     FAST_PATH_NO_ACCESSORS		|				\
+     FAST_PATH_NO_ALPHA_MAP		|				\
+     FAST_PATH_NO_NORMAL_REPEAT		|				\
+     FAST_PATH_SAMPLES_COVER_CLIP_NEAREST)
+
+#define SPAN_DEST_FLAGS							\
+    (FAST_PATH_STD_DEST_FLAGS		|				\
+     FAST_PATH_CONTIGUOUS_ROWS)
+
+/* Bracket a composite operation on images with scanline accessors.
+ * The destination is read and written only inside the composite
+ * region.
+ */
+static void
+composite_access (pixman_composite_info_t *info,
+		  const pixman_box32_t    *boxes,
+		  int                      n_boxes,
+		  int                      src_dx,
+		  int                      src_dy,
+		  int                      mask_dx,
+		  int                      mask_dy,
+		  pixman_bool_t            end)
+{
+    _pixman_image_access (info->src_image, boxes, n_boxes,
+			  src_dx, src_dy, PIXMAN_ACCESS_READ, end);
+
+    if (info->mask_image)
+    {
+	_pixman_image_access (info->mask_image, boxes, n_boxes,
+			      mask_dx, mask_dy, PIXMAN_ACCESS_READ, end);
+    }
+
+    _pixman_image_access (info->dest_image, boxes, n_boxes, 0, 0,
+			  PIXMAN_ACCESS_READ | PIXMAN_ACCESS_WRITE, end);
+}
+
 /*
  * Work around GCC bug causing crashes in Mozilla with SSE2
  *
@@ -576,17 +640,32 @@ pixman_image_composite32 (pixman_op_t      op,
     pixman_format_code_t src_format, mask_format, dest_format;
     pixman_region32_t region;
     pixman_box32_t extents;
-    pixman_implementation_t *imp;
+    pixman_implementation_t *imp = NULL;
     pixman_composite_func_t func;
     pixman_composite_info_t info;
+    pixman_image_t *mipmap;
     const pixman_box32_t *pbox;
-    int n;
-
+    pixman_bool_t stats = _pixman_composite_stats_enabled;
+    pixman_bool_t trace = _pixman_trace_enabled;
+    uint64_t start = 0, n_pixels = 0;
+    pixman_bool_t access;
+    int stride;
+    int i, n;
+
+    if (unlikely (stats | trace))
+	start = _pixman_get_time_ns ();
+
+    /* This writes to images that changed since their last use, which
+     * is why pixman.h asks for that use to happen before sharing them
+     */
     _pixman_image_validate (src);
     if (mask)
 	_pixman_image_validate (mask);
     _pixman_image_validate (dest);
 
+    if ((mipmap = _pixman_image_select_mipmap (get_implementation (), src)))
+	src = mipmap;
+
     src_format = src->common.extended_format_code;
     info.src_flags = src->common.flags;
 
@@ -686,24 +765,90 @@ pixman_image_composite32 (pixman_op_t      op,
 
     pbox = pixman_region32_rectangles (&region, &n);
 
-    while (n--)
+    access = (_pixman_image_has_scanline_access (src)	||
+	      _pixman_image_has_scanline_access (mask)	||
+	      _pixman_image_has_scanline_access (dest));
+
+    if (unlikely (access))
+	composite_access (&info, pbox, n, src_x - dest_x, src_y - dest_y,
+			  mask_x - dest_x, mask_y - dest_y, FALSE);
+
+    /* When the images are plain memory with the same distance between
+     * rows, and the destination padding may be overwritten, a box that
+     * covers whole rows can be composited as a single long row. The
+     * general implementation is left alone because its fetchers clip
+     * to the image width.
+     */
+    stride = 0;
+    if (imp->fallback && !access &&
+	(info.dest_flags & SPAN_DEST_FLAGS) == SPAN_DEST_FLAGS)
+    {
+	stride = span_stride (dest);
+
+	if (src_format != PIXMAN_solid &&
+	    ((info.src_flags & SPAN_FLAGS) != SPAN_FLAGS ||
+	     span_stride (src) != stride))
+	{
+	    stride = 0;
+	}
+
+	if (mask_format != PIXMAN_null && mask_format != PIXMAN_solid &&
+	    ((info.mask_flags & SPAN_FLAGS) != SPAN_FLAGS ||
+	     span_stride (mask) != stride))
+	{
+	    stride = 0;
+	}
+    }
+
+    for (i = 0; i < n; ++i)
     {
-	info.src_x = pbox->x1 + src_x - dest_x;
-	info.src_y = pbox->y1 + src_y - dest_y;
-	info.mask_x = pbox->x1 + mask_x - dest_x;
-	info.mask_y = pbox->y1 + mask_y - dest_y;
-	info.dest_x = pbox->x1;
-	info.dest_y = pbox->y1;
-	info.width = pbox->x2 - pbox->x1;
-	info.height = pbox->y2 - pbox->y1;
+	info.src_x = pbox[i].x1 + src_x - dest_x;
+	info.src_y = pbox[i].y1 + src_y - dest_y;
+	info.mask_x = pbox[i].x1 + mask_x - dest_x;
+	info.mask_y = pbox[i].y1 + mask_y - dest_y;
+	info.dest_x = pbox[i].x1;
+	info.dest_y = pbox[i].y1;
+	info.width = pbox[i].x2 - pbox[i].x1;
+	info.height = pbox[i].y2 - pbox[i].y1;
+
+	if (stride && info.height > 1 && info.width == dest->bits.width &&
+	    (int64_t)(info.height - 1) * stride + info.width <= INT32_MAX)
+	{
+	    info.width += (info.height - 1) * stride;
+	    info.height = 1;
+	}
 
 	func (imp, &info);
 
-	pbox++;
+	n_pixels += (uint64_t)(pbox[i].x2 - pbox[i].x1) * (pbox[i].y2 - pbox[i].y1);
+    }
+
+    if (unlikely (access))
+	composite_access (&info, pbox, n, src_x - dest_x, src_y - dest_y,
+			  mask_x - dest_x, mask_y - dest_y, TRUE);
+
+    if (unlikely (stats))
+    {
+	_pixman_composite_stats_record (
+	    &info, src_format, mask_format, dest_format, imp, n_pixels,
+	    _pixman_get_time_ns () - start);
     }
 
 out:
     pixman_region32_fini (&region);
+
+    _pixman_image_invalidate_mipmap (dest);
+
+    if (unlikely (trace))
+    {
+	_pixman_trace_composite (
+	    PIXMAN_TRACE_COMPOSITE, op, src,
+	    mask ? mask->common.extended_format_code : PIXMAN_null, dest,
+	    1, n_pixels, imp, start);
+    }
+
+    if (mipmap)
+	pixman_image_unref (mipmap);
 }
 
 PIXMAN_EXPORT void
@@ -724,6 +869,57 @@ pixman_image_composite (pixman_op_t      op,
                               mask_x, mask_y, dest_x, dest_y, width, height);
 }
 
+/* Composite a solid color without the caller having to create and
+ * destroy an image for it.
+ */
+PIXMAN_EXPORT void
+pixman_image_composite_color32 (pixman_op_t           op,
+				const pixman_color_t *color,
+				pixman_image_t *      mask,
+				pixman_image_t *      dest,
+				int32_t               mask_x,
+				int32_t               mask_y,
+				int32_t               dest_x,
+				int32_t               dest_y,
+				int32_t               width,
+				int32_t               height)
+{
+    pixman_image_t solid;
+
+    _pixman_image_init (&solid);
+    _pixman_image_init_solid_fill (&solid, color);
+
+    pixman_image_composite32 (op, &solid, mask, dest, 0, 0,
+			      mask_x, mask_y, dest_x, dest_y, width, height);
+
+    _pixman_image_fini (&solid);
+}
+
+static void
+trace_raw (pixman_trace_call_t      call,
+	   int                      src_bpp,
+	   int                      dest_bpp,
+	   int                      width,
+	   int                      height,
+	   pixman_implementation_t *imp,
+	   uint64_t                 start)
+{
+    pixman_trace_event_t event;
+
+    event.call = call;
+    event.op = PIXMAN_OP_SRC;
+    event.src_format = PIXMAN_null;
+    event.mask_format = PIXMAN_null;
+    event.dest_format = PIXMAN_null;
+    event.src_bpp = src_bpp;
+    event.dest_bpp = dest_bpp;
+    event.n_items = 1;
+    event.n_pixels = (uint64_t)MAX (width, 0) * MAX (height, 0);
+    event.implementation = imp ? imp->name : NULL;
+
+    _pixman_trace_emit (&event, start);
+}
+
 PIXMAN_EXPORT pixman_bool_t
 pixman_blt (uint32_t *src_bits,
             uint32_t *dst_bits,
@@ -738,12 +934,24 @@ pixman_blt (uint32_t *src_bits,
             int       width,
             int       height)
 {
-    return _pixman_implementation_blt (get_implementation(),
-				       src_bits, dst_bits, src_stride, dst_stride,
-                                       src_bpp, dst_bpp,
-                                       src_x, src_y,
-                                       dest_x, dest_y,
-                                       width, height);
+    pixman_implementation_t *imp;
+    uint64_t start = 0;
+    pixman_bool_t trace = _pixman_trace_enabled;
+
+    if (unlikely (trace))
+	start = _pixman_get_time_ns ();
+
+    imp = _pixman_implementation_blt (get_implementation(),
+				      src_bits, dst_bits, src_stride, dst_stride,
+				      src_bpp, dst_bpp,
+				      src_x, src_y,
+				      dest_x, dest_y,
+				      width, height);
+
+    if (unlikely (trace))
+	trace_raw (PIXMAN_TRACE_BLT, src_bpp, dst_bpp, width, height, imp, start);
+
+    return imp != NULL;
 }
 
 PIXMAN_EXPORT pixman_bool_t
@@ -756,8 +964,20 @@ pixman_fill (uint32_t *bits,
              int       height,
              uint32_t  filler)
 {
-    return _pixman_implementation_fill (
+    pixman_implementation_t *imp;
+    uint64_t start = 0;
+    pixman_bool_t trace = _pixman_trace_enabled;
+
+    if (unlikely (trace))
+	start = _pixman_get_time_ns ();
+
+    imp = _pixman_implementation_fill (
 	get_implementation(), bits, stride, bpp, x, y, width, height, filler);
+
+    if (unlikely (trace))
+	trace_raw (PIXMAN_TRACE_FILL, 0, bpp, width, height, imp, start);
+
+    return imp != NULL;
 }
 
 static uint32_t
@@ -834,36 +1054,106 @@ pixman_image_fill_rectangles (pixman_op_t                 op,
                               int                         n_rects,
                               const pixman_rectangle16_t *rects)
 {
-    pixman_box32_t stack_boxes[6];
-    pixman_box32_t *boxes;
-    pixman_bool_t result;
-    int i;
+    pixman_box32_t boxes[64];
+    int i, n;
 
-    if (n_rects > 6)
-    {
-        boxes = pixman_malloc_ab (sizeof (pixman_box32_t), n_rects);
-        if (boxes == NULL)
-            return FALSE;
-    }
-    else
+    /* Each box is filled on its own, so the rectangles can be
+     * converted and filled in batches.
+     */
+    while (n_rects > 0)
     {
-        boxes = stack_boxes;
+	n = MIN (n_rects, (int)(sizeof (boxes) / sizeof (boxes[0])));
+
+	for (i = 0; i < n; ++i)
+	{
+	    boxes[i].x1 = rects[i].x;
+	    boxes[i].y1 = rects[i].y;
+	    boxes[i].x2 = boxes[i].x1 + rects[i].width;
+	    boxes[i].y2 = boxes[i].y1 + rects[i].height;
+	}
+
+	if (!pixman_image_fill_boxes (op, dest, color, n, boxes))
+	    return FALSE;
+
+	rects += n;
+	n_rects -= n;
     }
 
-    for (i = 0; i < n_rects; ++i)
+    return TRUE;
+}
+
+static pixman_bool_t
+box32_intersect (pixman_box32_t       *dest,
+		 const pixman_box32_t *box1,
+		 const pixman_box32_t *box2)
+{
+    dest->x1 = MAX (box1->x1, box2->x1);
+    dest->y1 = MAX (box1->y1, box2->y1);
+    dest->x2 = MIN (box1->x2, box2->x2);
+    dest->y2 = MIN (box1->y2, box2->y2);
+
+    return dest->x2 > dest->x1 && dest->y2 > dest->y1;
+}
+
+/* Fills the parts of @boxes that are inside @region, either with
+ * @pixel, or with the composite function in @info if @func is not
+ * NULL. The boxes are neither sorted nor merged, so when they overlap,
+ * the overlapping parts are composited more than once. Returns FALSE
+ * if no implementation can fill the destination with @pixel, which is
+ * found out before anything is written.
+ */
+static pixman_bool_t
+fill_clipped_boxes (pixman_implementation_t *imp,
+		    pixman_composite_func_t  func,
+		    pixman_composite_info_t *info,
+		    pixman_image_t          *dest,
+		    uint32_t                 pixel,
+		    pixman_region32_t       *region,
+		    int                      n_boxes,
+		    const pixman_box32_t    *boxes,
+		    uint64_t                *n_pixels)
+{
+    int bpp = PIXMAN_FORMAT_BPP (dest->bits.format);
+    const pixman_box32_t *rects, *rects_end, *r;
+    pixman_box32_t box;
+    int i, n;
+
+    rects = pixman_region32_rectangles (region, &n);
+    rects_end = rects + n;
+
+    for (i = 0; i < n_boxes; ++i)
     {
-        boxes[i].x1 = rects[i].x;
-        boxes[i].y1 = rects[i].y;
-        boxes[i].x2 = boxes[i].x1 + rects[i].width;
-        boxes[i].y2 = boxes[i].y1 + rects[i].height;
-    }
+	/* The clip rectangles are sorted in bands from top to bottom */
+	for (r = rects; r < rects_end && r->y2 <= boxes[i].y1; ++r)
+	    ;
 
-    result = pixman_image_fill_boxes (op, dest, color, n_rects, boxes);
+	for (; r < rects_end && r->y1 < boxes[i].y2; ++r)
+	{
+	    if (!box32_intersect (&box, r, &boxes[i]))
+		continue;
 
-    if (boxes != stack_boxes)
-        free (boxes);
-    
-    return result;
+	    if (func)
+	    {
+		info->dest_x = box.x1;
+		info->dest_y = box.y1;
+		info->width = box.x2 - box.x1;
+		info->height = box.y2 - box.y1;
+
+		func (imp, info);
+	    }
+	    else if (!_pixman_implementation_fill (
+			 imp, dest->bits.bits, dest->bits.rowstride, bpp,
+			 box.x1, box.y1, box.x2 - box.x1, box.y2 - box.y1,
+			 pixel))
+	    {
+		return FALSE;
+	    }
+
+	    *n_pixels += (uint64_t)(box.x2 - box.x1) * (box.y2 - box.y1);
+	}
+    }
+
+    return TRUE;
 }
 
 PIXMAN_EXPORT pixman_bool_t
@@ -873,11 +1163,21 @@ pixman_image_fill_boxes (pixman_op_t           op,
                          int                   n_boxes,
                          const pixman_box32_t *boxes)
 {
-    pixman_image_t *solid;
+    pixman_implementation_t *imp = get_implementation ();
+    pixman_composite_func_t func = NULL;
+    pixman_composite_info_t info;
+    pixman_region32_t region;
+    pixman_image_t *solid = NULL;
+    pixman_bool_t access, result = TRUE;
     pixman_color_t c;
+    uint32_t pixel = 0;
+    pixman_bool_t stats = _pixman_composite_stats_enabled;
+    pixman_bool_t trace = _pixman_trace_enabled;
+    uint64_t start = 0, n_pixels = 0;
     int i;
 
     _pixman_image_validate (dest);
+    _pixman_image_invalidate_mipmap (dest);
     
     if (color->alpha == 0xffff)
     {
@@ -897,58 +1197,120 @@ pixman_image_fill_boxes (pixman_op_t           op,
         op = PIXMAN_OP_SRC;
     }
 
-    if (op == PIXMAN_OP_SRC)
+    if (!(op == PIXMAN_OP_SRC && color_to_pixel (color, &pixel, dest->bits.format)))
     {
-        uint32_t pixel;
-
-        if (color_to_pixel (color, &pixel, dest->bits.format))
-        {
-            pixman_region32_t fill_region;
-            int n_rects, j;
-            pixman_box32_t *rects;
-
-            if (!pixman_region32_init_rects (&fill_region, boxes, n_boxes))
-                return FALSE;
-
-            if (dest->common.have_clip_region)
-            {
-                if (!pixman_region32_intersect (&fill_region,
-                                                &fill_region,
-                                                &dest->common.clip_region))
-                    return FALSE;
-            }
-
-            rects = pixman_region32_rectangles (&fill_region, &n_rects);
-            for (j = 0; j < n_rects; ++j)
-            {
-                const pixman_box32_t *rect = &(rects[j]);
-                pixman_fill (dest->bits.bits, dest->bits.rowstride, PIXMAN_FORMAT_BPP (dest->bits.format),
-                             rect->x1, rect->y1, rect->x2 - rect->x1, rect->y2 - rect->y1,
-                             pixel);
-            }
-
-            pixman_region32_fini (&fill_region);
-            return TRUE;
-        }
+	solid = pixman_image_create_solid_fill (color);
+	if (!solid)
+	    return FALSE;
+
+	/* Alpha maps and very large images need the clipping of
+	 * pixman_image_composite32().
+	 */
+	if (dest->common.alpha_map		||
+	    dest->bits.width >= 0x7fff		||
+	    dest->bits.height >= 0x7fff)
+	{
+	    for (i = 0; i < n_boxes; ++i)
+	    {
+		const pixman_box32_t *box = &(boxes[i]);
+
+		pixman_image_composite32 (op, solid, NULL, dest,
+					  0, 0, 0, 0,
+					  box->x1, box->y1,
+					  box->x2 - box->x1, box->y2 - box->y1);
+	    }
+
+	    pixman_image_unref (solid);
+	    return TRUE;
+	}
     }
 
-    solid = pixman_image_create_solid_fill (color);
-    if (!solid)
-        return FALSE;
+    if (unlikely (stats | trace))
+	start = _pixman_get_time_ns ();
 
-    for (i = 0; i < n_boxes; ++i)
+    pixman_region32_init_rect (&region, 0, 0, dest->bits.width, dest->bits.height);
+
+    if (dest->common.have_clip_region &&
+	!pixman_region32_intersect (&region, &region, &dest->common.clip_region))
     {
-        const pixman_box32_t *box = &(boxes[i]);
+	result = FALSE;
+	goto out;
+    }
+
+    access = _pixman_image_has_scanline_access (dest);
 
-        pixman_image_composite32 (op, solid, NULL, dest,
-                                  0, 0, 0, 0,
-                                  box->x1, box->y1,
-                                  box->x2 - box->x1, box->y2 - box->y1);
+    if (unlikely (access))
+    {
+	_pixman_image_access (dest, pixman_region32_rectangles (&region, NULL),
+			      pixman_region32_n_rects (&region), 0, 0,
+			      PIXMAN_ACCESS_READ | PIXMAN_ACCESS_WRITE, FALSE);
     }
 
-    pixman_image_unref (solid);
+    if (!solid && !fill_clipped_boxes (imp, NULL, NULL, dest, pixel,
+				       &region, n_boxes, boxes, &n_pixels))
+    {
+	/* Nothing can fill this depth, so composite instead */
+	solid = pixman_image_create_solid_fill (color);
+	result = solid != NULL;
+    }
 
-    return TRUE;
+    /* The operator, images and flags are the same for every box, so
+     * the composite function is looked up only once.
+     */
+    if (solid)
+    {
+	_pixman_image_validate (solid);
+
+	info.src_image = solid;
+	info.mask_image = NULL;
+	info.dest_image = dest;
+	info.src_flags = solid->common.flags;
+	info.mask_flags = FAST_PATH_IS_OPAQUE | FAST_PATH_NO_ALPHA_MAP;
+	info.dest_flags = dest->common.flags;
+	info.src_x = info.src_y = 0;
+	info.mask_x = info.mask_y = 0;
+	info.op = optimize_operator (op, info.src_flags, info.mask_flags,
+				     info.dest_flags);
+
+	_pixman_implementation_lookup_composite (
+	    get_implementation (), info.op,
+	    PIXMAN_solid, info.src_flags,
+	    PIXMAN_null, info.mask_flags,
+	    dest->common.extended_format_code, info.dest_flags,
+	    &imp, &func);
+
+	fill_clipped_boxes (imp, func, &info, dest, 0,
+			    &region, n_boxes, boxes, &n_pixels);
+    }
+
+    if (unlikely (access))
+    {
+	_pixman_image_access (dest, pixman_region32_rectangles (&region, NULL),
+			      pixman_region32_n_rects (&region), 0, 0,
+			      PIXMAN_ACCESS_READ | PIXMAN_ACCESS_WRITE, TRUE);
+    }
+
+    if (solid && unlikely (stats))
+    {
+	_pixman_composite_stats_record (
+	    &info, PIXMAN_solid, PIXMAN_null, dest->common.extended_format_code,
+	    imp, n_pixels, _pixman_get_time_ns () - start);
+    }
+
+    if (unlikely (trace))
+    {
+	/* Fills have no source, as in pixman_fill() */
+	_pixman_trace_composite (
+	    solid ? PIXMAN_TRACE_COMPOSITE : PIXMAN_TRACE_FILL, op,
+	    solid, PIXMAN_null, dest, n_boxes, n_pixels, imp, start);
+    }
+
+out:
+    pixman_region32_fini (&region);
+    if (solid)
+	pixman_image_unref (solid);
+
+    return result;
 }
 
 /**
@@ -1008,6 +1370,13 @@ pixman_format_supported_source (pixman_format_code_t format)
 {
     switch (format)
     {
+    /* 128 bpp formats */
+    case PIXMAN_rgba_float:
+    /* 96 bpp formats */
+    case PIXMAN_rgb_float:
+    /* 64 bpp formats */
+    case PIXMAN_rgba_half:
+    case PIXMAN_a16b16g16r16:
     /* 32 bpp formats */
     case PIXMAN_a2b10g10r10:
     case PIXMAN_x2b10g10r10:
@@ -189,6 +189,9 @@ pixman_bool_t pixman_transform_point_3d         (const struct pixman_transform *
 						 struct pixman_vector          *vector);
 pixman_bool_t pixman_transform_point            (const struct pixman_transform *transform,
 						 struct pixman_vector          *vector);
+pixman_bool_t pixman_transform_points           (const struct pixman_transform *transform,
+						 struct pixman_vector          *vectors,
+						 int                            n_vectors);
 pixman_bool_t pixman_transform_multiply         (struct pixman_transform       *dst,
 						 const struct pixman_transform *l,
 						 const struct pixman_transform *r);
@@ -441,6 +444,9 @@ void                    pixman_region_init_with_extents  (pixman_region16_t *reg
 							  pixman_box16_t    *extents);
 void                    pixman_region_init_from_image    (pixman_region16_t *region,
 							  pixman_image_t    *image);
+void                    pixman_region_init_from_image_threshold (pixman_region16_t *region,
+								 pixman_image_t    *image,
+								 uint8_t            threshold);
 void                    pixman_region_fini               (pixman_region16_t *region);
 
 
@@ -536,6 +542,9 @@ void                    pixman_region32_init_with_extents  (pixman_region32_t *r
 							    pixman_box32_t    *extents);
 void                    pixman_region32_init_from_image    (pixman_region32_t *region,
 							    pixman_image_t    *image);
+void                    pixman_region32_init_from_image_threshold (pixman_region32_t *region,
+								   pixman_image_t    *image,
+								   uint8_t            threshold);
 void                    pixman_region32_fini               (pixman_region32_t *region);
 
 
@@ -613,6 +622,35 @@ pixman_bool_t pixman_fill               (uint32_t           *bits,
 int           pixman_version            (void);
 const char*   pixman_version_string     (void);
 
+/*
+ * Threads
+ *
+ * pixman can be called from any number of threads at once. Its global
+ * state is either set up once when the library is loaded (the chain of
+ * implementations and the tables they use), kept per thread (the fast
+ * path lookup cache and the pool of free images), or locked internally
+ * (composite statistics).
+ *
+ * An image may be used as the source or mask of composites in several
+ * threads at the same time, including when it is mipmapped, as long as
+ * no thread changes it meanwhile: setting a property, writing to its
+ * bits or using it as a destination requires that no other thread
+ * uses the image. The first composite that uses an image after it was
+ * created or had a property set updates information cached in the
+ * image, so it counts as a change too: use the image in one composite,
+ * or otherwise keep other threads away from it until that composite is
+ * done, before sharing it. Reference counting is atomic, so
+ * pixman_image_ref() and pixman_image_unref() may be called from any
+ * thread.
+ *
+ * A glyph cache may be shared between threads without external
+ * locking, see below. Regions are plain values and need the same care
+ * as any other data shared between threads. pixman_set_trace_function()
+ * and pixman_composite_stats_enable() should be called before other
+ * threads start using pixman; the trace function itself is called from
+ * whichever thread did the work.
+ */
+
 /*
  * Images
  */
@@ -624,6 +662,53 @@ typedef void     (* pixman_write_memory_func_t) (void *dst, uint32_t value, int
 
 typedef void     (* pixman_image_destroy_func_t) (pixman_image_t *image, void *data);
 
+/*
+ * Scanline accessors
+ *
+ * An alternative to pixman_image_set_accessors() for memory that pixman
+ * may access directly, as long as it is told beforehand. Around each
+ * operation, begin_access is called for every row span that may be read
+ * or written, and end_access for the same spans once the operation has
+ * finished. Between the two, pixman uses its normal code paths on the
+ * span. The address and size cover whole bytes; access is a combination
+ * of pixman_access_t.
+ */
+typedef enum
+{
+    PIXMAN_ACCESS_READ		= (1 << 0),
+    PIXMAN_ACCESS_WRITE		= (1 << 1)
+} pixman_access_t;
+
+typedef void     (* pixman_scanline_access_func_t) (pixman_image_t *image,
+						    void           *address,
+						    int             n_bytes,
+						    uint32_t        access,
+						    void           *data);
+
+/*
+ * Flags for pixman_image_create_bits_with_flags()
+ *
+ * PIXMAN_BITS_NO_CLEAR: if pixman allocates the bits, don't zero them.
+ *
+ * PIXMAN_BITS_ALIGN_32, PIXMAN_BITS_ALIGN_64: if pixman allocates the
+ * bits, the buffer and the stride are aligned to that many bytes. For
+ * bits supplied by the caller this is a promise; image creation fails
+ * if the pointer or the stride are not aligned.
+ *
+ * PIXMAN_BITS_WRITABLE_PADDING: the bytes between the end of the
+ * pixels of a row and the start of the next row may be overwritten
+ * by pixman. This lets full width composites treat the image as a
+ * single span. Only images created with this flag get it, even when
+ * pixman allocates the bits.
+ */
+typedef enum
+{
+    PIXMAN_BITS_NO_CLEAR		= (1 << 0),
+    PIXMAN_BITS_ALIGN_32		= (1 << 1),
+    PIXMAN_BITS_ALIGN_64		= (1 << 2),
+    PIXMAN_BITS_WRITABLE_PADDING	= (1 << 3)
+} pixman_bits_flags_t;
+
 struct pixman_gradient_stop {
     pixman_fixed_t x;
     pixman_color_t color;
@@ -654,12 +739,30 @@ struct pixman_indexed
 					 ((g) << 4) |	  \
 					 ((b)))
 
-#define PIXMAN_FORMAT_BPP(f)	(((f) >> 24)       )
-#define PIXMAN_FORMAT_TYPE(f)	(((f) >> 16) & 0xff)
-#define PIXMAN_FORMAT_A(f)	(((f) >> 12) & 0x0f)
-#define PIXMAN_FORMAT_R(f)	(((f) >>  8) & 0x0f)
-#define PIXMAN_FORMAT_G(f)	(((f) >>  4) & 0x0f)
-#define PIXMAN_FORMAT_B(f)	(((f)      ) & 0x0f)
+/*
+ * Channels too wide for PIXMAN_FORMAT() are stored as a number of
+ * bytes, along with the bpp. The two bits below the type say by how
+ * much the sizes are shifted.
+ */
+#define PIXMAN_FORMAT_BYTE(bpp,type,a,r,g,b)				\
+					(((bpp >> 3) << 24) |	\
+					 (3 << 22) |		\
+					 ((type) << 16) |	\
+					 ((a >> 3) << 12) |	\
+					 ((r >> 3) << 8) |	\
+					 ((g >> 3) << 4) |	\
+					 ((b >> 3)))
+
+#define PIXMAN_FORMAT_RESHIFT(val, ofs, num)				\
+	((((val) >> (ofs)) & ((1 << (num)) - 1)) << (((val) >> 22) & 3))
+
+#define PIXMAN_FORMAT_BPP(f)	PIXMAN_FORMAT_RESHIFT(f, 24, 8)
+#define PIXMAN_FORMAT_SHIFT(f)	((uint32_t)(((f) >> 22) & 3))
+#define PIXMAN_FORMAT_TYPE(f)	(((f) >> 16) & 0x3f)
+#define PIXMAN_FORMAT_A(f)	PIXMAN_FORMAT_RESHIFT(f, 12, 4)
+#define PIXMAN_FORMAT_R(f)	PIXMAN_FORMAT_RESHIFT(f, 8, 4)
+#define PIXMAN_FORMAT_G(f)	PIXMAN_FORMAT_RESHIFT(f, 4, 4)
+#define PIXMAN_FORMAT_B(f)	PIXMAN_FORMAT_RESHIFT(f, 0, 4)
 #define PIXMAN_FORMAT_RGB(f)	(((f)      ) & 0xfff)
 #define PIXMAN_FORMAT_VIS(f)	(((f)      ) & 0xffff)
 #define PIXMAN_FORMAT_DEPTH(f)	(PIXMAN_FORMAT_A(f) +	\
@@ -678,15 +781,33 @@ struct pixman_indexed
 #define PIXMAN_TYPE_BGRA	8
 #define PIXMAN_TYPE_RGBA	9
 #define PIXMAN_TYPE_ARGB_SRGB	10
+#define PIXMAN_TYPE_RGBA_FLOAT	11
 
 #define PIXMAN_FORMAT_COLOR(f)				\
 	(PIXMAN_FORMAT_TYPE(f) == PIXMAN_TYPE_ARGB ||	\
 	 PIXMAN_FORMAT_TYPE(f) == PIXMAN_TYPE_ABGR ||	\
 	 PIXMAN_FORMAT_TYPE(f) == PIXMAN_TYPE_BGRA ||	\
-	 PIXMAN_FORMAT_TYPE(f) == PIXMAN_TYPE_RGBA)
+	 PIXMAN_FORMAT_TYPE(f) == PIXMAN_TYPE_RGBA ||	\
+	 PIXMAN_FORMAT_TYPE(f) == PIXMAN_TYPE_RGBA_FLOAT)
 
-/* 32bpp formats */
+/*
+ * The float formats hold premultiplied IEEE single or half precision
+ * channels in r, g, b, a order in memory. SRC stores the source
+ * unchanged, so colors outside [0, 1] survive copies and conversions
+ * between them; the other operators clamp their results to at most 1.
+ */
 typedef enum {
+/* 128bpp formats */
+    PIXMAN_rgba_float =	PIXMAN_FORMAT_BYTE(128,PIXMAN_TYPE_RGBA_FLOAT,32,32,32,32),
+
+/* 96bpp formats */
+    PIXMAN_rgb_float =	PIXMAN_FORMAT_BYTE(96,PIXMAN_TYPE_RGBA_FLOAT,0,32,32,32),
+
+/* 64bpp formats */
+    PIXMAN_rgba_half =	PIXMAN_FORMAT_BYTE(64,PIXMAN_TYPE_RGBA_FLOAT,16,16,16,16),
+    PIXMAN_a16b16g16r16 = PIXMAN_FORMAT_BYTE(64,PIXMAN_TYPE_ABGR,16,16,16,16),
+
+/* 32bpp formats */
     PIXMAN_a8r8g8b8 =	 PIXMAN_FORMAT(32,PIXMAN_TYPE_ARGB,8,8,8,8),
     PIXMAN_x8r8g8b8 =	 PIXMAN_FORMAT(32,PIXMAN_TYPE_ARGB,0,8,8,8),
     PIXMAN_a8b8g8r8 =	 PIXMAN_FORMAT(32,PIXMAN_TYPE_ABGR,8,8,8,8),
@@ -786,6 +907,12 @@ pixman_image_t *pixman_image_create_bits_no_clear    (pixman_format_code_t forma
 						      int                  height,
 						      uint32_t *           bits,
 						      int                  rowstride_bytes);
+pixman_image_t *pixman_image_create_bits_with_flags  (pixman_format_code_t          format,
+						      int                           width,
+						      int                           height,
+						      uint32_t                     *bits,
+						      int                           rowstride_bytes,
+						      uint32_t                      flags);
 
 /* Destructor */
 pixman_image_t *pixman_image_ref                     (pixman_image_t               *image);
@@ -823,6 +950,15 @@ pixman_bool_t   pixman_image_get_component_alpha     (pixman_image_t
 void		pixman_image_set_accessors	     (pixman_image_t		   *image,
 						      pixman_read_memory_func_t	    read_func,
 						      pixman_write_memory_func_t    write_func);
+void		pixman_image_set_scanline_accessors  (pixman_image_t		   *image,
+						      pixman_scanline_access_func_t begin_access,
+						      pixman_scanline_access_func_t end_access,
+						      void			   *data);
+void		pixman_image_set_mipmap		     (pixman_image_t		   *image,
+						      pixman_bool_t		    mipmap);
+void		pixman_image_invalidate_mipmap	     (pixman_image_t		   *image);
+void		pixman_image_set_analytic_coverage   (pixman_image_t		   *image,
+						      pixman_bool_t		    analytic);
 void		pixman_image_set_indexed	     (pixman_image_t		   *image,
 						      const pixman_indexed_t	   *indexed);
 uint32_t       *pixman_image_get_data                (pixman_image_t               *image);
@@ -906,6 +1042,16 @@ void          pixman_image_composite32        (pixman_op_t        op,
 					       int32_t            dest_y,
 					       int32_t            width,
 					       int32_t            height);
+void          pixman_image_composite_color32  (pixman_op_t           op,
+					       const pixman_color_t *color,
+					       pixman_image_t       *mask,
+					       pixman_image_t       *dest,
+					       int32_t               mask_x,
+					       int32_t               mask_y,
+					       int32_t               dest_x,
+					       int32_t               dest_y,
+					       int32_t               width,
+					       int32_t               height);
 
 /* Executive Summary: This function is a no-op that only exists
  * for historical reasons.
@@ -929,6 +1075,12 @@ void pixman_disable_out_of_bounds_workaround (void);
 
 /*
  * Glyphs
+ *
+ * A glyph cache may be used by several threads at once. Glyphs that a
+ * thread has looked up or inserted stay valid until that thread thaws
+ * the cache; glyphs are only ever freed while no thread has the cache
+ * frozen. The cache is split into independently locked shards, so
+ * lookups from different threads rarely wait for each other.
  */
 typedef struct pixman_glyph_cache_t pixman_glyph_cache_t;
 typedef struct
@@ -1106,6 +1258,93 @@ void	      pixman_add_triangles       (pixman_image_t              *image,
 					  int	                       n_tris,
 					  const pixman_triangle_t     *tris);
 
+/*
+ * Composite statistics
+ *
+ * When enabled, either with pixman_composite_stats_enable() or by
+ * setting the PIXMAN_COMPOSITE_STATS environment variable, every call
+ * to pixman_image_composite32() is accounted to the signature it was
+ * looked up with and to the implementation level that ended up
+ * handling it. A "general" implementation means that no fast path
+ * matched. With the environment variable set, the table is also
+ * printed to stderr at exit.
+ *
+ * The formats are the ones used for the fast path lookup, so they may
+ * be internal codes for solid, pixbuf and gradient images, and the
+ * flags are the internal FAST_PATH_* flags.
+ */
+typedef struct
+{
+    pixman_op_t			op;
+    pixman_format_code_t	src_format;
+    uint32_t			src_flags;
+    pixman_format_code_t	mask_format;
+    uint32_t			mask_flags;
+    pixman_format_code_t	dest_format;
+    uint32_t			dest_flags;
+    const char *		implementation;
+    uint64_t			n_calls;
+    uint64_t			n_pixels;
+    uint64_t			time_ns;
+} pixman_composite_stats_t;
+
+void          pixman_composite_stats_enable (pixman_bool_t             enable);
+void          pixman_composite_stats_reset  (void);
+int           pixman_composite_stats_get    (pixman_composite_stats_t *stats,
+					     int                       n_stats);
+
+/*
+ * Tracing
+ *
+ * When a trace function is installed, it is called once for every
+ * call to the entry points below, after the call is done. Glyph and
+ * trapezoid compositing may call pixman_image_composite32()
+ * internally; those nested composites are reported as well, before
+ * the outer event.
+ *
+ * The formats are the ones used for the fast path lookup, so they
+ * may be internal codes for solid, pixbuf and gradient images. Fills
+ * and blits are reported as PIXMAN_OP_SRC with PIXMAN_null formats;
+ * only the bits per pixel are known for them. n_pixels is 0 when the area is not known
+ * without extra work, and implementation is NULL when the work was
+ * delegated to nested composites or nothing was done. n_items is the
+ * number of glyphs or trapezoids, and 1 for the other calls.
+ *
+ * The trace function must not be changed while other threads are
+ * using pixman. Setting the PIXMAN_TRACE environment variable makes
+ * pixman collect the events even without a trace function, for the
+ * benefit of the pixman:call static probe on systems with sys/sdt.h.
+ */
+typedef enum
+{
+    PIXMAN_TRACE_COMPOSITE,
+    PIXMAN_TRACE_FILL,
+    PIXMAN_TRACE_BLT,
+    PIXMAN_TRACE_COMPOSITE_GLYPHS,
+    PIXMAN_TRACE_COMPOSITE_TRAPEZOIDS
+} pixman_trace_call_t;
+
+typedef struct
+{
+    pixman_trace_call_t		call;
+    pixman_op_t			op;
+    pixman_format_code_t	src_format;
+    pixman_format_code_t	mask_format;
+    pixman_format_code_t	dest_format;
+    int				src_bpp;
+    int				dest_bpp;
+    int				n_items;
+    uint64_t			n_pixels;
+    const char *		implementation;
+    uint64_t			time_ns;
+} pixman_trace_event_t;
+
+typedef void (* pixman_trace_func_t) (const pixman_trace_event_t *event,
+				      void                       *data);
+
+void          pixman_set_trace_function (pixman_trace_func_t function,
+					 void               *data);
+
 PIXMAN_END_DECLS
 
 #endif /* PIXMAN_H__ */
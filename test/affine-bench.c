@@ -374,14 +374,30 @@ main (int argc, char *argv[])
         --argc;
     }
 
+    if (*argv && (*argv)[0] == '-' && (*argv)[1] == 'p')
+    {
+        if (argv[1] && argv[2] &&
+            parse_fixed_argument (argv[1], &binfo.transform.matrix[2][0]) &&
+            parse_fixed_argument (argv[2], &binfo.transform.matrix[2][1]))
+        {
+            argv += 3;
+            argc -= 3;
+        }
+        else
+        {
+            argc = 1;
+        }
+    }
+
     if (argc == 1 ||
         !parse_arguments (argc, argv, &binfo.transform, &binfo.op,
                           &src_format, &mask_format, &dest_format))
     {
-        printf ("Usage: affine-bench [-n] [-b] axx [axy] [ayx] [ayy] [combine type]\n");
-        printf ("                    [src format] [mask format] [dest format]\n");
+        printf ("Usage: affine-bench [-n] [-b] [-p awx awy] axx [axy] [ayx] [ayy]\n");
+        printf ("                    [combine type] [src format] [mask format] [dest format]\n");
         printf ("  -n : nearest scaling (default)\n");
         printf ("  -b : bilinear scaling\n");
+        printf ("  -p : projective transform, w_out:x_in and w_out:y_in factors\n");
         printf ("  axx : x_out:x_in factor\n");
         printf ("  axy : x_out:y_in factor (default 0)\n");
         printf ("  ayx : y_out:x_in factor (default 0)\n");
@@ -391,6 +407,8 @@ main (int argc, char *argv[])
         printf ("  mask format : as for src format, but no mask used if omitted\n");
         printf ("  dest format : as for src format (default a8r8g8b8)\n");
         printf ("The output is a single number in megapixels/second.\n");
+        printf ("Rotations and flips: 0 -1 1 0 (90), -1 0 0 -1 (180),\n");
+        printf ("0 1 -1 0 (270), -1 0 0 1 (horizontal), 1 0 0 -1 (vertical).\n");
 
         return EXIT_FAILURE;
     }
@@ -0,0 +1,347 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "utils.h"
+
+/* With analytic coverage enabled, every pixel of an a8 image that
+ * trapezoids are added to must get the exact area of the trapezoid
+ * inside it, which is computed here by clipping the trapezoid against
+ * each pixel square.
+ */
+
+typedef struct
+{
+    double x, y;
+} point_t;
+
+static double
+line_x (const pixman_line_fixed_t *line, double y)
+{
+    double x1 = pixman_fixed_to_double (line->p1.x);
+    double y1 = pixman_fixed_to_double (line->p1.y);
+    double x2 = pixman_fixed_to_double (line->p2.x);
+    double y2 = pixman_fixed_to_double (line->p2.y);
+
+    return x1 + (y - y1) * (x2 - x1) / (y2 - y1);
+}
+
+/* Clip @in against the half plane where @sign * (coordinate @axis - @v)
+ * is at most zero.
+ */
+static int
+clip_polygon (const point_t *in, int n, point_t *out,
+	      int axis, double v, double sign)
+{
+    int i, n_out = 0;
+
+    for (i = 0; i < n; ++i)
+    {
+	const point_t *a = &in[i];
+	const point_t *b = &in[(i + 1) % n];
+	double da = sign * ((axis ? a->y : a->x) - v);
+	double db = sign * ((axis ? b->y : b->x) - v);
+
+	if (da <= 0)
+	    out[n_out++] = *a;
+
+	if ((da < 0 && db > 0) || (da > 0 && db < 0))
+	{
+	    double t = da / (da - db);
+
+	    out[n_out].x = a->x + t * (b->x - a->x);
+	    out[n_out].y = a->y + t * (b->y - a->y);
+	    n_out++;
+	}
+    }
+
+    return n_out;
+}
+
+static double
+polygon_area (const point_t *p, int n)
+{
+    double area = 0;
+    int i;
+
+    for (i = 0; i < n; ++i)
+    {
+	const point_t *a = &p[i];
+	const point_t *b = &p[(i + 1) % n];
+
+	area += a->x * b->y - b->x * a->y;
+    }
+
+    return area < 0 ? -area / 2 : area / 2;
+}
+
+/* Area of the part of the trapezoid between @y0 and @y1 inside pixel
+ * (@x, @y), with the left edge left of the right edge throughout.
+ */
+static double
+pixel_area (const pixman_line_fixed_t *left, const pixman_line_fixed_t *right,
+	    double y0, double y1, int x, int y)
+{
+    point_t a[16], b[16];
+    int n;
+
+    a[0].x = line_x (left, y0);
+    a[0].y = y0;
+    a[1].x = line_x (right, y0);
+    a[1].y = y0;
+    a[2].x = line_x (right, y1);
+    a[2].y = y1;
+    a[3].x = line_x (left, y1);
+    a[3].y = y1;
+
+    n = clip_polygon (a, 4, b, 0, x, -1);
+    n = clip_polygon (b, n, a, 0, x + 1, 1);
+    n = clip_polygon (a, n, b, 1, y, -1);
+    n = clip_polygon (b, n, a, 1, y + 1, 1);
+
+    return n < 3 ? 0 : polygon_area (a, n);
+}
+
+/* Add the expected coverage of one trapezoid to @ref */
+static void
+reference_trapezoid (uint8_t *ref, int width, int height,
+		     double top, double bottom,
+		     const pixman_line_fixed_t *left,
+		     const pixman_line_fixed_t *right)
+{
+    double y_split[3];
+    int n_split = 0;
+    double d0, d1;
+    int x, y, i;
+
+    /* Split where the edges cross, only the parts with the left edge
+     * on the left count.
+     */
+    d0 = line_x (right, top) - line_x (left, top);
+    d1 = line_x (right, bottom) - line_x (left, bottom);
+
+    y_split[n_split++] = top;
+    if ((d0 < 0 && d1 > 0) || (d0 > 0 && d1 < 0))
+	y_split[n_split++] = top + (bottom - top) * d0 / (d0 - d1);
+    y_split[n_split++] = bottom;
+
+    for (y = 0; y < height; ++y)
+    {
+	for (x = 0; x < width; ++x)
+	{
+	    double area = 0;
+	    int a;
+
+	    for (i = 0; i + 1 < n_split; ++i)
+	    {
+		double ym = (y_split[i] + y_split[i + 1]) / 2;
+
+		if (line_x (right, ym) > line_x (left, ym))
+		{
+		    area += pixel_area (left, right,
+					y_split[i], y_split[i + 1], x, y);
+		}
+	    }
+
+	    a = ref[y * width + x] + (int) (area * 255 + 0.5);
+	    ref[y * width + x] = MIN (a, 255);
+	}
+    }
+}
+
+static void
+random_line (pixman_line_fixed_t *line, int width, int height)
+{
+    line->p1.x = prng_rand_n ((width + 16) << 16) - (8 << 16);
+    line->p1.y = prng_rand_n ((height + 16) << 16) - (8 << 16);
+    line->p2.x = prng_rand_n ((width + 16) << 16) - (8 << 16);
+
+    /* Mostly steep, sometimes close to horizontal */
+    if (prng_rand_n (8))
+	line->p2.y = line->p1.y + prng_rand_n (height << 16) + 1;
+    else
+	line->p2.y = line->p1.y + prng_rand_n (0x400) + 1;
+}
+
+static void
+random_trapezoid (pixman_trapezoid_t *trap, int width, int height)
+{
+    random_line (&trap->left, width, height);
+
+    if (prng_rand_n (2))
+    {
+	random_line (&trap->right, width, height);
+    }
+    else
+    {
+	/* A thin sliver along the left edge */
+	pixman_fixed_t w = prng_rand_n (0x18000);
+
+	trap->right = trap->left;
+	trap->right.p1.x += w;
+	trap->right.p2.x += w;
+    }
+
+    trap->top = prng_rand_n ((height + 16) << 16) - (8 << 16);
+    trap->bottom = trap->top + prng_rand_n ((height + 8) << 16) + 1;
+}
+
+static uint32_t
+read_8 (const void *src, int size)
+{
+    return *(const uint8_t *)src;
+}
+
+static void
+write_8 (void *dst, uint32_t value, int size)
+{
+    *(uint8_t *)dst = value;
+}
+
+static int
+test_traps (int testnum)
+{
+    pixman_trapezoid_t traps[4];
+    pixman_trap_t trap;
+    pixman_image_t *image;
+    uint8_t *ref;
+    uint8_t *bits;
+    int width, height, stride;
+    int n_traps, i, x, y;
+    int errors = 0;
+
+    prng_srand (testnum);
+
+    width = prng_rand_n (48) + 1;
+    height = prng_rand_n (48) + 1;
+    n_traps = prng_rand_n (ARRAY_LENGTH (traps)) + 1;
+
+    image = fence_image_create_bits (PIXMAN_a8, width, height, TRUE);
+    pixman_image_set_analytic_coverage (image, TRUE);
+    if (testnum % 4 == 0)
+	pixman_image_set_accessors (image, read_8, write_8);
+
+    bits = (uint8_t *)pixman_image_get_data (image);
+    stride = pixman_image_get_stride (image);
+    for (y = 0; y < height; ++y)
+	memset (bits + y * stride, 0, width);
+
+    ref = calloc (width * height, 1);
+
+    for (i = 0; i < n_traps; ++i)
+	random_trapezoid (&traps[i], width, height);
+
+    if (prng_rand_n (4))
+    {
+	for (i = 0; i < n_traps; ++i)
+	{
+	    reference_trapezoid (ref, width, height,
+				 pixman_fixed_to_double (traps[i].top),
+				 pixman_fixed_to_double (traps[i].bottom),
+				 &traps[i].left, &traps[i].right);
+	}
+
+	pixman_add_trapezoids (image, 0, 0, n_traps, traps);
+    }
+    else
+    {
+	/* The same through pixman_add_traps () */
+	n_traps = 1;
+
+	trap.top.y = traps[0].top;
+	trap.top.l = traps[0].left.p1.x;
+	trap.top.r = traps[0].right.p1.x;
+	trap.bot.y = traps[0].bottom;
+	trap.bot.l = traps[0].left.p2.x;
+	trap.bot.r = traps[0].right.p2.x;
+
+	traps[0].left.p1.y = traps[0].right.p1.y = trap.top.y;
+	traps[0].left.p2.y = traps[0].right.p2.y = trap.bot.y;
+
+	reference_trapezoid (ref, width, height,
+			     pixman_fixed_to_double (trap.top.y),
+			     pixman_fixed_to_double (trap.bot.y),
+			     &traps[0].left, &traps[0].right);
+
+	pixman_add_traps (image, 0, 0, 1, &trap);
+    }
+
+    /* Each trapezoid may round differently */
+    for (y = 0; y < height; ++y)
+    {
+	for (x = 0; x < width; ++x)
+	{
+	    int d = bits[y * stride + x] - ref[y * width + x];
+
+	    if (d < -n_traps || d > n_traps)
+	    {
+		if (!errors)
+		{
+		    printf ("test %d failed at %d, %d: %d instead of %d\n",
+			    testnum, x, y, bits[y * stride + x],
+			    ref[y * width + x]);
+		}
+		errors++;
+	    }
+	}
+    }
+
+    free (ref);
+    pixman_image_unref (image);
+
+    return errors != 0;
+}
+
+/* Trapezoids composited through a temporary mask are rasterized with
+ * the destination's setting.
+ */
+static int
+test_composite (int testnum)
+{
+    pixman_color_t white = { 0xffff, 0xffff, 0xffff, 0xffff };
+    pixman_trapezoid_t traps[4];
+    pixman_image_t *src, *dest, *ref;
+    int i, n_traps, result;
+
+    prng_srand (testnum);
+
+    n_traps = prng_rand_n (ARRAY_LENGTH (traps)) + 1;
+    for (i = 0; i < n_traps; ++i)
+	random_trapezoid (&traps[i], 32, 32);
+
+    src = pixman_image_create_solid_fill (&white);
+    dest = pixman_image_create_bits (PIXMAN_a8, 32, 32, NULL, 0);
+    ref = pixman_image_create_bits (PIXMAN_a8, 32, 32, NULL, 0);
+
+    pixman_image_set_analytic_coverage (dest, TRUE);
+    pixman_image_set_analytic_coverage (ref, TRUE);
+
+    pixman_composite_trapezoids (PIXMAN_OP_SRC, src, dest, PIXMAN_a8,
+				 0, 0, 0, 0, n_traps, traps);
+    pixman_add_trapezoids (ref, 0, 0, n_traps, traps);
+
+    result = memcmp (pixman_image_get_data (dest), pixman_image_get_data (ref),
+		     pixman_image_get_stride (ref) * 32) != 0;
+
+    if (result)
+	printf ("composite test %d failed\n", testnum);
+
+    pixman_image_unref (src);
+    pixman_image_unref (dest);
+    pixman_image_unref (ref);
+
+    return result;
+}
+
+int
+main (int argc, const char *argv[])
+{
+    int i, n_failed = 0;
+
+    for (i = 0; i < 2000; ++i)
+	n_failed += test_traps (i);
+
+    for (i = 0; i < 200; ++i)
+	n_failed += test_composite (i);
+
+    return n_failed != 0;
+}
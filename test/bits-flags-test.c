@@ -0,0 +1,239 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "utils.h"
+
+/* Full width composites into images whose padding may be overwritten
+ * are done as a single span. Check that they give the same result as
+ * compositing one row at a time, and that the padding of images that
+ * don't allow it is left alone.
+ */
+
+static const pixman_op_t ops[] =
+{
+    PIXMAN_OP_SRC, PIXMAN_OP_OVER, PIXMAN_OP_ADD, PIXMAN_OP_IN
+};
+
+static const pixman_format_code_t formats[] =
+{
+    PIXMAN_a8r8g8b8, PIXMAN_x8r8g8b8, PIXMAN_r5g6b5, PIXMAN_a8
+};
+
+static pixman_image_t *
+make_image (pixman_format_code_t format, int width, int height,
+	    int stride, uint32_t flags, uint32_t **bits)
+{
+    *bits = malloc (stride * height);
+    prng_randmemset (*bits, stride * height, 0);
+
+    return pixman_image_create_bits_with_flags (
+	format, width, height, *bits, stride, flags);
+}
+
+static int
+test_composite (int testnum)
+{
+    pixman_format_code_t format;
+    pixman_image_t *src, *mask, *dst, *ref;
+    uint32_t *src_bits, *mask_bits, *dst_bits, *ref_bits, *pad_bits;
+    int width, height, stride, bpp, y;
+    pixman_op_t op;
+    int result = 0;
+
+    prng_srand (testnum);
+
+    format = formats[prng_rand_n (ARRAY_LENGTH (formats))];
+    op = ops[prng_rand_n (ARRAY_LENGTH (ops))];
+    bpp = PIXMAN_FORMAT_BPP (format);
+
+    width = prng_rand_n (40) + 1;
+    height = prng_rand_n (8) + 1;
+    stride = ((width * bpp / 8 + 3) & ~3) + prng_rand_n (3) * 4;
+
+    src = make_image (format, width, height, stride, 0, &src_bits);
+    mask = NULL;
+    mask_bits = NULL;
+    if (prng_rand_n (2))
+	mask = make_image (format, width, height, stride, 0, &mask_bits);
+
+    dst = make_image (format, width, height, stride,
+		      PIXMAN_BITS_WRITABLE_PADDING, &dst_bits);
+    ref_bits = malloc (stride * height);
+    memcpy (ref_bits, dst_bits, stride * height);
+    ref = pixman_image_create_bits (format, width, height, ref_bits, stride);
+
+    pad_bits = malloc (stride * height);
+    memcpy (pad_bits, dst_bits, stride * height);
+
+    pixman_image_composite32 (op, src, mask, dst, 0, 0, 0, 0, 0, 0,
+			      width, height);
+    for (y = 0; y < height; ++y)
+    {
+	pixman_image_composite32 (op, src, mask, ref, 0, y, 0, y, 0, y,
+				  width, 1);
+    }
+
+    for (y = 0; y < height; ++y)
+    {
+	int n_bytes = width * bpp / 8;
+
+	if (memcmp ((uint8_t *)dst_bits + y * stride,
+		    (uint8_t *)ref_bits + y * stride, n_bytes) != 0)
+	{
+	    printf ("test %d: row %d differs\n", testnum, y);
+	    result = 1;
+	}
+    }
+
+    /* Without the flag, the padding must survive a full width composite */
+    pixman_image_unref (ref);
+    memcpy (ref_bits, pad_bits, stride * height);
+    ref = pixman_image_create_bits (format, width, height, ref_bits, stride);
+
+    pixman_image_composite32 (op, src, mask, ref, 0, 0, 0, 0, 0, 0,
+			      width, height);
+
+    for (y = 0; y < height; ++y)
+    {
+	int n_bytes = width * bpp / 8;
+
+	if (memcmp ((uint8_t *)ref_bits + y * stride + n_bytes,
+		    (uint8_t *)pad_bits + y * stride + n_bytes,
+		    stride - n_bytes) != 0)
+	{
+	    printf ("test %d: padding of row %d overwritten\n", testnum, y);
+	    result = 1;
+	}
+    }
+
+    pixman_image_unref (src);
+    pixman_image_unref (dst);
+    pixman_image_unref (ref);
+    if (mask)
+	pixman_image_unref (mask);
+
+    free (src_bits);
+    free (mask_bits);
+    free (dst_bits);
+    free (ref_bits);
+    free (pad_bits);
+
+    return result;
+}
+
+static int
+test_alignment (void)
+{
+    static const uint32_t aligns[] = { PIXMAN_BITS_ALIGN_32, PIXMAN_BITS_ALIGN_64 };
+    pixman_image_t *image;
+    uint32_t *bits;
+    int i;
+
+    for (i = 0; i < ARRAY_LENGTH (aligns); ++i)
+    {
+	int align = aligns[i] == PIXMAN_BITS_ALIGN_32 ? 32 : 64;
+
+	image = pixman_image_create_bits_with_flags (
+	    PIXMAN_r5g6b5, 7, 3, NULL, 0, aligns[i] | PIXMAN_BITS_NO_CLEAR);
+
+	if (!image ||
+	    ((uintptr_t)pixman_image_get_data (image) & (align - 1)) != 0 ||
+	    pixman_image_get_stride (image) != align)
+	{
+	    printf ("allocation not aligned to %d bytes\n", align);
+	    return 1;
+	}
+
+	pixman_image_unref (image);
+    }
+
+    /* A stride that breaks the promise is refused */
+    bits = aligned_malloc (64, 64 * 4);
+    image = pixman_image_create_bits_with_flags (
+	PIXMAN_a8r8g8b8, 4, 4, bits, 48, PIXMAN_BITS_ALIGN_64);
+    free (bits);
+
+    if (image)
+    {
+	printf ("misaligned stride accepted\n");
+	return 1;
+    }
+
+    return 0;
+}
+
+static int
+test_allocated_padding (int testnum)
+{
+    static const uint32_t flags[] =
+    {
+	0, PIXMAN_BITS_NO_CLEAR, PIXMAN_BITS_ALIGN_32, PIXMAN_BITS_ALIGN_64
+    };
+    pixman_format_code_t format;
+    pixman_image_t *src, *dst;
+    uint32_t *src_bits;
+    uint8_t *dst_bits, *pad_bits;
+    int width, height, stride, n_bytes, y;
+    pixman_op_t op;
+    int result = 0;
+
+    prng_srand (testnum);
+
+    format = formats[prng_rand_n (ARRAY_LENGTH (formats))];
+    op = ops[prng_rand_n (ARRAY_LENGTH (ops))];
+
+    /* Odd widths so that pixman pads the rows it allocates */
+    width = prng_rand_n (20) * 2 + 1;
+    height = prng_rand_n (8) + 2;
+    n_bytes = width * PIXMAN_FORMAT_BPP (format) / 8;
+
+    dst = pixman_image_create_bits_with_flags (
+	format, width, height, NULL, 0,
+	flags[prng_rand_n (ARRAY_LENGTH (flags))]);
+    stride = pixman_image_get_stride (dst);
+    dst_bits = (uint8_t *)pixman_image_get_data (dst);
+
+    prng_randmemset (dst_bits, stride * height, 0);
+    pad_bits = malloc (stride * height);
+    memcpy (pad_bits, dst_bits, stride * height);
+
+    src = make_image (format, width, height, stride, 0, &src_bits);
+
+    pixman_image_composite32 (op, src, NULL, dst, 0, 0, 0, 0, 0, 0,
+			      width, height);
+
+    for (y = 0; y < height; ++y)
+    {
+	if (memcmp (dst_bits + y * stride + n_bytes,
+		    pad_bits + y * stride + n_bytes, stride - n_bytes) != 0)
+	{
+	    printf ("test %d: padding of allocated row %d overwritten\n",
+		    testnum, y);
+	    result = 1;
+	}
+    }
+
+    pixman_image_unref (src);
+    pixman_image_unref (dst);
+    free (src_bits);
+    free (pad_bits);
+
+    return result;
+}
+
+int
+main (int argc, const char *argv[])
+{
+    int result = 0;
+    int i;
+
+    for (i = 1; i <= 2000; ++i)
+	result |= test_composite (i);
+
+    for (i = 1; i <= 500; ++i)
+	result |= test_allocated_padding (i);
+
+    result |= test_alignment ();
+
+    return result;
+}
@@ -110,6 +110,119 @@ lookup_combiner (pixman_implementation_t *imp, pixman_op_t op,
     return f;
 }
 
+static pixman_combine_32_func_t
+lookup_combiner_32 (pixman_implementation_t *imp, pixman_op_t op,
+		    pixman_bool_t component_alpha)
+{
+    pixman_combine_32_func_t f;
+
+    do
+    {
+	if (component_alpha)
+	    f = imp->combine_32_ca[op];
+	else
+	    f = imp->combine_32[op];
+
+	imp = imp->fallback;
+    }
+    while (!f);
+
+    return f;
+}
+
+/* Premultiplied floats, often exactly 0 or 1 */
+static void
+random_colors (argb_t *argb, int width)
+{
+    int i;
+
+    for (i = 0; i < width; ++i)
+    {
+	argb_t *p = argb + i;
+
+	switch (prng_rand_n (4))
+	{
+	case 0: p->a = 0.0f; break;
+	case 1: p->a = 1.0f; break;
+	default: p->a = prng_rand_n (0x10000) / 65535.f; break;
+	}
+
+	p->r = p->a * (prng_rand_n (0x10000) / 65535.f);
+	p->g = p->a * (prng_rand_n (0x10000) / 65535.f);
+	p->b = p->a * (prng_rand_n (0x10000) / 65535.f);
+    }
+}
+
+/* The combiners of the SIMD implementations must give exactly the same
+ * results as the ones in C, with and without a mask.
+ */
+static int
+compare_combiners (pixman_implementation_t *impl, pixman_op_t op, int ca)
+{
+    pixman_implementation_t *general = impl;
+    uint32_t src[WIDTH], mask[WIDTH], dest[WIDTH], ref[WIDTH];
+    argb_t *srcf = malloc (WIDTH * sizeof (argb_t));
+    argb_t *maskf = malloc (WIDTH * sizeof (argb_t));
+    argb_t *destf = malloc (WIDTH * sizeof (argb_t));
+    argb_t *reff = malloc (WIDTH * sizeof (argb_t));
+    int i, width, result = 0;
+
+    while (general->fallback)
+	general = general->fallback;
+
+    for (i = 0; i < 10; ++i)
+    {
+	const uint32_t *m = (i & 1) ? mask : NULL;
+	const float *mf = (i & 1) ? (float *)maskf : NULL;
+
+	if (ca && !m)
+	    continue;
+
+	/* Odd widths and offsets exercise the unaligned edges */
+	width = WIDTH - prng_rand_n (8);
+
+	prng_randmemset (src, sizeof (src), 0);
+	prng_randmemset (mask, sizeof (mask), 0);
+	prng_randmemset (dest, sizeof (dest), 0);
+	memcpy (ref, dest, sizeof (dest));
+
+	/* Operators that divide only exist as float combiners */
+	if (ca ? general->combine_32_ca[op] : general->combine_32[op])
+	{
+	    lookup_combiner_32 (impl, op, ca) (
+		impl, op, dest + 1, src, m, width - 1);
+	    lookup_combiner_32 (general, op, ca) (
+		general, op, ref + 1, src, m, width - 1);
+	}
+
+	random_colors (srcf, WIDTH);
+	random_colors (maskf, WIDTH);
+	random_colors (destf, WIDTH);
+	memcpy (reff, destf, WIDTH * sizeof (argb_t));
+
+	lookup_combiner (impl, op, ca) (impl, op, (float *)destf,
+					(float *)srcf, mf, width);
+	lookup_combiner (general, op, ca) (general, op, (float *)reff,
+					   (float *)srcf, mf, width);
+
+	if (memcmp (dest, ref, sizeof (dest)) != 0 ||
+	    memcmp (destf, reff, WIDTH * sizeof (argb_t)) != 0)
+	{
+	    printf ("%s%s combiners differ from C\n",
+		    operator_name (op), ca ? " (component alpha)" : "");
+	    result = 1;
+	    break;
+	}
+    }
+
+    free (srcf);
+    free (maskf);
+    free (destf);
+    free (reff);
+
+    return result;
+}
+
 int
 main ()
 {
@@ -117,7 +230,7 @@ main ()
     argb_t *src_bytes = malloc (WIDTH * sizeof (argb_t));
     argb_t *mask_bytes = malloc (WIDTH * sizeof (argb_t));
     argb_t *dest_bytes = malloc (WIDTH * sizeof (argb_t));
-    int i;
+    int i, n_failed = 0;
 
     enable_divbyzero_exceptions();
     
@@ -144,8 +257,10 @@ main ()
 		      (float *)mask_bytes,
 		      (float *)src_bytes,
 		      WIDTH);
+
+	    n_failed += compare_combiners (impl, op, ca);
 	}
     }	
 
-    return 0;
+    return n_failed != 0;
 }
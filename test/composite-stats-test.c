@@ -0,0 +1,95 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "utils.h"
+
+#define WIDTH	13
+#define HEIGHT	7
+
+static void
+composite (pixman_op_t op, pixman_image_t *src, pixman_image_t *dst, int n)
+{
+    while (n--)
+    {
+	pixman_image_composite32 (op, src, NULL, dst,
+				  0, 0, 0, 0, 0, 0, WIDTH, HEIGHT);
+    }
+}
+
+static const pixman_composite_stats_t *
+find_op (const pixman_composite_stats_t *stats, int n, pixman_op_t op)
+{
+    int i;
+
+    for (i = 0; i < n; ++i)
+    {
+	if (stats[i].op == op)
+	    return &stats[i];
+    }
+
+    return NULL;
+}
+
+int
+main ()
+{
+    pixman_composite_stats_t stats[4];
+    const pixman_composite_stats_t *s;
+    pixman_image_t *src, *dst;
+    int n, result = 1;
+
+    src = pixman_image_create_bits (PIXMAN_a8r8g8b8, WIDTH, HEIGHT, NULL, 0);
+    dst = pixman_image_create_bits (PIXMAN_a8r8g8b8, WIDTH, HEIGHT, NULL, 0);
+
+    pixman_composite_stats_enable (TRUE);
+    pixman_composite_stats_reset ();
+
+    composite (PIXMAN_OP_ADD, src, dst, 2);
+    /* No implementation has a fast path for the HSL operators */
+    composite (PIXMAN_OP_HSL_HUE, src, dst, 3);
+
+    pixman_composite_stats_enable (FALSE);
+
+    composite (PIXMAN_OP_HSL_HUE, src, dst, 1);
+
+    n = pixman_composite_stats_get (stats, ARRAY_LENGTH (stats));
+    if (n != 2)
+    {
+	printf ("expected 2 signatures, got %d\n", n);
+	goto out;
+    }
+
+    s = find_op (stats, n, PIXMAN_OP_ADD);
+    if (!s || s->n_calls != 2 || s->n_pixels != 2 * WIDTH * HEIGHT ||
+	!s->implementation)
+    {
+	printf ("wrong statistics for PIXMAN_OP_ADD\n");
+	goto out;
+    }
+
+    s = find_op (stats, n, PIXMAN_OP_HSL_HUE);
+    if (!s || s->n_calls != 3 || s->n_pixels != 3 * WIDTH * HEIGHT ||
+	strcmp (s->implementation, "general") != 0			||
+	s->src_format != PIXMAN_a8r8g8b8 || s->mask_format != PIXMAN_null ||
+	s->dest_format != PIXMAN_a8r8g8b8)
+    {
+	printf ("wrong statistics for PIXMAN_OP_HSL_HUE\n");
+	goto out;
+    }
+
+    pixman_composite_stats_reset ();
+
+    if (pixman_composite_stats_get (NULL, 0) != 0)
+    {
+	printf ("statistics not reset\n");
+	goto out;
+    }
+
+    result = 0;
+
+out:
+    pixman_image_unref (src);
+    pixman_image_unref (dst);
+
+    return result;
+}
@@ -0,0 +1,154 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "utils.h"
+
+/* pixman_image_fill_boxes() and pixman_image_fill_rectangles() must
+ * give the same results as compositing a solid image into every box
+ * in turn, whatever the clip, and also when the boxes overlap or lie
+ * partly outside the image.
+ */
+
+#define WIDTH 61
+#define HEIGHT 43
+
+static const pixman_op_t ops[] =
+{
+    PIXMAN_OP_CLEAR, PIXMAN_OP_SRC, PIXMAN_OP_OVER, PIXMAN_OP_ADD,
+    PIXMAN_OP_IN, PIXMAN_OP_OUT_REVERSE, PIXMAN_OP_ATOP, PIXMAN_OP_SCREEN
+};
+
+static const pixman_format_code_t formats[] =
+{
+    PIXMAN_a8r8g8b8, PIXMAN_x8r8g8b8, PIXMAN_a8b8g8r8, PIXMAN_r5g6b5,
+    PIXMAN_a8, PIXMAN_a1, PIXMAN_a4r4g4b4, PIXMAN_r8g8b8
+};
+
+static void
+random_box (pixman_box32_t *box, int slack)
+{
+    box->x1 = prng_rand_n (WIDTH + 2 * slack) - slack;
+    box->y1 = prng_rand_n (HEIGHT + 2 * slack) - slack;
+    box->x2 = box->x1 + prng_rand_n (WIDTH / 2) - 1;
+    box->y2 = box->y1 + prng_rand_n (HEIGHT / 2) - 1;
+}
+
+static void
+set_random_clip (pixman_image_t *image, pixman_image_t *copy)
+{
+    pixman_region32_t clip, rect;
+    pixman_box32_t box;
+    int i, n;
+
+    n = prng_rand_n (4);
+    if (n == 0)
+	return;
+
+    pixman_region32_init (&clip);
+    for (i = 0; i < n; ++i)
+    {
+	random_box (&box, 0);
+	if (box.x2 <= box.x1 || box.y2 <= box.y1)
+	    continue;
+
+	pixman_region32_init_rect (&rect, box.x1, box.y1,
+				   box.x2 - box.x1, box.y2 - box.y1);
+	pixman_region32_union (&clip, &clip, &rect);
+	pixman_region32_fini (&rect);
+    }
+
+    pixman_image_set_clip_region32 (image, &clip);
+    pixman_image_set_clip_region32 (copy, &clip);
+    pixman_region32_fini (&clip);
+}
+
+static int
+test_fill (int testnum)
+{
+    pixman_format_code_t format;
+    pixman_image_t *dest, *ref, *solid;
+    pixman_rectangle16_t rects[150];
+    pixman_box32_t boxes[150];
+    pixman_color_t color;
+    pixman_op_t op;
+    int i, n_boxes, stride;
+    int result;
+
+    prng_srand (testnum);
+
+    format = formats[prng_rand_n (ARRAY_LENGTH (formats))];
+    op = ops[prng_rand_n (ARRAY_LENGTH (ops))];
+
+    color.red = prng_rand_n (0x10000);
+    color.green = prng_rand_n (0x10000);
+    color.blue = prng_rand_n (0x10000);
+    switch (prng_rand_n (3))
+    {
+    case 0: color.alpha = 0xffff; break;
+    case 1: color.alpha = 0; break;
+    default: color.alpha = prng_rand_n (0x10000); break;
+    }
+
+    dest = pixman_image_create_bits (format, WIDTH, HEIGHT, NULL, 0);
+    ref = pixman_image_create_bits (format, WIDTH, HEIGHT, NULL, 0);
+    stride = pixman_image_get_stride (dest);
+
+    prng_randmemset (pixman_image_get_data (dest), stride * HEIGHT, 0);
+    memcpy (pixman_image_get_data (ref), pixman_image_get_data (dest),
+	    stride * HEIGHT);
+
+    set_random_clip (dest, ref);
+
+    n_boxes = prng_rand_n (ARRAY_LENGTH (boxes) + 1);
+    for (i = 0; i < n_boxes; ++i)
+    {
+	random_box (&boxes[i], 8);
+
+	rects[i].x = boxes[i].x1;
+	rects[i].y = boxes[i].y1;
+	rects[i].width = MAX (boxes[i].x2 - boxes[i].x1, 0);
+	rects[i].height = MAX (boxes[i].y2 - boxes[i].y1, 0);
+	boxes[i].x2 = boxes[i].x1 + rects[i].width;
+	boxes[i].y2 = boxes[i].y1 + rects[i].height;
+    }
+
+    if (prng_rand_n (2))
+	pixman_image_fill_boxes (op, dest, &color, n_boxes, boxes);
+    else
+	pixman_image_fill_rectangles (op, dest, &color, n_boxes, rects);
+
+    solid = pixman_image_create_solid_fill (&color);
+    for (i = 0; i < n_boxes; ++i)
+    {
+	pixman_image_composite32 (op, solid, NULL, ref, 0, 0, 0, 0,
+				  boxes[i].x1, boxes[i].y1,
+				  boxes[i].x2 - boxes[i].x1,
+				  boxes[i].y2 - boxes[i].y1);
+    }
+    pixman_image_unref (solid);
+
+    result = memcmp (pixman_image_get_data (dest), pixman_image_get_data (ref),
+		     stride * HEIGHT) != 0;
+
+    if (result)
+    {
+	printf ("test %d failed: %s %s, %d boxes\n", testnum,
+		operator_name (op), format_name (format), n_boxes);
+    }
+
+    pixman_image_unref (dest);
+    pixman_image_unref (ref);
+
+    return result;
+}
+
+int
+main (int argc, const char *argv[])
+{
+    int i, n_failed = 0;
+
+    for (i = 0; i < 3000; ++i)
+	n_failed += test_fill (i);
+
+    return n_failed != 0;
+}
@@ -0,0 +1,68 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "utils.h"
+
+/* Times conversions between rgba_float and rgba_half, and composites
+ * of those formats through the general implementation. Run it with
+ * PIXMAN_DISABLE=sse2 to compare against plain C.
+ */
+
+#define WIDTH 1024
+#define HEIGHT 256
+#define N_ITERATIONS 20
+
+static void
+bench_op (const char *name, pixman_op_t op, pixman_bool_t use_mask,
+	  pixman_format_code_t src_format, pixman_format_code_t dest_format)
+{
+    pixman_image_t *src, *dest, *mask;
+    double t;
+    int i;
+
+    src = pixman_image_create_bits (src_format, WIDTH, HEIGHT, NULL, 0);
+    dest = pixman_image_create_bits (dest_format, WIDTH, HEIGHT, NULL, 0);
+    mask = NULL;
+    if (use_mask)
+    {
+	mask = pixman_image_create_bits (PIXMAN_a8, WIDTH, HEIGHT, NULL, 0);
+	memset (pixman_image_get_data (mask), 0xff,
+		pixman_image_get_stride (mask) * HEIGHT);
+    }
+
+    prng_srand (0);
+    image_fill_random (src);
+    image_fill_random (dest);
+
+    t = gettime ();
+    for (i = 0; i < N_ITERATIONS; ++i)
+	pixman_image_composite32 (op, src, mask, dest, 0, 0, 0, 0, 0, 0, WIDTH, HEIGHT);
+    t = gettime () - t;
+
+    printf ("%-28s : %8.1f Mpix/s\n", name,
+	    N_ITERATIONS * (double)WIDTH * HEIGHT / t / 1e6);
+
+    pixman_image_unref (src);
+    pixman_image_unref (dest);
+    if (mask)
+	pixman_image_unref (mask);
+}
+
+int
+main (int argc, char *argv[])
+{
+    printf ("# %dx%d composites\n", WIDTH, HEIGHT);
+
+    bench_op ("src_rgbaf_rgbah", PIXMAN_OP_SRC, FALSE,
+	      PIXMAN_rgba_float, PIXMAN_rgba_half);
+    bench_op ("src_rgbah_rgbaf", PIXMAN_OP_SRC, FALSE,
+	      PIXMAN_rgba_half, PIXMAN_rgba_float);
+    bench_op ("over_rgbah_rgbah (general)", PIXMAN_OP_OVER, FALSE,
+	      PIXMAN_rgba_half, PIXMAN_rgba_half);
+    bench_op ("over_rgbaf_rgbaf (general)", PIXMAN_OP_OVER, FALSE,
+	      PIXMAN_rgba_float, PIXMAN_rgba_float);
+    bench_op ("in_rgbah_8_rgbah (general)", PIXMAN_OP_IN, TRUE,
+	      PIXMAN_rgba_half, PIXMAN_rgba_half);
+
+    return 0;
+}
@@ -0,0 +1,294 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "utils.h"
+
+/* Every half float must convert to the exact float and back, and
+ * floats must round to the nearest half, ties to even, both through
+ * the fast paths and through the iterators of the general
+ * implementation. Composites involving rgba_float, rgb_float and
+ * rgba_half must match the exact result within the precision of the
+ * destination.
+ */
+
+#define WIDTH 43
+#define HEIGHT 11
+
+typedef union
+{
+    uint32_t u;
+    float f;
+} float_bits_t;
+
+static int
+same_half (uint16_t a, uint16_t b)
+{
+    if (isnan (half_to_double (a)))
+	return isnan (half_to_double (b));
+
+    return a == b;
+}
+
+/* Converts all 65536 halves to floats and back. With an opaque mask,
+ * the general implementation does the work. SRC doesn't clamp, so
+ * both must give the same results.
+ */
+static int
+test_all_halves (pixman_bool_t general)
+{
+    pixman_image_t *half, *flt, *back, *mask;
+    uint16_t *h, *b;
+    float *f;
+    int i, result = 0;
+
+    half = pixman_image_create_bits (PIXMAN_rgba_half, 16384, 1, NULL, 0);
+    flt = pixman_image_create_bits (PIXMAN_rgba_float, 16384, 1, NULL, 0);
+    back = pixman_image_create_bits (PIXMAN_rgba_half, 16384, 1, NULL, 0);
+    mask = NULL;
+    if (general)
+    {
+	mask = pixman_image_create_bits (PIXMAN_a8, 16384, 1, NULL, 0);
+	memset (pixman_image_get_data (mask), 0xff, 16384);
+    }
+
+    h = (uint16_t *)pixman_image_get_data (half);
+    f = (float *)pixman_image_get_data (flt);
+    b = (uint16_t *)pixman_image_get_data (back);
+    for (i = 0; i < 65536; ++i)
+	h[i] = i;
+
+    pixman_image_composite32 (PIXMAN_OP_SRC, half, mask, flt,
+			      0, 0, 0, 0, 0, 0, 16384, 1);
+    pixman_image_composite32 (PIXMAN_OP_SRC, flt, mask, back,
+			      0, 0, 0, 0, 0, 0, 16384, 1);
+
+    for (i = 0; i < 65536; ++i)
+    {
+	double expected = half_to_double (i);
+
+	if (isnan (expected) && isnan (f[i]) && same_half (b[i], i))
+	    continue;
+
+	if ((float)expected != f[i] || !signbit (expected) != !signbit (f[i]) ||
+	    b[i] != i)
+	{
+	    printf ("half %04x (%s): became %g and %04x, expected %g and %04x\n",
+		    i, general ? "general" : "fast path",
+		    f[i], b[i], expected, i);
+	    result = 1;
+	    break;
+	}
+    }
+
+    pixman_image_unref (half);
+    pixman_image_unref (flt);
+    pixman_image_unref (back);
+    if (mask)
+	pixman_image_unref (mask);
+
+    return result;
+}
+
+/* Random floats, mostly close to the range of halves, must round to
+ * the nearest half.
+ */
+static int
+test_rounding (pixman_bool_t general)
+{
+    const int n = 1 << 16;
+    pixman_image_t *flt, *half, *mask;
+    float_bits_t *f;
+    uint16_t *h;
+    int i, result = 0;
+
+    prng_srand (general);
+
+    flt = pixman_image_create_bits (PIXMAN_rgba_float, n / 4, 1, NULL, 0);
+    half = pixman_image_create_bits (PIXMAN_rgba_half, n / 4, 1, NULL, 0);
+    mask = NULL;
+    if (general)
+    {
+	mask = pixman_image_create_bits (PIXMAN_a8, n / 4, 1, NULL, 0);
+	memset (pixman_image_get_data (mask), 0xff, n / 4);
+    }
+
+    f = (float_bits_t *)pixman_image_get_data (flt);
+    h = (uint16_t *)pixman_image_get_data (half);
+    for (i = 0; i < n; ++i)
+    {
+	uint32_t exponent = 127 - 26 + prng_rand_n (26 + 18);
+
+	f[i].u = (prng_rand () & 0x807fffff) | (exponent << 23);
+
+	/* Exact ties between two halves */
+	if (prng_rand_n (8) == 0)
+	    f[i].u &= ~0xfff;
+    }
+
+    pixman_image_composite32 (PIXMAN_OP_SRC, flt, mask, half,
+			      0, 0, 0, 0, 0, 0, n / 4, 1);
+
+    for (i = 0; i < n; ++i)
+    {
+	uint16_t expected = double_to_half (f[i].f);
+
+	if (h[i] != expected)
+	{
+	    printf ("float %.9g (%s): became %04x, expected %04x\n",
+		    f[i].f, general ? "general" : "fast path", h[i], expected);
+	    result = 1;
+	    break;
+	}
+    }
+
+    pixman_image_unref (flt);
+    pixman_image_unref (half);
+    if (mask)
+	pixman_image_unref (mask);
+
+    return result;
+}
+
+static const pixman_op_t ops[] =
+{
+    PIXMAN_OP_SRC, PIXMAN_OP_OVER, PIXMAN_OP_ADD
+};
+
+static const pixman_format_code_t formats[] =
+{
+    PIXMAN_rgba_float, PIXMAN_rgb_float, PIXMAN_rgba_half, PIXMAN_a8r8g8b8
+};
+
+static double
+tolerance (pixman_format_code_t format)
+{
+    switch (format)
+    {
+    case PIXMAN_rgba_float:
+    case PIXMAN_rgb_float:
+	return 1e-5;
+
+    case PIXMAN_rgba_half:
+	/* Half an ulp at 1.0, plus the rounding of the arithmetic */
+	return 1.01 / 2048;
+
+    default:
+	/* The float pipeline truncates after scaling by 2^bits */
+	return 1.01 / 255;
+    }
+}
+
+static int
+test_composite (int testnum)
+{
+    pixman_format_code_t src_format, dest_format;
+    pixman_image_t *src, *mask, *dest, *orig;
+    pixman_op_t op;
+    int x, y, i;
+    int result = 0;
+
+    prng_srand (testnum);
+
+    op = ops[prng_rand_n (ARRAY_LENGTH (ops))];
+    src_format = formats[prng_rand_n (ARRAY_LENGTH (formats))];
+    dest_format = formats[prng_rand_n (ARRAY_LENGTH (formats))];
+    if (src_format == PIXMAN_a8r8g8b8 && dest_format == PIXMAN_a8r8g8b8)
+	dest_format = PIXMAN_rgba_half;
+
+    /* A 1x1 repeating source is treated as a solid color */
+    if (prng_rand_n (4) == 0)
+    {
+	src = pixman_image_create_bits (src_format, 1, 1, NULL, 0);
+	pixman_image_set_repeat (src, PIXMAN_REPEAT_NORMAL);
+    }
+    else
+    {
+	src = pixman_image_create_bits (src_format, WIDTH, HEIGHT, NULL, 0);
+    }
+
+    dest = pixman_image_create_bits (dest_format, WIDTH, HEIGHT, NULL, 0);
+    orig = pixman_image_create_bits (dest_format, WIDTH, HEIGHT, NULL, 0);
+    image_fill_random (src);
+    image_fill_random (dest);
+    memcpy (pixman_image_get_data (orig), pixman_image_get_data (dest),
+	    pixman_image_get_stride (dest) * HEIGHT);
+
+    mask = NULL;
+    if (prng_rand_n (3) == 0)
+    {
+	mask = pixman_image_create_bits (PIXMAN_a8, WIDTH, HEIGHT, NULL, 0);
+	image_fill_random (mask);
+    }
+
+    pixman_image_composite32 (op, src, mask, dest,
+			      0, 0, 0, 0, 0, 0, WIDTH, HEIGHT);
+
+    for (y = 0; y < HEIGHT; ++y)
+    {
+	for (x = 0; x < WIDTH; ++x)
+	{
+	    double s[4], m[4] = { 1, 1, 1, 1 }, d[4], r[4];
+
+	    image_get_pixel (src, x, y, s);
+	    image_get_pixel (orig, x, y, d);
+	    if (mask)
+		image_get_pixel (mask, x, y, m);
+
+	    for (i = 0; i < 4; ++i)
+	    {
+		double sm = s[i] * m[i];
+
+		if (op == PIXMAN_OP_SRC)
+		    r[i] = sm;
+		else if (op == PIXMAN_OP_OVER)
+		    r[i] = sm + d[i] * (1 - s[0] * m[0]);
+		else
+		    r[i] = sm + d[i];
+
+		r[i] = MIN (r[i], 1.0);
+	    }
+
+	    image_get_pixel (dest, x, y, d);
+
+	    for (i = (dest_format == PIXMAN_rgb_float); i < 4; ++i)
+	    {
+		if (!(fabs (d[i] - r[i]) <= tolerance (dest_format)))
+		{
+		    printf ("test %d failed: %s %s %s %s at %d, %d: "
+			    "channel %d is %f, expected %f\n",
+			    testnum, operator_name (op), format_name (src_format),
+			    mask ? "a8" : "null", format_name (dest_format),
+			    x, y, i, d[i], r[i]);
+		    result = 1;
+		    goto out;
+		}
+	    }
+	}
+    }
+
+out:
+    pixman_image_unref (src);
+    if (mask)
+	pixman_image_unref (mask);
+    pixman_image_unref (dest);
+    pixman_image_unref (orig);
+
+    return result;
+}
+
+int
+main (int argc, const char *argv[])
+{
+    int i, n_failed = 0;
+
+    n_failed += test_all_halves (FALSE);
+    n_failed += test_all_halves (TRUE);
+    n_failed += test_rounding (FALSE);
+    n_failed += test_rounding (TRUE);
+
+    for (i = 0; i < 3000; ++i)
+	n_failed += test_composite (i);
+
+    return n_failed != 0;
+}
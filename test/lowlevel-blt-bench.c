@@ -25,21 +25,28 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <math.h>
 #include "utils.h"
 
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
 #define SOLID_FLAG 1
 #define CA_FLAG    2
 
-#define L1CACHE_SIZE (8 * 1024)
-#define L2CACHE_SIZE (128 * 1024)
+/* Used when the cache geometry can't be read from the system */
+#define DEFAULT_L1CACHE_SIZE (8 * 1024)
+#define DEFAULT_L2CACHE_SIZE (128 * 1024)
+#define DEFAULT_CACHELINE_LENGTH (32) /* bytes */
 
-/* This is applied to both L1 and L2 tests - alternatively, you could
- * parameterise bench_L or split it into two functions. It could be
- * read at runtime on some architectures, but it only really matters
- * that it's a number that's an integer divisor of both cacheline
- * lengths, and further, it only really matters for caches that don't
- * do allocate0on-write. */
-#define CACHELINE_LENGTH (32) /* bytes */
+/* The cacheline length is applied to both L1 and L2 tests - it only
+ * really matters that it's a number that's an integer divisor of both
+ * cacheline lengths, and further, it only really matters for caches
+ * that don't do allocate-on-write. */
+static int l1cache_size = DEFAULT_L1CACHE_SIZE;
+static int l2cache_size = DEFAULT_L2CACHE_SIZE;
+static int cacheline_length = DEFAULT_CACHELINE_LENGTH;
 
 #define WIDTH  1920
 #define HEIGHT 1080
@@ -57,6 +64,98 @@ uint32_t *mask;
 
 double bandwidth = 0.0;
 
+#ifdef __linux__
+static pixman_bool_t
+read_cache_file (int index, const char *name, char *buf, int size)
+{
+    char path[128];
+    FILE *f;
+    pixman_bool_t ok;
+
+    snprintf (path, sizeof path,
+	      "/sys/devices/system/cpu/cpu0/cache/index%d/%s", index, name);
+
+    if (!(f = fopen (path, "r")))
+	return FALSE;
+
+    ok = fgets (buf, size, f) != NULL;
+    fclose (f);
+
+    return ok;
+}
+
+/* Reads a cache attribute such as "48K" or "64" from sysfs */
+static int
+read_cache_attribute (int index, const char *name)
+{
+    char buf[32], *end;
+    long value;
+
+    if (!read_cache_file (index, name, buf, sizeof buf))
+	return -1;
+
+    value = strtol (buf, &end, 10);
+    if (end == buf)
+	return -1;
+
+    if (*end == 'K')
+	value *= 1024;
+    else if (*end == 'M')
+	value *= 1024 * 1024;
+
+    return value;
+}
+#endif
+
+/* Replaces the defaults with the data and unified caches of the
+ * first CPU, where the system tells us about them.
+ */
+static void
+detect_cache_sizes (void)
+{
+    int l1 = -1, l2 = -1, line = -1;
+
+#ifdef __linux__
+    int i, level;
+    char type[32];
+
+    for (i = 0; (level = read_cache_attribute (i, "level")) > 0; i++)
+    {
+	if (!read_cache_file (i, "type", type, sizeof type) ||
+	    strncmp (type, "Instruction", 11) == 0)
+	{
+	    continue;
+	}
+
+	if (level == 1)
+	{
+	    l1 = read_cache_attribute (i, "size");
+	    line = read_cache_attribute (i, "coherency_line_size");
+	}
+	else if (level == 2)
+	{
+	    l2 = read_cache_attribute (i, "size");
+	}
+    }
+#endif
+
+#if defined(_SC_LEVEL1_DCACHE_SIZE) && defined(_SC_LEVEL2_CACHE_SIZE)
+    if (l1 <= 0)
+	l1 = sysconf (_SC_LEVEL1_DCACHE_SIZE);
+    if (l2 <= 0)
+	l2 = sysconf (_SC_LEVEL2_CACHE_SIZE);
+    if (line <= 0)
+	line = sysconf (_SC_LEVEL1_DCACHE_LINESIZE);
+#endif
+
+    if (l1 > 0)
+	l1cache_size = l1;
+    if (l2 > 0)
+	l2cache_size = l2;
+    if (line >= (int)sizeof (uint32_t) && (line & (line - 1)) == 0)
+	cacheline_length = line;
+}
+
 double
 bench_memcpy ()
 {
@@ -90,7 +189,22 @@ bench_memcpy ()
 
 static pixman_bool_t use_scaling = FALSE;
 static pixman_filter_t filter = PIXMAN_FILTER_NEAREST;
-static pixman_bool_t use_csv_output = FALSE;
+
+typedef enum
+{
+    OUTPUT_TEXT,
+    OUTPUT_CSV,
+    OUTPUT_JSON
+} output_format_t;
+
+static output_format_t output_format = OUTPUT_TEXT;
+
+/* Each case is timed this many times, and the median is reported */
+#define MAX_REPEATS 100
+static int n_repeats = 1;
+
+/* Number of JSON result entries printed so far */
+static int n_json_results = 0;
 
 /* nearly 1x scale factor */
 static pixman_transform_t m =
@@ -194,7 +308,7 @@ bench_L  (pixman_op_t              op,
          */
         for (j = 0; j < lines_count; j++)
         {
-            for (k = 0; k < width + 62; k += CACHELINE_LENGTH / sizeof *dst)
+            for (k = 0; k < width + 62; k += cacheline_length / sizeof *dst)
             {
                 q += dst[j * WIDTH + k];
             }
@@ -371,6 +485,34 @@ bench_RT (pixman_op_t              op,
     return pix_cnt;
 }
 
+/* Composite statistics account each composite to the implementation
+ * that handled it, "general" meaning that no fast path matched.
+ */
+static pixman_bool_t
+uses_general_path (pixman_op_t     op,
+		   pixman_image_t *src_img,
+		   pixman_image_t *mask_img,
+		   pixman_image_t *dst_img)
+{
+    pixman_composite_stats_t stats;
+    pixman_bool_t general;
+
+    pixman_composite_stats_enable (TRUE);
+    pixman_composite_stats_reset ();
+
+    call_func (pixman_image_composite_wrapper, op, src_img, mask_img, dst_img,
+	       0, 0, 0, 0, 0, 0, TILEWIDTH, TILEWIDTH);
+
+    general = pixman_composite_stats_get (&stats, 1) == 1	&&
+	      stats.implementation				&&
+	      strcmp (stats.implementation, "general") == 0;
+
+    pixman_composite_stats_reset ();
+    pixman_composite_stats_enable (FALSE);
+
+    return general;
+}
+
 static double
 Mpx_per_sec (double pix_cnt, double t1, double t2, double t3)
 {
@@ -380,6 +522,147 @@ Mpx_per_sec (double pix_cnt, double t1, double t2, double t3)
     return pix_cnt / (testtime - overhead) / 1e6;
 }
 
+enum
+{
+    CASE_L1,
+    CASE_L2,
+    CASE_M,
+    CASE_HT,
+    CASE_VT,
+    CASE_R,
+    CASE_RT,
+    N_CASES
+};
+
+static const char *const case_names[N_CASES] =
+{
+    "L1", "L2", "M", "HT", "VT", "R", "RT"
+};
+
+static double
+bench_case (int                      which,
+            pixman_op_t              op,
+            pixman_image_t *         src_img,
+            pixman_image_t *         mask_img,
+            pixman_image_t *         dst_img,
+            int64_t                  n,
+            pixman_composite_func_t  func,
+            int                      l1test_width,
+            int                      nlines)
+{
+    switch (which)
+    {
+    case CASE_L1:
+	return bench_L (op, src_img, mask_img, dst_img, n, func, l1test_width, 1);
+    case CASE_L2:
+	return bench_L (op, src_img, mask_img, dst_img, n, func, l1test_width, nlines);
+    case CASE_M:
+	return bench_M (op, src_img, mask_img, dst_img, n, func);
+    case CASE_HT:
+	return bench_HT (op, src_img, mask_img, dst_img, n, func);
+    case CASE_VT:
+	return bench_VT (op, src_img, mask_img, dst_img, n, func);
+    case CASE_R:
+	return bench_R (op, src_img, mask_img, dst_img, n, func, WIDTH, HEIGHT);
+    case CASE_RT:
+	return bench_RT (op, src_img, mask_img, dst_img, n, func, WIDTH, HEIGHT);
+    }
+
+    return 0;
+}
+
+typedef struct
+{
+    int    n;
+    double samples[MAX_REPEATS];
+    double median;
+    double mean;
+    double stddev;
+} stats_t;
+
+static int
+compare_doubles (const void *a, const void *b)
+{
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+
+    return x < y ? -1 : x > y;
+}
+
+static void
+compute_stats (stats_t *stats)
+{
+    double sorted[MAX_REPEATS];
+    double sum = 0, sq = 0;
+    int i, n = stats->n;
+
+    stats->median = stats->mean = stats->stddev = 0;
+    if (n == 0)
+	return;
+
+    memcpy (sorted, stats->samples, n * sizeof (double));
+    qsort (sorted, n, sizeof (double), compare_doubles);
+
+    if (n & 1)
+	stats->median = sorted[n / 2];
+    else
+	stats->median = (sorted[n / 2 - 1] + sorted[n / 2]) / 2;
+
+    for (i = 0; i < n; i++)
+	sum += stats->samples[i];
+    stats->mean = sum / n;
+
+    for (i = 0; i < n; i++)
+	sq += (stats->samples[i] - stats->mean) * (stats->samples[i] - stats->mean);
+    if (n > 1)
+	stats->stddev = sqrt (sq / (n - 1));
+}
+
+static void
+print_case (const char    *testname,
+            int            which,
+            pixman_bool_t  general,
+            const stats_t *stats,
+            double         bytes_per_pix,
+            double         kops)
+{
+    int i;
+
+    switch (output_format)
+    {
+    case OUTPUT_TEXT:
+	printf (which <= CASE_L2 ? "  %s:%7.2f" : "  %s:%6.2f",
+		case_names[which], stats->median);
+	if (stats->n > 1 && stats->median > 0)
+	    printf ("+-%.1f%%", stats->stddev * 100 / stats->median);
+	if (which == CASE_M)
+	    printf (" (%6.2f%%)", stats->median * 1e6 * bytes_per_pix * (100.0 / bandwidth));
+	if (which == CASE_RT)
+	    printf (" (%4.0fKops/s)\n", kops);
+	break;
+
+    case OUTPUT_CSV:
+	printf ("%g", stats->median);
+	if (n_repeats > 1)
+	    printf (",%g", stats->stddev);
+	printf (which == CASE_RT ? "\n" : ",");
+	break;
+
+    case OUTPUT_JSON:
+	printf ("%s    { \"test\": \"%s\", \"case\": \"%s\", \"general\": %s, "
+		"\"median\": %g, \"stddev\": %g, \"samples\": [",
+		n_json_results++ ? ",\n" : "",
+		testname, case_names[which], general ? "true" : "false",
+		stats->median, stats->stddev);
+	for (i = 0; i < stats->n; i++)
+	    printf ("%s%g", i ? ", " : " ", stats->samples[i]);
+	printf (" ] }");
+	break;
+    }
+
+    fflush (stdout);
+}
+
 void
 bench_composite (const char *testname,
                  int         src_fmt,
@@ -396,10 +679,13 @@ bench_composite (const char *testname,
     pixman_image_t *                xsrc_img;
     pixman_image_t *                xdst_img;
     pixman_image_t *                xmask_img;
-    double                          t1, t2, t3, pix_cnt;
+    double                          t1, t2, t3, pix_cnt = 0;
     int64_t                         n, l1test_width, nlines;
     double                             bytes_per_pix = 0;
     pixman_bool_t                   bench_pixbuf = FALSE;
+    pixman_bool_t                   general;
+    stats_t                         stats;
+    int                             which;
 
     pixman_composite_func_t func = pixman_image_composite_wrapper;
 
@@ -475,137 +761,69 @@ bench_composite (const char *testname,
                                          dst,
                                          XWIDTH * 4);
 
-    if (!use_csv_output)
-        printf ("%24s %c", testname, func != pixman_image_composite_wrapper ?
-                '-' : '=');
+    general = uses_general_path (op, src_img, mask_img, dst_img);
 
-    memcpy (dst, src, BUFSIZE);
-    memcpy (src, dst, BUFSIZE);
+    if (output_format == OUTPUT_TEXT)
+        printf ("%24s %c", testname, general ? '*' : '=');
+    else if (output_format == OUTPUT_CSV)
+        printf ("%s,", testname);
 
-    l1test_width = L1CACHE_SIZE / 8 - 64;
+    l1test_width = l1cache_size / 8 - 64;
     if (l1test_width < 1)
 	l1test_width = 1;
     if (l1test_width > WIDTH - 64)
 	l1test_width = WIDTH - 64;
-    n = 1 + npix / (l1test_width * 8);
-    t1 = gettime ();
-#if EXCLUDE_OVERHEAD
-    pix_cnt = bench_L (op, src_img, mask_img, dst_img, n, pixman_image_composite_empty, l1test_width, 1);
-#endif
-    t2 = gettime ();
-    pix_cnt = bench_L (op, src_img, mask_img, dst_img, n, func, l1test_width, 1);
-    t3 = gettime ();
-    if (use_csv_output)
-        printf ("%g,", Mpx_per_sec (pix_cnt, t1, t2, t3));
-    else
-        printf ("  L1:%7.2f", Mpx_per_sec (pix_cnt, t1, t2, t3));
-    fflush (stdout);
-
-    memcpy (dst, src, BUFSIZE);
-    memcpy (src, dst, BUFSIZE);
 
-    nlines = (L2CACHE_SIZE / l1test_width) /
+    nlines = (l2cache_size / l1test_width) /
 	((PIXMAN_FORMAT_BPP(src_fmt) + PIXMAN_FORMAT_BPP(dst_fmt)) / 8);
     if (nlines < 1)
 	nlines = 1;
-    n = 1 + npix / (l1test_width * nlines);
-    t1 = gettime ();
-#if EXCLUDE_OVERHEAD
-    pix_cnt = bench_L (op, src_img, mask_img, dst_img, n, pixman_image_composite_empty, l1test_width, nlines);
-#endif
-    t2 = gettime ();
-    pix_cnt = bench_L (op, src_img, mask_img, dst_img, n, func, l1test_width, nlines);
-    t3 = gettime ();
-    if (use_csv_output)
-        printf ("%g,", Mpx_per_sec (pix_cnt, t1, t2, t3));
-    else
-        printf ("  L2:%7.2f", Mpx_per_sec (pix_cnt, t1, t2, t3));
-    fflush (stdout);
-
-    memcpy (dst, src, BUFSIZE);
-    memcpy (src, dst, BUFSIZE);
+    if (nlines > HEIGHT)
+	nlines = HEIGHT;
 
-    n = 1 + npix / (WIDTH * HEIGHT);
-    t1 = gettime ();
-#if EXCLUDE_OVERHEAD
-    pix_cnt = bench_M (op, src_img, mask_img, dst_img, n, pixman_image_composite_empty);
-#endif
-    t2 = gettime ();
-    pix_cnt = bench_M (op, src_img, mask_img, dst_img, n, func);
-    t3 = gettime ();
-    if (use_csv_output)
-        printf ("%g,", Mpx_per_sec (pix_cnt, t1, t2, t3));
-    else
-        printf ("  M:%6.2f (%6.2f%%)", Mpx_per_sec (pix_cnt, t1, t2, t3),
-                (pix_cnt / ((t3 - t2) - (t2 - t1)) * bytes_per_pix) * (100.0 / bandwidth) );
-    fflush (stdout);
-
-    memcpy (dst, src, BUFSIZE);
-    memcpy (src, dst, BUFSIZE);
-
-    n = 1 + npix / (8 * TILEWIDTH * TILEWIDTH);
-    t1 = gettime ();
-#if EXCLUDE_OVERHEAD
-    pix_cnt = bench_HT (op, src_img, mask_img, dst_img, n, pixman_image_composite_empty);
-#endif
-    t2 = gettime ();
-    pix_cnt = bench_HT (op, src_img, mask_img, dst_img, n, func);
-    t3 = gettime ();
-    if (use_csv_output)
-        printf ("%g,", Mpx_per_sec (pix_cnt, t1, t2, t3));
-    else
-        printf ("  HT:%6.2f", Mpx_per_sec (pix_cnt, t1, t2, t3));
-    fflush (stdout);
-
-    memcpy (dst, src, BUFSIZE);
-    memcpy (src, dst, BUFSIZE);
-
-    n = 1 + npix / (8 * TILEWIDTH * TILEWIDTH);
-    t1 = gettime ();
-#if EXCLUDE_OVERHEAD
-    pix_cnt = bench_VT (op, src_img, mask_img, dst_img, n, pixman_image_composite_empty);
-#endif
-    t2 = gettime ();
-    pix_cnt = bench_VT (op, src_img, mask_img, dst_img, n, func);
-    t3 = gettime ();
-    if (use_csv_output)
-        printf ("%g,", Mpx_per_sec (pix_cnt, t1, t2, t3));
-    else
-        printf ("  VT:%6.2f", Mpx_per_sec (pix_cnt, t1, t2, t3));
-    fflush (stdout);
+    for (which = 0; which < N_CASES; which++)
+    {
+	switch (which)
+	{
+	case CASE_L1:
+	    n = 1 + npix / (l1test_width * 8);
+	    break;
+	case CASE_L2:
+	    n = 1 + npix / (l1test_width * nlines);
+	    break;
+	case CASE_M:
+	    n = 1 + npix / (WIDTH * HEIGHT);
+	    break;
+	case CASE_RT:
+	    n = 1 + npix / (16 * TINYWIDTH * TINYWIDTH);
+	    break;
+	default:
+	    n = 1 + npix / (8 * TILEWIDTH * TILEWIDTH);
+	    break;
+	}
 
-    memcpy (dst, src, BUFSIZE);
-    memcpy (src, dst, BUFSIZE);
+	for (stats.n = 0; stats.n < n_repeats; stats.n++)
+	{
+	    memcpy (dst, src, BUFSIZE);
+	    memcpy (src, dst, BUFSIZE);
 
-    n = 1 + npix / (8 * TILEWIDTH * TILEWIDTH);
-    t1 = gettime ();
+	    t1 = gettime ();
 #if EXCLUDE_OVERHEAD
-    pix_cnt = bench_R (op, src_img, mask_img, dst_img, n, pixman_image_composite_empty, WIDTH, HEIGHT);
+	    pix_cnt = bench_case (which, op, src_img, mask_img, dst_img, n,
+				  pixman_image_composite_empty, l1test_width, nlines);
 #endif
-    t2 = gettime ();
-    pix_cnt = bench_R (op, src_img, mask_img, dst_img, n, func, WIDTH, HEIGHT);
-    t3 = gettime ();
-    if (use_csv_output)
-        printf ("%g,", Mpx_per_sec (pix_cnt, t1, t2, t3));
-    else
-        printf ("  R:%6.2f", Mpx_per_sec (pix_cnt, t1, t2, t3));
-    fflush (stdout);
+	    t2 = gettime ();
+	    pix_cnt = bench_case (which, op, src_img, mask_img, dst_img, n,
+				  func, l1test_width, nlines);
+	    t3 = gettime ();
 
-    memcpy (dst, src, BUFSIZE);
-    memcpy (src, dst, BUFSIZE);
+	    stats.samples[stats.n] = Mpx_per_sec (pix_cnt, t1, t2, t3);
+	}
 
-    n = 1 + npix / (16 * TINYWIDTH * TINYWIDTH);
-    t1 = gettime ();
-#if EXCLUDE_OVERHEAD
-    pix_cnt = bench_RT (op, src_img, mask_img, dst_img, n, pixman_image_composite_empty, WIDTH, HEIGHT);
-#endif
-    t2 = gettime ();
-    pix_cnt = bench_RT (op, src_img, mask_img, dst_img, n, func, WIDTH, HEIGHT);
-    t3 = gettime ();
-    if (use_csv_output)
-        printf ("%g\n", Mpx_per_sec (pix_cnt, t1, t2, t3));
-    else
-        printf ("  RT:%6.2f (%4.0fKops/s)\n", Mpx_per_sec (pix_cnt, t1, t2, t3), (double) n / ((t3 - t2) * 1000));
+	compute_stats (&stats);
+	print_case (testname, which, general, &stats, bytes_per_pix,
+		    stats.median * 1e3 * n / pix_cnt);
+    }
 
     if (mask_img) {
 	pixman_image_unref (mask_img);
@@ -977,7 +1195,7 @@ parser_self_test (void)
         exit (EXIT_FAILURE);
     }
 
-    if (!use_csv_output)
+    if (output_format == OUTPUT_TEXT)
         printf ("Parser self-test complete.\n");
 }
 
@@ -1060,6 +1278,8 @@ print_explanation (void)
             WIDTH, HEIGHT);
     printf ("RT  - as R, but %dx%d average sized rectangles are copied\n",
             TINYWIDTH, TINYWIDTH);
+    printf ("*   - after the test name: no fast path, the composite runs\n");
+    printf ("      through the three-pass general path\n");
     printf ("---\n");
 }
 
@@ -1068,6 +1288,10 @@ print_speed_scaling (double bw)
 {
     printf ("reference memcpy speed = %.1fMB/s (%.1fMP/s for 32bpp fills)\n",
             bw / 1000000., bw / 4000000);
+    printf ("L1 cache %dKB, L2 cache %dKB, %d byte cachelines\n",
+            l1cache_size / 1024, l2cache_size / 1024, cacheline_length);
+    if (n_repeats > 1)
+        printf ("median of %d runs, +- relative standard deviation\n", n_repeats);
 
     if (use_scaling)
     {
@@ -1083,14 +1307,318 @@ print_speed_scaling (double bw)
     printf ("---\n");
 }
 
+static const char *
+filter_name (void)
+{
+    if (!use_scaling)
+	return "none";
+    else if (filter == PIXMAN_FILTER_BILINEAR)
+	return "bilinear";
+    else
+	return "nearest";
+}
+
+static void
+print_csv_header (void)
+{
+    int i;
+
+    printf ("test");
+    for (i = 0; i < N_CASES; i++)
+    {
+	printf (",%s", case_names[i]);
+	if (n_repeats > 1)
+	    printf (",%s_stddev", case_names[i]);
+    }
+    printf ("\n");
+}
+
+static void
+print_json_header (double bw)
+{
+    printf ("{\n");
+    printf ("  \"filter\": \"%s\",\n", filter_name ());
+    printf ("  \"l1_cache\": %d,\n", l1cache_size);
+    printf ("  \"l2_cache\": %d,\n", l2cache_size);
+    printf ("  \"cacheline\": %d,\n", cacheline_length);
+    printf ("  \"memcpy\": %.1f,\n", bw / 1000000.);
+    printf ("  \"repeats\": %d,\n", n_repeats);
+    printf ("  \"results\": [\n");
+}
+
+/* Comparison of two result files written with -j. Each result is on
+ * a line of its own, so there is no need for a real JSON parser.
+ */
+typedef struct
+{
+    char    test[64];
+    char    which[8];
+    stats_t stats;
+} result_t;
+
+typedef struct
+{
+    char      filter[16];
+    int       l1cache_size;
+    int       l2cache_size;
+    int       n_results;
+    result_t *results;
+} result_file_t;
+
+/* Returns the text after "key": on the line, or NULL */
+static const char *
+json_field (const char *line, const char *key)
+{
+    char pattern[32];
+    const char *p;
+
+    snprintf (pattern, sizeof pattern, "\"%s\":", key);
+
+    if (!(p = strstr (line, pattern)))
+	return NULL;
+
+    p += strlen (pattern);
+    while (*p == ' ')
+	p++;
+
+    return p;
+}
+
+static pixman_bool_t
+json_string (const char *line, const char *key, char *buf, int size)
+{
+    const char *p = json_field (line, key);
+    int i;
+
+    if (!p || *p++ != '"')
+	return FALSE;
+
+    for (i = 0; i < size - 1 && p[i] && p[i] != '"'; i++)
+	buf[i] = p[i];
+    buf[i] = '\0';
+
+    return TRUE;
+}
+
+static pixman_bool_t
+read_results (const char *filename, result_file_t *file)
+{
+    char line[8192];
+    const char *p;
+    char *end;
+    result_t *r;
+    FILE *f;
+
+    memset (file, 0, sizeof *file);
+
+    if (!(f = fopen (filename, "r")))
+    {
+	printf ("Error: could not open '%s'.\n", filename);
+	return FALSE;
+    }
+
+    while (fgets (line, sizeof line, f))
+    {
+	if (!json_field (line, "test"))
+	{
+	    json_string (line, "filter", file->filter, sizeof file->filter);
+	    if ((p = json_field (line, "l1_cache")))
+		file->l1cache_size = atoi (p);
+	    if ((p = json_field (line, "l2_cache")))
+		file->l2cache_size = atoi (p);
+	    continue;
+	}
+
+	r = realloc (file->results, (file->n_results + 1) * sizeof (result_t));
+	if (!r)
+	    break;
+	file->results = r;
+	r = &file->results[file->n_results];
+
+	if (!json_string (line, "test", r->test, sizeof r->test) ||
+	    !json_string (line, "case", r->which, sizeof r->which) ||
+	    !(p = json_field (line, "samples")) || *p != '[')
+	{
+	    printf ("Error: malformed result in '%s': %s", filename, line);
+	    continue;
+	}
+
+	r->stats.n = 0;
+	for (p++; r->stats.n < MAX_REPEATS; p = end)
+	{
+	    double v = strtod (p, &end);
+
+	    if (end == p)
+		break;
+
+	    r->stats.samples[r->stats.n++] = v;
+	    while (*end == ' ' || *end == ',')
+		end++;
+	}
+
+	compute_stats (&r->stats);
+	file->n_results++;
+    }
+
+    fclose (f);
+
+    if (file->n_results == 0)
+    {
+	printf ("Error: no results in '%s'.\n", filename);
+	return FALSE;
+    }
+
+    return TRUE;
+}
+
+/* Two-sided 95% critical value of Student's t distribution */
+static double
+t_critical (double df)
+{
+    static const double table[] =
+    {
+	12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+	2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+	2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+    };
+    int i = (int)df;
+
+    if (i < 1)
+	i = 1;
+
+    return i <= ARRAY_LENGTH (table) ? table[i - 1] : 1.960;
+}
+
+/* Welch's t-test on the means of the two sets of runs */
+static pixman_bool_t
+significant_difference (const stats_t *a, const stats_t *b)
+{
+    double va, vb, t, df;
+
+    if (a->n < 2 || b->n < 2)
+	return FALSE;
+
+    va = a->stddev * a->stddev / a->n;
+    vb = b->stddev * b->stddev / b->n;
+
+    if (va + vb == 0)
+	return a->mean != b->mean;
+
+    t = fabs (a->mean - b->mean) / sqrt (va + vb);
+    df = (va + vb) * (va + vb) /
+	(va * va / (a->n - 1) + vb * vb / (b->n - 1));
+
+    return t > t_critical (df);
+}
+
+/* Prints the change of every result in @new_name relative to
+ * @old_name. A result regresses when it is significantly slower and
+ * its median dropped by more than @threshold percent. Returns the
+ * number of regressions, or -1 if the files could not be read.
+ */
+static int
+compare_results (const char *old_name, const char *new_name, double threshold)
+{
+    result_file_t old_file, new_file;
+    pixman_bool_t single_runs = FALSE;
+    int i, j, n_regressions = 0;
+
+    if (!read_results (old_name, &old_file) ||
+	!read_results (new_name, &new_file))
+    {
+	free (old_file.results);
+	return -1;
+    }
+
+    if (strcmp (old_file.filter, new_file.filter) != 0)
+    {
+	printf ("Warning: results were taken with different scaling filters "
+		"(%s and %s)\n", old_file.filter, new_file.filter);
+    }
+    if (old_file.l1cache_size != new_file.l1cache_size ||
+	old_file.l2cache_size != new_file.l2cache_size)
+    {
+	printf ("Warning: results were taken with different cache sizes\n");
+    }
+
+    printf ("%24s %4s %10s %10s %8s\n", "test", "case", "old", "new", "change");
+
+    for (i = 0; i < new_file.n_results; i++)
+    {
+	const result_t *n = &new_file.results[i];
+	const result_t *o = NULL;
+	const char *verdict = "";
+	double change;
+
+	for (j = 0; j < old_file.n_results; j++)
+	{
+	    if (strcmp (old_file.results[j].test, n->test) == 0 &&
+		strcmp (old_file.results[j].which, n->which) == 0)
+	    {
+		o = &old_file.results[j];
+		break;
+	    }
+	}
+
+	if (!o)
+	{
+	    printf ("%24s %4s %10s %10.2f\n", n->test, n->which, "-",
+		    n->stats.median);
+	    continue;
+	}
+
+	if (o->stats.n < 2 || n->stats.n < 2)
+	    single_runs = TRUE;
+
+	change = o->stats.median > 0 ?
+	    (n->stats.median - o->stats.median) * 100 / o->stats.median : 0;
+
+	if (significant_difference (&o->stats, &n->stats))
+	{
+	    if (change < -threshold)
+	    {
+		verdict = "  REGRESSION";
+		n_regressions++;
+	    }
+	    else if (change > threshold)
+	    {
+		verdict = "  faster";
+	    }
+	}
+
+	printf ("%24s %4s %10.2f %10.2f %+7.1f%%%s\n", n->test, n->which,
+		o->stats.median, n->stats.median, change, verdict);
+    }
+
+    if (single_runs)
+    {
+	printf ("Warning: some results have a single run, rerun with -r N "
+		"to test them for significance\n");
+    }
+
+    printf ("%d significant regressions over %.1f%%\n",
+	    n_regressions, threshold);
+
+    free (old_file.results);
+    free (new_file.results);
+
+    return n_regressions;
+}
+
 static void
 usage (const char *progname)
 {
-    printf ("Usage: %s [-b] [-n] [-c] [-m M] pattern\n", progname);
+    printf ("Usage: %s [-b] [-n] [-c | -j] [-r N] [-m M] pattern\n", progname);
+    printf ("       %s [-t T] -C old.json new.json\n", progname);
     printf ("  -n : benchmark nearest scaling\n");
     printf ("  -b : benchmark bilinear scaling\n");
     printf ("  -c : print output as CSV data\n");
+    printf ("  -j : print output as JSON data, including every run\n");
+    printf ("  -r N : run each case N times and report the median\n");
     printf ("  -m M : set reference memcpy speed to M MB/s instead of measuring it\n");
+    printf ("  -C : compare two JSON result files and list regressions,\n");
+    printf ("       exits with status 1 if there are any\n");
+    printf ("  -t T : only report changes of more than T percent (default 2)\n");
 }
 
 int
@@ -1098,10 +1626,37 @@ main (int argc, char *argv[])
 {
     int i;
     const char *pattern = NULL;
+    const char *compare_old = NULL, *compare_new = NULL;
+    double threshold = 2.0;
 
     for (i = 1; i < argc; i++)
     {
-	if (argv[i][0] == '-')
+	if (strcmp (argv[i], "-m") == 0 && i + 1 < argc)
+	{
+	    bandwidth = atof (argv[++i]) * 1e6;
+	}
+	else if (strcmp (argv[i], "-r") == 0 && i + 1 < argc)
+	{
+	    n_repeats = atoi (argv[++i]);
+	    if (n_repeats < 1)
+		n_repeats = 1;
+	    if (n_repeats > MAX_REPEATS)
+		n_repeats = MAX_REPEATS;
+	}
+	else if (strcmp (argv[i], "-t") == 0 && i + 1 < argc)
+	{
+	    threshold = atof (argv[++i]);
+	}
+	else if (strcmp (argv[i], "-C") == 0 && i + 2 < argc)
+	{
+	    compare_old = argv[++i];
+	    compare_new = argv[++i];
+	}
+	else if (strcmp (argv[i], "-j") == 0)
+	{
+	    output_format = OUTPUT_JSON;
+	}
+	else if (argv[i][0] == '-')
 	{
 	    if (strchr (argv[i] + 1, 'b'))
 	    {
@@ -1115,10 +1670,7 @@ main (int argc, char *argv[])
 	    }
 
 	    if (strchr (argv[i] + 1, 'c'))
-		use_csv_output = TRUE;
-
-	    if (strcmp (argv[i], "-m") == 0 && i + 1 < argc)
-		bandwidth = atof (argv[++i]) * 1e6;
+		output_format = OUTPUT_CSV;
 	}
 	else
 	{
@@ -1132,6 +1684,16 @@ main (int argc, char *argv[])
 	}
     }
 
+    if (compare_old)
+    {
+	int n_regressions = compare_results (compare_old, compare_new, threshold);
+
+	if (n_regressions < 0)
+	    return 2;
+
+	return n_regressions > 0;
+    }
+
     if (!pattern)
     {
 	usage (argv[0]);
@@ -1140,23 +1702,33 @@ main (int argc, char *argv[])
 
     parser_self_test ();
 
+    detect_cache_sizes ();
+
     src = aligned_malloc (4096, BUFSIZE * 3);
     memset (src, 0xCC, BUFSIZE * 3);
     dst = src + (BUFSIZE / 4);
     mask = dst + (BUFSIZE / 4);
 
-    if (!use_csv_output)
+    if (output_format == OUTPUT_TEXT)
         print_explanation ();
 
     if (bandwidth < 1.0)
         bandwidth = bench_memcpy ();
-    if (!use_csv_output)
+
+    if (output_format == OUTPUT_TEXT)
         print_speed_scaling (bandwidth);
+    else if (output_format == OUTPUT_CSV)
+        print_csv_header ();
+    else
+        print_json_header (bandwidth);
 
     if (strcmp (pattern, "all") == 0)
         run_default_tests (bandwidth);
     else
-        run_one_test (pattern, bandwidth, !use_csv_output);
+        run_one_test (pattern, bandwidth, output_format == OUTPUT_TEXT);
+
+    if (output_format == OUTPUT_JSON)
+        printf ("\n  ]\n}\n");
 
     free (src);
     return 0;
@@ -25,6 +25,7 @@
 #include <assert.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include <math.h>
 
 #ifdef HAVE_FLOAT128
@@ -117,6 +118,34 @@ byteswap_vector_48_16 (pixman_vector_48_16_t *v)
         v->v[i] = byteswap64 (v->v[i]);
 }
 
+/* Compares pixman_transform_points() with pixman_transform_point() for
+ * the 16.16 point closest to "vi" and a few points around it.
+ */
+static int
+check_points (const pixman_transform_t *t, const pixman_vector_48_16_t *vi)
+{
+    pixman_vector_t single[4], batch[4];
+    pixman_bool_t single_ok = TRUE;
+    int i, j;
+
+    for (i = 0; i < 4; i++)
+    {
+        for (j = 0; j < 3; j++)
+            single[i].vector[j] = (pixman_fixed_t)(vi->v[j] >> 16) + i * 0x1234;
+    }
+
+    memcpy (batch, single, sizeof (single));
+
+    for (i = 0; i < 4; i++)
+    {
+        if (!pixman_transform_point (t, &single[i]))
+            single_ok = FALSE;
+    }
+
+    return pixman_transform_points (t, batch, 4) != single_ok ||
+           memcmp (single, batch, sizeof (single)) != 0;
+}
+
 uint32_t
 test_matrix (int testnum, int verbose)
 {
@@ -130,7 +159,7 @@ test_matrix (int testnum, int verbose)
     {
         pixman_bool_t           transform_ok;
         pixman_transform_t      ti;
-        pixman_vector_48_16_t   vi, result_i;
+        pixman_vector_48_16_t   vi, result_i, result_batch;
 #ifdef HAVE_FLOAT128
         pixman_transform_f128_t tf;
         pixman_vector_f128_t    vf, result_f;
@@ -181,6 +210,20 @@ test_matrix (int testnum, int verbose)
         else
             transform_ok = pixman_transform_point_31_16 (&ti, &vi, &result_i);
 
+        /* the batch version must give exactly the same results */
+        if (pixman_transform_points_31_16 (&ti, &vi, &result_batch, 1) !=
+            transform_ok || memcmp (&result_i, &result_batch, sizeof (result_i)))
+        {
+            printf ("%d:%d: batch transform differs\n", testnum, i);
+            abort ();
+        }
+
+        if (check_points (&ti, &vi))
+        {
+            printf ("%d:%d: pixman_transform_points differs\n", testnum, i);
+            abort ();
+        }
+
 #ifdef HAVE_FLOAT128
         /* compare with a reference 128-bit floating point implementation */
         for (j = 0; j < 3; j++)
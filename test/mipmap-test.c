@@ -0,0 +1,324 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "utils.h"
+
+/* A mipmapped image composited with a downscaling bilinear transform
+ * must give the same result as compositing a hand built 2x2 box
+ * reduction of it, and the reduction must be rebuilt after the image
+ * changes.
+ */
+
+static const pixman_format_code_t formats[] =
+{
+    PIXMAN_a8r8g8b8, PIXMAN_x8r8g8b8, PIXMAN_a8b8g8r8, PIXMAN_r5g6b5, PIXMAN_a8
+};
+
+static const pixman_repeat_t repeats[] =
+{
+    PIXMAN_REPEAT_NONE, PIXMAN_REPEAT_PAD,
+    PIXMAN_REPEAT_NORMAL, PIXMAN_REPEAT_REFLECT
+};
+
+static const double scales[] = { 1.5, 2.0, 2.5, 3.75, 4.0, 6.0, 9.5, 17.0 };
+
+static uint32_t
+average (uint32_t a, uint32_t b, uint32_t c, uint32_t d)
+{
+    uint32_t result = 0;
+    int shift;
+
+    for (shift = 0; shift < 32; shift += 8)
+    {
+	uint32_t sum = ((a >> shift) & 0xff) + ((b >> shift) & 0xff) +
+	    ((c >> shift) & 0xff) + ((d >> shift) & 0xff);
+
+	result |= ((sum + 2) / 4) << shift;
+    }
+
+    return result;
+}
+
+/* Half size copy of a 32 bpp image, odd edges paired with themselves */
+static pixman_image_t *
+reduce (pixman_image_t *image)
+{
+    int width = pixman_image_get_width (image);
+    int height = pixman_image_get_height (image);
+    int stride = pixman_image_get_stride (image) / 4;
+    uint32_t *bits = pixman_image_get_data (image);
+    pixman_image_t *level;
+    uint32_t *dest;
+    int x, y;
+
+    level = pixman_image_create_bits (pixman_image_get_format (image),
+				      (width + 1) / 2, (height + 1) / 2,
+				      NULL, 0);
+    dest = pixman_image_get_data (level);
+
+    for (y = 0; y < (height + 1) / 2; ++y)
+    {
+	const uint32_t *top = bits + 2 * y * stride;
+	const uint32_t *bottom = bits + MIN (2 * y + 1, height - 1) * stride;
+
+	for (x = 0; x < (width + 1) / 2; ++x)
+	{
+	    int x1 = MIN (2 * x + 1, width - 1);
+
+	    *dest++ = average (top[2 * x], top[x1], bottom[2 * x], bottom[x1]);
+	}
+    }
+
+    return level;
+}
+
+/* Level @n of @image, as pixman builds it */
+static pixman_image_t *
+make_level (pixman_image_t *image, int n)
+{
+    pixman_format_code_t format = pixman_image_get_format (image);
+    int width = pixman_image_get_width (image);
+    int height = pixman_image_get_height (image);
+    pixman_image_t *level, *next;
+
+    if (n == 0 ||
+	(PIXMAN_FORMAT_BPP (format) == 32 && PIXMAN_FORMAT_R (format) == 8))
+    {
+	level = pixman_image_ref (image);
+    }
+    else
+    {
+	level = pixman_image_create_bits (
+	    PIXMAN_FORMAT_A (format) ? PIXMAN_a8r8g8b8 : PIXMAN_x8r8g8b8,
+	    width, height, NULL, 0);
+	pixman_image_set_transform (image, NULL);
+	pixman_image_set_filter (image, PIXMAN_FILTER_NEAREST, NULL, 0);
+	pixman_image_composite32 (PIXMAN_OP_SRC, image, NULL, level,
+				  0, 0, 0, 0, 0, 0, width, height);
+    }
+
+    while (n--)
+    {
+	next = reduce (level);
+	pixman_image_unref (level);
+	level = next;
+    }
+
+    return level;
+}
+
+static pixman_image_t *
+make_image (pixman_format_code_t format, int width, int height)
+{
+    pixman_image_t *image;
+
+    image = pixman_image_create_bits (format, width, height, NULL, 0);
+    prng_randmemset (pixman_image_get_data (image),
+		     pixman_image_get_stride (image) * height, 0);
+
+    return image;
+}
+
+static void
+composite (pixman_image_t *src, pixman_image_t *dest,
+	   const pixman_transform_t *transform, pixman_repeat_t repeat)
+{
+    pixman_image_set_transform (src, transform);
+    pixman_image_set_repeat (src, repeat);
+    pixman_image_set_filter (src, PIXMAN_FILTER_BILINEAR, NULL, 0);
+
+    pixman_image_composite32 (PIXMAN_OP_SRC, src, NULL, dest,
+			      -3, -2, 0, 0, 0, 0,
+			      pixman_image_get_width (dest),
+			      pixman_image_get_height (dest));
+}
+
+/* Composite with and without mipmaps and compare with the expected
+ * level. Returns the number of mismatching pixels.
+ */
+static int
+check (pixman_image_t *image, pixman_image_t *dest, pixman_image_t *ref,
+       const pixman_transform_t *transform, pixman_repeat_t repeat)
+{
+    int width = pixman_image_get_width (image);
+    int height = pixman_image_get_height (image);
+    pixman_transform_t level_transform;
+    pixman_image_t *level;
+    double scale;
+    int n, i, j, errors;
+    uint32_t *d, *r;
+
+    /* Same level choice as the library for a plain scale */
+    scale = MIN (pixman_fixed_to_double (transform->matrix[0][0]),
+		 pixman_fixed_to_double (transform->matrix[1][1]));
+
+    n = 0;
+    while (scale >= (2 << n) && (width > (1 << n) || height > (1 << n)))
+	n++;
+
+    if (repeat == PIXMAN_REPEAT_NORMAL || repeat == PIXMAN_REPEAT_REFLECT)
+    {
+	while (n > 0 && ((width | height) & ((1 << n) - 1)))
+	    n--;
+    }
+
+    level_transform = *transform;
+    for (i = 0; n > 0 && i < 2; ++i)
+    {
+	for (j = 0; j < 3; ++j)
+	{
+	    level_transform.matrix[i][j] =
+		(level_transform.matrix[i][j] + (1 << (n - 1))) >> n;
+	}
+    }
+
+    level = make_level (image, n);
+    composite (level, ref, n ? &level_transform : transform, repeat);
+    pixman_image_unref (level);
+
+    composite (image, dest, transform, repeat);
+
+    d = pixman_image_get_data (dest);
+    r = pixman_image_get_data (ref);
+
+    errors = 0;
+    for (i = 0; i < pixman_image_get_height (dest); ++i)
+    {
+	for (j = 0; j < pixman_image_get_width (dest); ++j)
+	{
+	    if (d[j] != r[j])
+		errors++;
+	}
+
+	d += pixman_image_get_stride (dest) / 4;
+	r += pixman_image_get_stride (ref) / 4;
+    }
+
+    return errors;
+}
+
+static int
+test_mipmap (int testnum)
+{
+    pixman_format_code_t format;
+    pixman_repeat_t repeat;
+    pixman_transform_t transform;
+    pixman_image_t *image, *dest, *ref;
+    pixman_color_t color = { 0x1234, 0x5678, 0x9abc, 0xffff };
+    pixman_box32_t box;
+    int width, height, errors;
+    double sx, sy;
+
+    prng_srand (testnum);
+
+    format = formats[prng_rand_n (ARRAY_LENGTH (formats))];
+    repeat = repeats[prng_rand_n (ARRAY_LENGTH (repeats))];
+    width = prng_rand_n (200) + 1;
+    height = prng_rand_n (200) + 1;
+
+    /* Give the tiling modes something to work with */
+    if (prng_rand_n (2))
+    {
+	width = (width + 15) & ~15;
+	height = (height + 15) & ~15;
+    }
+
+    sx = scales[prng_rand_n (ARRAY_LENGTH (scales))];
+    sy = scales[prng_rand_n (ARRAY_LENGTH (scales))];
+
+    pixman_transform_init_scale (&transform,
+				 pixman_double_to_fixed (sx),
+				 pixman_double_to_fixed (sy));
+    transform.matrix[0][2] = prng_rand_n (0x40000);
+    transform.matrix[1][2] = prng_rand_n (0x40000);
+
+    image = make_image (format, width, height);
+    dest = pixman_image_create_bits (PIXMAN_a8r8g8b8, 37, 29, NULL, 0);
+    ref = pixman_image_create_bits (PIXMAN_a8r8g8b8, 37, 29, NULL, 0);
+
+    pixman_image_set_mipmap (image, TRUE);
+
+    errors = check (image, dest, ref, &transform, repeat);
+
+    /* Reuses the cached levels */
+    errors += check (image, dest, ref, &transform, repeat);
+
+    /* Writes through pixman drop them */
+    box.x1 = prng_rand_n (width);
+    box.y1 = prng_rand_n (height);
+    box.x2 = box.x1 + prng_rand_n (width - box.x1) + 1;
+    box.y2 = box.y1 + prng_rand_n (height - box.y1) + 1;
+    pixman_image_fill_boxes (PIXMAN_OP_SRC, image, &color, 1, &box);
+
+    errors += check (image, dest, ref, &transform, repeat);
+
+    /* Direct writes have to be announced */
+    prng_randmemset (pixman_image_get_data (image),
+		     pixman_image_get_stride (image) * height, 0);
+    pixman_image_invalidate_mipmap (image);
+
+    errors += check (image, dest, ref, &transform, repeat);
+
+    pixman_image_unref (image);
+    pixman_image_unref (dest);
+    pixman_image_unref (ref);
+
+    if (errors)
+    {
+	printf ("test %d failed: %s repeat %d %dx%d scale %g %g, %d errors\n",
+		testnum, format_name (format), repeat,
+		width, height, sx, sy, errors);
+    }
+
+    return errors != 0;
+}
+
+/* Without mipmapping the result is a plain bilinear downscale */
+static int
+test_disabled (void)
+{
+    pixman_transform_t transform;
+    pixman_image_t *image, *dest, *ref;
+    int errors;
+
+    prng_srand (0);
+
+    pixman_transform_init_scale (&transform, pixman_int_to_fixed (4),
+				 pixman_int_to_fixed (4));
+
+    image = make_image (PIXMAN_a8r8g8b8, 64, 64);
+    dest = pixman_image_create_bits (PIXMAN_a8r8g8b8, 16, 16, NULL, 0);
+    ref = pixman_image_create_bits (PIXMAN_a8r8g8b8, 16, 16, NULL, 0);
+
+    composite (image, ref, &transform, PIXMAN_REPEAT_NONE);
+
+    pixman_image_set_mipmap (image, TRUE);
+    composite (image, dest, &transform, PIXMAN_REPEAT_NONE);
+    pixman_image_set_mipmap (image, FALSE);
+    composite (image, dest, &transform, PIXMAN_REPEAT_NONE);
+
+    errors = memcmp (pixman_image_get_data (dest), pixman_image_get_data (ref),
+		     16 * 16 * 4) != 0;
+
+    if (errors)
+	printf ("disabling mipmaps failed\n");
+
+    pixman_image_unref (image);
+    pixman_image_unref (dest);
+    pixman_image_unref (ref);
+
+    return errors;
+}
+
+int
+main (int argc, const char *argv[])
+{
+    int i, n_failed = 0;
+
+    for (i = 0; i < 2000; ++i)
+	n_failed += test_mipmap (i);
+
+    n_failed += test_disabled ();
+
+    return n_failed != 0;
+}
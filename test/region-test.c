@@ -1,10 +1,157 @@
 #include <assert.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include "utils.h"
 
+/* A mask with long runs, as left by rendering a region or a shape,
+ * sprinkled with single pixel noise.
+ */
+static pixman_image_t *
+make_mask (pixman_format_code_t format, int width, int height, int n_noise)
+{
+    pixman_color_t color = { 0, 0, 0, 0 };
+    pixman_image_t *image;
+    pixman_box32_t box;
+    int i;
+
+    image = pixman_image_create_bits (format, width, height, NULL, 0);
+
+    for (i = 0; i < 12; i++)
+    {
+	box.x1 = prng_rand_n (width);
+	box.y1 = prng_rand_n (height);
+	box.x2 = box.x1 + prng_rand_n (width - box.x1) + 1;
+	box.y2 = box.y1 + prng_rand_n (height - box.y1) + 1;
+	color.alpha = prng_rand_n (0x10000);
+
+	pixman_image_fill_boxes (PIXMAN_OP_SRC, image, &color, 1, &box);
+    }
+
+    for (i = 0; i < n_noise; i++)
+    {
+	box.x1 = prng_rand_n (width);
+	box.y1 = prng_rand_n (height);
+	box.x2 = box.x1 + 1;
+	box.y2 = box.y1 + 1;
+	color.alpha = prng_rand_n (0x10000);
+
+	pixman_image_fill_boxes (PIXMAN_OP_SRC, image, &color, 1, &box);
+    }
+
+    return image;
+}
+
+static int
+mask_value (pixman_image_t *image, int x, int y)
+{
+    uint8_t *row = (uint8_t *)pixman_image_get_data (image) +
+	y * pixman_image_get_stride (image);
+
+    if (pixman_image_get_format (image) == PIXMAN_a8)
+	return row[x];
+
+    /* Set a1 pixels count as 0xff */
+#ifdef WORDS_BIGENDIAN
+    return ((row[x >> 3] >> (7 - (x & 7))) & 1) * 0xff;
+#else
+    return ((row[x >> 3] >> (x & 7)) & 1) * 0xff;
+#endif
+}
+
+/* Every pixel of the mask at or above the threshold must be in the
+ * region, and no other
+ */
+static void
+test_from_image (int testnum)
+{
+    pixman_format_code_t format;
+    pixman_region32_t r32;
+    pixman_region16_t r16;
+    pixman_image_t *image;
+    pixman_box32_t *b32;
+    pixman_box16_t *b16;
+    int width, height, threshold;
+    int x, y, i, n32, n16;
+
+    prng_srand (testnum);
+
+    format = prng_rand_n (2) ? PIXMAN_a1 : PIXMAN_a8;
+    width = prng_rand_n (200) + 1;
+    height = prng_rand_n (40) + 1;
+    threshold = prng_rand_n (256);
+    image = make_mask (format, width, height, prng_rand_n (50));
+
+    if (format == PIXMAN_a1 && prng_rand_n (2))
+    {
+	pixman_region32_init_from_image (&r32, image);
+	threshold = 1;
+    }
+    else
+    {
+	pixman_region32_init_from_image_threshold (&r32, image, threshold);
+    }
+
+    assert (pixman_region32_selfcheck (&r32));
+
+    for (y = 0; y < height; y++)
+    {
+	for (x = 0; x < width; x++)
+	{
+	    assert (!!pixman_region32_contains_point (&r32, x, y, NULL) ==
+		    (mask_value (image, x, y) >= threshold));
+	}
+    }
+
+    pixman_region_init_from_image_threshold (&r16, image, threshold);
+
+    b32 = pixman_region32_rectangles (&r32, &n32);
+    b16 = pixman_region_rectangles (&r16, &n16);
+
+    assert (n16 == n32);
+    for (i = 0; i < n32; i++)
+    {
+	assert (b16[i].x1 == b32[i].x1 && b16[i].y1 == b32[i].y1 &&
+		b16[i].x2 == b32[i].x2 && b16[i].y2 == b32[i].y2);
+    }
+
+    pixman_region_fini (&r16);
+    pixman_region32_fini (&r32);
+    pixman_image_unref (image);
+}
+
+static void
+bench_from_image (const char *name, pixman_format_code_t format, int n_noise)
+{
+    pixman_region32_t region;
+    pixman_image_t *image;
+    double t;
+    int i, n = 50;
+
+    prng_srand (0);
+    image = make_mask (format, 2048, 2048, n_noise);
+
+    t = gettime ();
+    for (i = 0; i < n; i++)
+    {
+	if (format == PIXMAN_a1)
+	    pixman_region32_init_from_image (&region, image);
+	else
+	    pixman_region32_init_from_image_threshold (&region, image, 0x80);
+	if (i < n - 1)
+	    pixman_region32_fini (&region);
+    }
+    t = gettime () - t;
+
+    printf ("%-24s %8.3f ms %8d rects\n", name, t * 1000 / n,
+	    pixman_region32_n_rects (&region));
+
+    pixman_region32_fini (&region);
+    pixman_image_unref (image);
+}
+
 int
-main ()
+main (int argc, const char *argv[])
 {
     pixman_region32_t r1;
     pixman_region32_t r2;
@@ -121,5 +268,17 @@ main ()
     }
     pixman_image_unref (fill);
 
+    for (i = 0; i < 2000; i++)
+	test_from_image (i);
+
+    if (argc > 1 && strcmp (argv[1], "bench") == 0)
+    {
+	printf ("pixman_region32_init_from_image, 2048x2048 masks:\n");
+	bench_from_image ("a1 shapes", PIXMAN_a1, 0);
+	bench_from_image ("a1 shapes and noise", PIXMAN_a1, 20000);
+	bench_from_image ("a8 shapes", PIXMAN_a8, 0);
+	bench_from_image ("a8 shapes and noise", PIXMAN_a8, 20000);
+    }
+
     return 0;
 }
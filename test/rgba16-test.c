@@ -0,0 +1,174 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "utils.h"
+
+/* Composites to and from a16b16g16r16 must stay within one unit of
+ * the exact result, whether they take a fast path or the general
+ * implementation, and 8 bit pixels must survive a round trip.
+ */
+
+#define WIDTH 67
+#define HEIGHT 13
+
+static const pixman_op_t ops[] =
+{
+    PIXMAN_OP_SRC, PIXMAN_OP_OVER, PIXMAN_OP_ADD
+};
+
+static const pixman_format_code_t formats[] =
+{
+    PIXMAN_a16b16g16r16, PIXMAN_a8r8g8b8, PIXMAN_x8r8g8b8
+};
+
+static int
+test_composite (int testnum)
+{
+    pixman_format_code_t src_format, dest_format;
+    pixman_image_t *src, *mask, *dest, *orig;
+    pixman_op_t op;
+    int x, y, i, bits;
+    int result = 0;
+
+    prng_srand (testnum);
+
+    op = ops[prng_rand_n (ARRAY_LENGTH (ops))];
+    src_format = formats[prng_rand_n (ARRAY_LENGTH (formats))];
+    dest_format = formats[prng_rand_n (ARRAY_LENGTH (formats))];
+    if (src_format != PIXMAN_a16b16g16r16 && dest_format != PIXMAN_a16b16g16r16)
+	dest_format = PIXMAN_a16b16g16r16;
+
+    src = pixman_image_create_bits (src_format, WIDTH, HEIGHT, NULL, 0);
+    dest = pixman_image_create_bits (dest_format, WIDTH, HEIGHT, NULL, 0);
+    orig = pixman_image_create_bits (dest_format, WIDTH, HEIGHT, NULL, 0);
+    image_fill_random (src);
+    image_fill_random (dest);
+    memcpy (pixman_image_get_data (orig), pixman_image_get_data (dest),
+	    pixman_image_get_stride (dest) * HEIGHT);
+
+    /* A mask sends the composite through the general implementation */
+    mask = NULL;
+    if (prng_rand_n (3) == 0)
+    {
+	mask = pixman_image_create_bits (PIXMAN_a8, WIDTH, HEIGHT, NULL, 0);
+	image_fill_random (mask);
+    }
+
+    pixman_image_composite32 (op, src, mask, dest,
+			      0, 0, 0, 0, 0, 0, WIDTH, HEIGHT);
+
+    bits = dest_format == PIXMAN_a16b16g16r16 ? 16 : 8;
+
+    for (y = 0; y < HEIGHT; ++y)
+    {
+	for (x = 0; x < WIDTH; ++x)
+	{
+	    double s[4], m[4] = { 1, 1, 1, 1 }, d[4], r[4];
+
+	    image_get_pixel (src, x, y, s);
+	    image_get_pixel (orig, x, y, d);
+	    if (mask)
+		image_get_pixel (mask, x, y, m);
+
+	    for (i = 0; i < 4; ++i)
+	    {
+		double sm = s[i] * m[i];
+
+		if (op == PIXMAN_OP_SRC)
+		    r[i] = sm;
+		else if (op == PIXMAN_OP_OVER)
+		    r[i] = sm + d[i] * (1 - s[0] * m[0]);
+		else
+		    r[i] = sm + d[i];
+
+		r[i] = MIN (r[i], 1.0);
+	    }
+
+	    image_get_pixel (dest, x, y, d);
+
+	    for (i = (dest_format == PIXMAN_x8r8g8b8); i < 4; ++i)
+	    {
+		double scale = (1 << bits) - 1;
+
+		/* The float pipeline truncates after scaling by 2^bits */
+		if (fabs (d[i] - r[i]) * scale > 1.01)
+		{
+		    printf ("test %d failed: %s %s %s %s at %d, %d: "
+			    "channel %d is %f, expected %f\n",
+			    testnum, operator_name (op), format_name (src_format),
+			    mask ? "a8" : "null", format_name (dest_format),
+			    x, y, i, d[i] * scale, r[i] * scale);
+		    result = 1;
+		    goto out;
+		}
+	    }
+	}
+    }
+
+out:
+    pixman_image_unref (src);
+    if (mask)
+	pixman_image_unref (mask);
+    pixman_image_unref (dest);
+    pixman_image_unref (orig);
+
+    return result;
+}
+
+/* 8 bit pixels widen to 16 bits and come back unchanged */
+static int
+test_round_trip (pixman_format_code_t format)
+{
+    pixman_image_t *src, *wide, *dest;
+    uint32_t *s, *d;
+    int i, result;
+
+    prng_srand (0);
+
+    src = pixman_image_create_bits (format, WIDTH, HEIGHT, NULL, 0);
+    wide = pixman_image_create_bits (PIXMAN_a16b16g16r16, WIDTH, HEIGHT, NULL, 0);
+    dest = pixman_image_create_bits (PIXMAN_a8r8g8b8, WIDTH, HEIGHT, NULL, 0);
+    prng_randmemset (pixman_image_get_data (src), WIDTH * HEIGHT * 4, 0);
+
+    pixman_image_composite32 (PIXMAN_OP_SRC, src, NULL, wide,
+			      0, 0, 0, 0, 0, 0, WIDTH, HEIGHT);
+    pixman_image_composite32 (PIXMAN_OP_SRC, wide, NULL, dest,
+			      0, 0, 0, 0, 0, 0, WIDTH, HEIGHT);
+
+    s = pixman_image_get_data (src);
+    d = pixman_image_get_data (dest);
+    result = 0;
+    for (i = 0; i < WIDTH * HEIGHT; ++i)
+    {
+	uint32_t expected = s[i] | (format == PIXMAN_x8r8g8b8 ? 0xff000000 : 0);
+
+	if (d[i] != expected)
+	{
+	    printf ("%s round trip failed at %d: %08x became %08x\n",
+		    format_name (format), i, expected, d[i]);
+	    result = 1;
+	    break;
+	}
+    }
+
+    pixman_image_unref (src);
+    pixman_image_unref (wide);
+    pixman_image_unref (dest);
+
+    return result;
+}
+
+int
+main (int argc, const char *argv[])
+{
+    int i, n_failed = 0;
+
+    for (i = 0; i < 3000; ++i)
+	n_failed += test_composite (i);
+
+    n_failed += test_round_trip (PIXMAN_a8r8g8b8);
+    n_failed += test_round_trip (PIXMAN_x8r8g8b8);
+
+    return n_failed != 0;
+}
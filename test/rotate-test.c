@@ -36,10 +36,14 @@ static const pixman_transform_t transforms[] =
     TRANSFORM (0, 1, -1, 0),		/* wrong 270 degree rotation */
     TRANSFORM (1, 0, 0, 1),		/* wrong identity */
     TRANSFORM (-1, 0, 0, -1),		/* wrong 180 degree rotation */
+    TRANSFORM (-1, 0, 0, 1),		/* wrong horizontal flip */
+    TRANSFORM (1, 0, 0, -1),		/* wrong vertical flip */
     TRANSFORM (0, -F1, F1, 0),		/* correct 90 degree rotation */
     TRANSFORM (0, F1, -F1, 0),		/* correct 270 degree rotation */
     TRANSFORM (F1, 0, 0, F1),		/* correct identity */
     TRANSFORM (-F1, 0, 0, -F1),		/* correct 180 degree rotation */
+    TRANSFORM (-F1, 0, 0, F1),		/* correct horizontal flip */
+    TRANSFORM (F1, 0, 0, -F1),		/* correct vertical flip */
 };
 
 #define RANDOM_FORMAT()							\
@@ -115,6 +119,6 @@ int
 main (int argc, const char *argv[])
 {
     return fuzzer_test_main ("rotate", 15000,
-			     0x81E9EC2F,
+			     0xE727F2E3,
 			     test_transform, argc, argv);
 }
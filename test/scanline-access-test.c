@@ -0,0 +1,294 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "utils.h"
+
+/* Images with scanline accessors keep their real contents in a shadow
+ * buffer. begin_access copies a span into the pixels pixman sees and
+ * end_access copies it back, and everything outside the spans is
+ * garbage. Compositing must then give the same result as with plain
+ * images, which only happens when every row pixman touches is
+ * reported.
+ */
+
+#define POISON 0xa5
+
+typedef struct
+{
+    uint8_t *bits;
+    uint8_t *shadow;
+    int size;
+    int n_begin;
+    int n_end;
+    int open;
+} mapping_t;
+
+static void
+begin_access (pixman_image_t *image, void *address, int n_bytes,
+	      uint32_t access, void *data)
+{
+    mapping_t *map = data;
+    int offset = (uint8_t *)address - map->bits;
+
+    assert (offset >= 0 && offset + n_bytes <= map->size);
+    assert (access & (PIXMAN_ACCESS_READ | PIXMAN_ACCESS_WRITE));
+
+    memcpy (map->bits + offset, map->shadow + offset, n_bytes);
+    map->n_begin++;
+    map->open++;
+}
+
+static void
+end_access (pixman_image_t *image, void *address, int n_bytes,
+	    uint32_t access, void *data)
+{
+    mapping_t *map = data;
+    int offset = (uint8_t *)address - map->bits;
+
+    assert (offset >= 0 && offset + n_bytes <= map->size);
+
+    if (access & PIXMAN_ACCESS_WRITE)
+	memcpy (map->shadow + offset, map->bits + offset, n_bytes);
+    memset (map->bits + offset, POISON, n_bytes);
+    map->n_end++;
+    map->open--;
+}
+
+static const pixman_op_t ops[] =
+{
+    PIXMAN_OP_SRC, PIXMAN_OP_OVER, PIXMAN_OP_ADD, PIXMAN_OP_IN,
+    PIXMAN_OP_OUT_REVERSE, PIXMAN_OP_MULTIPLY
+};
+
+static const pixman_format_code_t formats[] =
+{
+    PIXMAN_a8r8g8b8, PIXMAN_a8b8g8r8, PIXMAN_r5g6b5, PIXMAN_a8
+};
+
+static pixman_image_t *
+make_pair (pixman_format_code_t format, int width, int height,
+	   mapping_t *map, pixman_image_t **plain)
+{
+    int stride = ((width * PIXMAN_FORMAT_BPP (format) / 8 + 3) & ~3) +
+		 prng_rand_n (2) * 4;
+    pixman_image_t *image;
+    uint32_t *bits;
+
+    map->size = stride * height;
+    map->bits = malloc (map->size);
+    map->shadow = malloc (map->size);
+    map->n_begin = map->n_end = map->open = 0;
+
+    prng_randmemset (map->shadow, map->size, 0);
+    memset (map->bits, POISON, map->size);
+
+    bits = malloc (map->size);
+    memcpy (bits, map->shadow, map->size);
+    *plain = pixman_image_create_bits (format, width, height, bits, stride);
+
+    image = pixman_image_create_bits (
+	format, width, height, (uint32_t *)map->bits, stride);
+    pixman_image_set_scanline_accessors (image, begin_access, end_access, map);
+
+    return image;
+}
+
+static void
+set_source_state (pixman_image_t *image, pixman_image_t *plain)
+{
+    static const pixman_repeat_t repeats[] =
+    {
+	PIXMAN_REPEAT_NONE, PIXMAN_REPEAT_NORMAL,
+	PIXMAN_REPEAT_PAD, PIXMAN_REPEAT_REFLECT
+    };
+    pixman_repeat_t repeat = repeats[prng_rand_n (ARRAY_LENGTH (repeats))];
+    pixman_transform_t transform;
+
+    pixman_image_set_repeat (image, repeat);
+    pixman_image_set_repeat (plain, repeat);
+
+    if (prng_rand_n (4) == 0)
+    {
+	pixman_transform_init_scale (&transform,
+				     pixman_double_to_fixed (1.5),
+				     pixman_double_to_fixed (0.75));
+	pixman_image_set_transform (image, &transform);
+	pixman_image_set_transform (plain, &transform);
+    }
+}
+
+static void
+free_pair (pixman_image_t *image, pixman_image_t *plain, mapping_t *map)
+{
+    uint32_t *bits = pixman_image_get_data (plain);
+
+    pixman_image_unref (image);
+    pixman_image_unref (plain);
+    free (bits);
+    free (map->bits);
+    free (map->shadow);
+}
+
+static int
+check_mapping (int testnum, const char *name, mapping_t *map)
+{
+    int i;
+
+    if (map->n_begin != map->n_end || map->open != 0)
+    {
+	printf ("test %d: unbalanced %s accesses (%d begin, %d end)\n",
+		testnum, name, map->n_begin, map->n_end);
+	return 1;
+    }
+
+    for (i = 0; i < map->size; ++i)
+    {
+	if (map->bits[i] != POISON)
+	{
+	    printf ("test %d: %s written outside an access span\n",
+		    testnum, name);
+	    return 1;
+	}
+    }
+
+    return 0;
+}
+
+static int
+compare_dest (int testnum, pixman_image_t *plain, mapping_t *map)
+{
+    uint8_t *ref = (uint8_t *)pixman_image_get_data (plain);
+    int stride = pixman_image_get_stride (plain);
+    int width = pixman_image_get_width (plain);
+    int height = pixman_image_get_height (plain);
+    int bpp = PIXMAN_FORMAT_BPP (pixman_image_get_format (plain));
+    int y;
+
+    for (y = 0; y < height; ++y)
+    {
+	if (memcmp (ref + y * stride, map->shadow + y * stride,
+		    width * bpp / 8) != 0)
+	{
+	    printf ("test %d: row %d differs\n", testnum, y);
+	    return 1;
+	}
+    }
+
+    return 0;
+}
+
+static int
+test_composite (int testnum)
+{
+    pixman_image_t *src, *mask, *dst, *src_ref, *mask_ref, *dst_ref;
+    mapping_t src_map, mask_map, dst_map;
+    int src_x, src_y, mask_x, mask_y, dst_x, dst_y, w, h;
+    int dst_w, dst_h;
+    pixman_op_t op;
+    int result = 0;
+
+    prng_srand (testnum);
+
+    op = ops[prng_rand_n (ARRAY_LENGTH (ops))];
+
+    src = make_pair (formats[prng_rand_n (ARRAY_LENGTH (formats))],
+		     prng_rand_n (30) + 1, prng_rand_n (30) + 1,
+		     &src_map, &src_ref);
+    set_source_state (src, src_ref);
+
+    mask = mask_ref = NULL;
+    if (prng_rand_n (2))
+    {
+	mask = make_pair (formats[prng_rand_n (ARRAY_LENGTH (formats))],
+			  prng_rand_n (30) + 1, prng_rand_n (30) + 1,
+			  &mask_map, &mask_ref);
+	set_source_state (mask, mask_ref);
+    }
+
+    dst_w = prng_rand_n (40) + 1;
+    dst_h = prng_rand_n (40) + 1;
+    dst = make_pair (formats[prng_rand_n (ARRAY_LENGTH (formats))],
+		     dst_w, dst_h, &dst_map, &dst_ref);
+
+    if (prng_rand_n (2))
+    {
+	pixman_region32_t clip;
+
+	pixman_region32_init_rect (&clip, 0, 0, dst_w / 2 + 1, dst_h);
+	pixman_region32_union_rect (&clip, &clip,
+				    dst_w / 2, dst_h / 3, dst_w, dst_h / 2);
+	pixman_image_set_clip_region32 (dst, &clip);
+	pixman_image_set_clip_region32 (dst_ref, &clip);
+	pixman_region32_fini (&clip);
+    }
+
+    src_x = prng_rand_n (40) - 10;
+    src_y = prng_rand_n (40) - 10;
+    mask_x = prng_rand_n (40) - 10;
+    mask_y = prng_rand_n (40) - 10;
+    dst_x = prng_rand_n (40) - 10;
+    dst_y = prng_rand_n (40) - 10;
+    w = prng_rand_n (40) + 1;
+    h = prng_rand_n (40) + 1;
+
+    pixman_image_composite32 (op, src, mask, dst,
+			      src_x, src_y, mask_x, mask_y, dst_x, dst_y, w, h);
+    pixman_image_composite32 (op, src_ref, mask_ref, dst_ref,
+			      src_x, src_y, mask_x, mask_y, dst_x, dst_y, w, h);
+
+    result |= compare_dest (testnum, dst_ref, &dst_map);
+    result |= check_mapping (testnum, "source", &src_map);
+    result |= check_mapping (testnum, "destination", &dst_map);
+    if (mask)
+	result |= check_mapping (testnum, "mask", &mask_map);
+
+    free_pair (src, src_ref, &src_map);
+    free_pair (dst, dst_ref, &dst_map);
+    if (mask)
+	free_pair (mask, mask_ref, &mask_map);
+
+    return result;
+}
+
+static int
+test_fill (void)
+{
+    static const pixman_box32_t boxes[] =
+    {
+	{ 1, 1, 5, 3 }, { 7, 2, 24, 9 }, { 0, 20, 12, 24 }
+    };
+    pixman_color_t color = { 0x1234, 0x5678, 0x9abc, 0xdef0 };
+    pixman_image_t *dst, *dst_ref;
+    mapping_t map;
+    int result = 0;
+
+    prng_srand (0);
+
+    dst = make_pair (PIXMAN_a8r8g8b8, 24, 24, &map, &dst_ref);
+
+    pixman_image_fill_boxes (PIXMAN_OP_SRC, dst, &color,
+			     ARRAY_LENGTH (boxes), boxes);
+    pixman_image_fill_boxes (PIXMAN_OP_SRC, dst_ref, &color,
+			     ARRAY_LENGTH (boxes), boxes);
+
+    result |= compare_dest (0, dst_ref, &map);
+    result |= check_mapping (0, "fill destination", &map);
+
+    free_pair (dst, dst_ref, &map);
+
+    return result;
+}
+
+int
+main (int argc, const char *argv[])
+{
+    int result = 0;
+    int i;
+
+    for (i = 1; i <= 3000; ++i)
+	result |= test_composite (i);
+
+    result |= test_fill ();
+
+    return result;
+}
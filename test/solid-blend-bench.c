@@ -0,0 +1,91 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "utils.h"
+
+/* Times the blend modes with a solid source, with and without an a8
+ * mask, against a source image filled with the same color, which goes
+ * through the combiners.
+ */
+
+#define WIDTH 1920
+#define HEIGHT 256
+#define N_ITERATIONS 10
+
+static const pixman_op_t ops[] =
+{
+    PIXMAN_OP_MULTIPLY,
+    PIXMAN_OP_SCREEN,
+    PIXMAN_OP_OVERLAY,
+    PIXMAN_OP_DARKEN,
+    PIXMAN_OP_LIGHTEN,
+    PIXMAN_OP_HARD_LIGHT,
+    PIXMAN_OP_DIFFERENCE,
+    PIXMAN_OP_EXCLUSION
+};
+
+static void
+bench_op (pixman_op_t op, pixman_bool_t with_mask)
+{
+    pixman_color_t color = { 0x4040, 0x2020, 0x6060, 0xc0c0 };
+    pixman_image_t *solid, *src, *mask, *dest;
+    uint32_t *s;
+    double t, fast, general;
+    int i;
+
+    solid = pixman_image_create_solid_fill (&color);
+    src = pixman_image_create_bits (PIXMAN_a8r8g8b8, WIDTH, HEIGHT, NULL, 0);
+    s = pixman_image_get_data (src);
+    for (i = 0; i < WIDTH * HEIGHT; ++i)
+	s[i] = 0xc0604020;
+
+    dest = pixman_image_create_bits (PIXMAN_a8r8g8b8, WIDTH, HEIGHT, NULL, 0);
+    prng_randmemset (pixman_image_get_data (dest), WIDTH * HEIGHT * 4, 0);
+
+    mask = NULL;
+    if (with_mask)
+    {
+	mask = pixman_image_create_bits (PIXMAN_a8, WIDTH, HEIGHT, NULL, 0);
+	prng_randmemset (pixman_image_get_data (mask),
+			 pixman_image_get_stride (mask) * HEIGHT, 0);
+    }
+
+    t = gettime ();
+    for (i = 0; i < N_ITERATIONS; ++i)
+	pixman_image_composite32 (op, solid, mask, dest, 0, 0, 0, 0, 0, 0, WIDTH, HEIGHT);
+    fast = gettime () - t;
+
+    t = gettime ();
+    for (i = 0; i < N_ITERATIONS; ++i)
+	pixman_image_composite32 (op, src, mask, dest, 0, 0, 0, 0, 0, 0, WIDTH, HEIGHT);
+    general = gettime () - t;
+
+    printf ("%-12s %-5s : %8.1f Mpix/s, combiners %8.1f Mpix/s\n",
+	    operator_name (op) + strlen ("PIXMAN_OP_"), with_mask ? "n_8" : "n",
+	    N_ITERATIONS * (double)WIDTH * HEIGHT / fast / 1e6,
+	    N_ITERATIONS * (double)WIDTH * HEIGHT / general / 1e6);
+
+    pixman_image_unref (solid);
+    pixman_image_unref (src);
+    if (mask)
+	pixman_image_unref (mask);
+    pixman_image_unref (dest);
+}
+
+int
+main (int argc, char *argv[])
+{
+    int i;
+
+    prng_srand (0);
+
+    printf ("# %dx%d composites\n", WIDTH, HEIGHT);
+
+    for (i = 0; i < ARRAY_LENGTH (ops); ++i)
+    {
+	bench_op (ops[i], FALSE);
+	bench_op (ops[i], TRUE);
+    }
+
+    return 0;
+}
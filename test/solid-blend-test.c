@@ -0,0 +1,171 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "utils.h"
+
+/* Blend modes with a solid source, with and without an a8 mask, must
+ * give the same results as a source image filled with that color,
+ * which always goes through the combiners.
+ */
+
+#define MAX_WIDTH 67
+#define MAX_HEIGHT 7
+
+static const pixman_op_t ops[] =
+{
+    PIXMAN_OP_MULTIPLY,
+    PIXMAN_OP_SCREEN,
+    PIXMAN_OP_OVERLAY,
+    PIXMAN_OP_DARKEN,
+    PIXMAN_OP_LIGHTEN,
+    PIXMAN_OP_HARD_LIGHT,
+    PIXMAN_OP_DIFFERENCE,
+    PIXMAN_OP_EXCLUSION
+};
+
+static const pixman_format_code_t formats[] =
+{
+    PIXMAN_a8r8g8b8, PIXMAN_x8r8g8b8, PIXMAN_a8b8g8r8, PIXMAN_x8b8g8r8
+};
+
+static uint32_t
+random_color (void)
+{
+    uint32_t a, c;
+    int i;
+
+    switch (prng_rand_n (5))
+    {
+    case 0: return 0;
+    case 1: return prng_rand ();
+    case 2: a = 0xff; break;
+    default: a = prng_rand_n (0x100); break;
+    }
+
+    c = a << 24;
+    for (i = 0; i < 3; ++i)
+	c |= prng_rand_n (a + 1) << (8 * i);
+
+    return c;
+}
+
+static pixman_image_t *
+create_solid (uint32_t color)
+{
+    pixman_image_t *image;
+    pixman_color_t c;
+
+    if (prng_rand_n (2))
+    {
+	c.alpha = (color >> 24) * 0x101;
+	c.red = ((color >> 16) & 0xff) * 0x101;
+	c.green = ((color >> 8) & 0xff) * 0x101;
+	c.blue = (color & 0xff) * 0x101;
+
+	return pixman_image_create_solid_fill (&c);
+    }
+
+    image = pixman_image_create_bits (PIXMAN_a8r8g8b8, 1, 1, NULL, 0);
+    *pixman_image_get_data (image) = color;
+    pixman_image_set_repeat (image, PIXMAN_REPEAT_NORMAL);
+
+    return image;
+}
+
+static int
+test_blend (int testnum)
+{
+    pixman_format_code_t format;
+    pixman_image_t *solid, *src, *mask, *dest, *ref;
+    uint32_t color, *s, *d, *r, alpha_mask;
+    pixman_op_t op;
+    int width, height, dest_x, mask_x, stride;
+    int i, n_pixels, result = 0;
+
+    prng_srand (testnum);
+
+    op = ops[prng_rand_n (ARRAY_LENGTH (ops))];
+    format = formats[prng_rand_n (ARRAY_LENGTH (formats))];
+    width = prng_rand_n (MAX_WIDTH) + 1;
+    height = prng_rand_n (MAX_HEIGHT) + 1;
+    dest_x = prng_rand_n (4);
+    mask_x = prng_rand_n (4);
+    color = random_color ();
+
+    solid = create_solid (color);
+    src = pixman_image_create_bits (PIXMAN_a8r8g8b8, width, height, NULL, 0);
+    s = pixman_image_get_data (src);
+    for (i = 0; i < width * height; ++i)
+	s[i] = color;
+
+    dest = pixman_image_create_bits (format, width + dest_x, height, NULL, 0);
+    ref = pixman_image_create_bits (format, width + dest_x, height, NULL, 0);
+    stride = pixman_image_get_stride (dest);
+    n_pixels = stride / 4 * height;
+    d = pixman_image_get_data (dest);
+    r = pixman_image_get_data (ref);
+    prng_randmemset (d, stride * height, 0);
+    memcpy (r, d, stride * height);
+
+    mask = NULL;
+    if (prng_rand_n (2))
+    {
+	uint8_t *m;
+
+	mask = pixman_image_create_bits (PIXMAN_a8, width + mask_x, height, NULL, 0);
+	m = (uint8_t *)pixman_image_get_data (mask);
+
+	/* Runs of clear and opaque mask values, with edges in between */
+	for (i = 0; i < pixman_image_get_stride (mask) * height; ++i)
+	{
+	    switch (prng_rand_n (4))
+	    {
+	    case 0: m[i] = 0; break;
+	    case 1: m[i] = i ? m[i - 1] : 0xff; break;
+	    case 2: m[i] = 0xff; break;
+	    default: m[i] = prng_rand_n (0x100); break;
+	    }
+	}
+    }
+
+    pixman_image_composite32 (op, solid, mask, dest,
+			      0, 0, mask_x, 0, dest_x, 0, width, height);
+    pixman_image_composite32 (op, src, mask, ref,
+			      0, 0, mask_x, 0, dest_x, 0, width, height);
+
+    /* The padding of x8r8g8b8 and x8b8g8r8 is undefined */
+    alpha_mask = PIXMAN_FORMAT_A (format) ? 0xffffffff : 0x00ffffff;
+
+    for (i = 0; i < n_pixels; ++i)
+    {
+	if ((d[i] & alpha_mask) != (r[i] & alpha_mask))
+	{
+	    printf ("test %d failed: %s %08x %s %s, pixel %d is %08x, "
+		    "expected %08x\n", testnum, operator_name (op), color,
+		    mask ? "a8" : "null", format_name (format),
+		    i, d[i], r[i]);
+	    result = 1;
+	    break;
+	}
+    }
+
+    pixman_image_unref (solid);
+    pixman_image_unref (src);
+    if (mask)
+	pixman_image_unref (mask);
+    pixman_image_unref (dest);
+    pixman_image_unref (ref);
+
+    return result;
+}
+
+int
+main (int argc, const char *argv[])
+{
+    int i, n_failed = 0;
+
+    for (i = 0; i < 20000; ++i)
+	n_failed += test_blend (i);
+
+    return n_failed != 0;
+}
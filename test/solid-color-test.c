@@ -0,0 +1,142 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "utils.h"
+
+/* pixman_image_composite_color32() must give the same results as
+ * compositing with a solid fill image, and images recycled from the
+ * per-thread pool must not carry state over from their previous use.
+ */
+
+#define WIDTH 23
+#define HEIGHT 17
+
+static const pixman_op_t ops[] =
+{
+    PIXMAN_OP_SRC, PIXMAN_OP_OVER, PIXMAN_OP_ADD, PIXMAN_OP_IN,
+    PIXMAN_OP_OUT_REVERSE, PIXMAN_OP_ATOP, PIXMAN_OP_SCREEN
+};
+
+static const pixman_format_code_t formats[] =
+{
+    PIXMAN_a8r8g8b8, PIXMAN_x8r8g8b8, PIXMAN_r5g6b5, PIXMAN_a8
+};
+
+static pixman_image_t *
+make_image (pixman_format_code_t format)
+{
+    pixman_image_t *image;
+
+    image = pixman_image_create_bits (format, WIDTH, HEIGHT, NULL, 0);
+    prng_randmemset (pixman_image_get_data (image),
+		     pixman_image_get_stride (image) * HEIGHT, 0);
+
+    return image;
+}
+
+static pixman_image_t *
+copy_image (pixman_image_t *image)
+{
+    pixman_image_t *copy;
+
+    copy = pixman_image_create_bits (pixman_image_get_format (image),
+				     WIDTH, HEIGHT, NULL, 0);
+    memcpy (pixman_image_get_data (copy), pixman_image_get_data (image),
+	    pixman_image_get_stride (image) * HEIGHT);
+
+    return copy;
+}
+
+/* Leave an image with unusual state in the pool */
+static void
+pollute_pool (void)
+{
+    pixman_color_t color = { 0xffff, 0, 0, 0x8000 };
+    pixman_region32_t clip;
+    pixman_transform_t transform;
+    pixman_image_t *image;
+
+    image = pixman_image_create_solid_fill (&color);
+
+    pixman_transform_init_scale (&transform, pixman_int_to_fixed (3),
+				 pixman_int_to_fixed (2));
+    pixman_image_set_transform (image, &transform);
+    pixman_image_set_repeat (image, PIXMAN_REPEAT_REFLECT);
+    pixman_image_set_filter (image, PIXMAN_FILTER_BILINEAR, NULL, 0);
+    pixman_image_set_component_alpha (image, TRUE);
+
+    pixman_region32_init_rect (&clip, 0, 0, 3, 3);
+    pixman_image_set_clip_region32 (image, &clip);
+    pixman_region32_fini (&clip);
+
+    pixman_image_unref (image);
+}
+
+static int
+test_color (int testnum)
+{
+    pixman_image_t *dest, *ref, *mask, *solid;
+    pixman_color_t color;
+    pixman_op_t op;
+    int x, y, w, h;
+    int result = 0;
+
+    prng_srand (testnum);
+
+    op = ops[prng_rand_n (ARRAY_LENGTH (ops))];
+    color.red = prng_rand ();
+    color.green = prng_rand ();
+    color.blue = prng_rand ();
+    color.alpha = prng_rand ();
+
+    x = prng_rand_n (WIDTH);
+    y = prng_rand_n (HEIGHT);
+    w = prng_rand_n (WIDTH) + 1;
+    h = prng_rand_n (HEIGHT) + 1;
+
+    mask = NULL;
+    if (prng_rand_n (2))
+    {
+	mask = make_image (formats[prng_rand_n (ARRAY_LENGTH (formats))]);
+	if (prng_rand_n (2))
+	    pixman_image_set_component_alpha (mask, TRUE);
+    }
+
+    dest = make_image (formats[prng_rand_n (ARRAY_LENGTH (formats))]);
+    ref = copy_image (dest);
+
+    pollute_pool ();
+
+    pixman_image_composite_color32 (op, &color, mask, dest,
+				    0, 0, x, y, w, h);
+
+    solid = pixman_image_create_solid_fill (&color);
+    pixman_image_composite32 (op, solid, mask, ref, 0, 0, 0, 0, x, y, w, h);
+    pixman_image_unref (solid);
+
+    if (memcmp (pixman_image_get_data (dest), pixman_image_get_data (ref),
+		pixman_image_get_stride (dest) * HEIGHT) != 0)
+    {
+	printf ("test %d: results differ\n", testnum);
+	result = 1;
+    }
+
+    pixman_image_unref (dest);
+    pixman_image_unref (ref);
+    if (mask)
+	pixman_image_unref (mask);
+
+    return result;
+}
+
+int
+main (int argc, const char *argv[])
+{
+    int result = 0;
+    int i;
+
+    for (i = 1; i <= 5000; ++i)
+	result |= test_color (i);
+
+    return result;
+}
@@ -11,6 +11,7 @@ int main ()
 #else
 
 #include <stdlib.h>
+#include <string.h>
 #include <pthread.h>
 
 typedef struct
@@ -115,6 +116,195 @@ thread (void *data)
     return (void *)(uintptr_t)crc32;
 }
 
+/* Threads sharing one glyph cache. There are more glyphs than the
+ * cache keeps, so threads keep inserting and trimming while others
+ * look glyphs up; every glyph that is used is checked to still hold
+ * its own pixels.
+ */
+#define N_GLYPHS 20000
+#define N_RUNS 300
+#define RUN_LENGTH 32
+
+/* With the cache frozen throughout, the threads also remove glyphs and
+ * insert far more than the cache keeps, which must still succeed.
+ */
+#define N_FROZEN_GLYPHS 100000
+#define N_FROZEN_THREADS 8
+#define N_FROZEN_RUNS 400
+
+typedef struct
+{
+    pixman_glyph_cache_t *cache;
+    int                   thread_no;
+    int                   n_keys;
+    pixman_bool_t         remove;
+    int                   n_runs;
+    int                   n_errors;
+    double                time;
+} glyph_info_t;
+
+static uint8_t
+glyph_value (int key)
+{
+    return ((key * 2654435761u) >> 24) | 1;
+}
+
+static const void *
+get_glyph (pixman_glyph_cache_t *cache, int key)
+{
+    void *font_key = (void *)(uintptr_t)(1 + key % 3);
+    void *glyph_key = (void *)(uintptr_t)(1 + key);
+    const void *glyph;
+    pixman_image_t *image;
+
+    if ((glyph = pixman_glyph_cache_lookup (cache, font_key, glyph_key)))
+	return glyph;
+
+    image = pixman_image_create_bits (PIXMAN_a8, 2, 2, NULL, 0);
+    memset (pixman_image_get_data (image), glyph_value (key),
+	    2 * pixman_image_get_stride (image));
+
+    glyph = pixman_glyph_cache_insert (cache, font_key, glyph_key,
+				       0, 0, image);
+    pixman_image_unref (image);
+
+    return glyph;
+}
+
+static void *
+glyph_thread (void *data)
+{
+    static const pixman_color_t white = { 0xffff, 0xffff, 0xffff, 0xffff };
+    glyph_info_t *info = data;
+    pixman_image_t *src, *dest;
+    pixman_glyph_t glyphs[RUN_LENGTH];
+    int keys[RUN_LENGTH];
+    prng_t prng;
+    double start = gettime ();
+    int i, j;
+
+    prng_srand_r (&prng, info->thread_no);
+
+    src = pixman_image_create_solid_fill (&white);
+    dest = pixman_image_create_bits (PIXMAN_a8, 2 * RUN_LENGTH, 2, NULL, 0);
+
+    for (i = 0; i < info->n_runs; ++i)
+    {
+	uint8_t *bits;
+
+	pixman_glyph_cache_freeze (info->cache);
+
+	for (j = 0; j < RUN_LENGTH; ++j)
+	{
+	    keys[j] = prng_rand_r (&prng) % info->n_keys;
+	    glyphs[j].x = 2 * j;
+	    glyphs[j].y = 0;
+	    glyphs[j].glyph = get_glyph (info->cache, keys[j]);
+
+	    if (!glyphs[j].glyph)
+		info->n_errors++;
+	}
+
+	memset (pixman_image_get_data (dest), 0,
+		2 * pixman_image_get_stride (dest));
+
+	if (info->n_errors == 0)
+	{
+	    pixman_composite_glyphs_no_mask (PIXMAN_OP_ADD, src, dest,
+					     0, 0, 0, 0, info->cache,
+					     RUN_LENGTH, glyphs);
+	}
+
+	/* The glyphs stay valid until the thaw */
+	for (j = 0; info->remove && j < RUN_LENGTH; j += 4)
+	{
+	    pixman_glyph_cache_remove (info->cache,
+				       (void *)(uintptr_t)(1 + keys[j] % 3),
+				       (void *)(uintptr_t)(1 + keys[j]));
+	}
+
+	pixman_glyph_cache_thaw (info->cache);
+
+	bits = (uint8_t *)pixman_image_get_data (dest);
+	for (j = 0; j < RUN_LENGTH; ++j)
+	{
+	    if (bits[2 * j] != glyph_value (keys[j]))
+		info->n_errors++;
+	}
+    }
+
+    pixman_image_unref (src);
+    pixman_image_unref (dest);
+
+    info->time = gettime () - start;
+
+    return NULL;
+}
+
+/* Runs @n_threads threads over @cache and returns the number of
+ * errors, with the total number of glyph runs per second in @rate.
+ */
+static int
+run_glyph_threads (pixman_glyph_cache_t *cache, int n_keys, pixman_bool_t remove,
+		   int n_threads, int n_runs, double *rate)
+{
+    glyph_info_t *info = calloc (n_threads, sizeof (glyph_info_t));
+    pthread_t *threads = calloc (n_threads, sizeof (pthread_t));
+    double time = 0;
+    int i, n_errors = 0;
+
+    for (i = 0; i < n_threads; ++i)
+    {
+	info[i].cache = cache;
+	info[i].thread_no = i;
+	info[i].n_keys = n_keys;
+	info[i].remove = remove;
+	info[i].n_runs = n_runs;
+	pthread_create (&threads[i], NULL, glyph_thread, &info[i]);
+    }
+
+    for (i = 0; i < n_threads; ++i)
+    {
+	pthread_join (threads[i], NULL);
+	n_errors += info[i].n_errors;
+	time = MAX (time, info[i].time);
+    }
+
+    *rate = n_threads * n_runs / time;
+
+    free (threads);
+    free (info);
+
+    return n_errors;
+}
+
+/* Glyph runs per second against the number of threads. With no
+ * contention the rate grows with the number of threads up to the
+ * number of cores.
+ */
+static void
+bench (int max_threads)
+{
+    pixman_glyph_cache_t *cache = pixman_glyph_cache_create ();
+    double rate, rate_1 = 0;
+    int n;
+
+    /* Fill the cache first */
+    run_glyph_threads (cache, N_GLYPHS, FALSE, 1, 20000, &rate);
+
+    printf ("threads   runs/s   scaling\n");
+    for (n = 1; n <= max_threads; n *= 2)
+    {
+	run_glyph_threads (cache, N_GLYPHS, FALSE, n, 20000, &rate);
+	if (n == 1)
+	    rate_1 = rate;
+
+	printf ("%7d %8.0f %9.2f\n", n, rate, rate / rate_1);
+    }
+
+    pixman_glyph_cache_destroy (cache);
+}
+
 static inline uint32_t
 byteswap32 (uint32_t x)
 {
@@ -125,14 +315,16 @@ byteswap32 (uint32_t x)
 }
 
 int
-main (void)
+main (int argc, const char *argv[])
 {
     uint32_t dest[16 * DEST_WIDTH];
     info_t info[16] = { { 0 } };
     pthread_t threads[16];
     void *retvals[16];
     uint32_t crc32s[16], crc32;
-    int i;
+    pixman_glyph_cache_t *cache;
+    double rate;
+    int i, n_errors;
 
     for (i = 0; i < 16; ++i)
     {
@@ -165,6 +357,27 @@ main (void)
 	return 1;
     }
 
+    cache = pixman_glyph_cache_create ();
+    n_errors = run_glyph_threads (cache, N_GLYPHS, FALSE, 16, N_RUNS, &rate);
+    pixman_glyph_cache_destroy (cache);
+
+    cache = pixman_glyph_cache_create ();
+    pixman_glyph_cache_freeze (cache);
+    n_errors += run_glyph_threads (cache, N_FROZEN_GLYPHS, TRUE,
+				   N_FROZEN_THREADS, N_FROZEN_RUNS, &rate);
+    pixman_glyph_cache_thaw (cache);
+    pixman_glyph_cache_destroy (cache);
+
+    if (n_errors != 0)
+    {
+	printf ("thread-test failed. Threads sharing a glyph cache "
+		"saw wrong glyphs\n");
+	return 1;
+    }
+
+    if (argc > 1 && strcmp (argv[1], "bench") == 0)
+	bench (argc > 2 ? atoi (argv[2]) : 32);
+
     return 0;
 }
 
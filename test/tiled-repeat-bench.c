@@ -0,0 +1,75 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "utils.h"
+
+/* Times narrow NORMAL repeat patterns filling a large destination.
+ */
+
+#define WIDTH 1920
+#define HEIGHT 1080
+#define N_ITERATIONS 10
+
+static const pixman_op_t ops[] =
+{
+    PIXMAN_OP_SRC, PIXMAN_OP_OVER, PIXMAN_OP_ADD
+};
+
+static const int sizes[][2] =
+{
+    { 1, 1080 }, { 4, 1 }, { 8, 8 }, { 16, 16 }, { 64, 64 }, { 256, 256 }
+};
+
+static pixman_image_t *
+create_random_image (pixman_format_code_t format, int width, int height)
+{
+    pixman_image_t *image;
+
+    image = pixman_image_create_bits (format, width, height, NULL, 0);
+    prng_randmemset (pixman_image_get_data (image),
+		     pixman_image_get_stride (image) * height, 0);
+
+    return image;
+}
+
+static void
+bench_tile (pixman_op_t op, pixman_format_code_t format, int tile_w, int tile_h)
+{
+    pixman_image_t *tile, *dest;
+    double t;
+    int i;
+
+    tile = create_random_image (format, tile_w, tile_h);
+    pixman_image_set_repeat (tile, PIXMAN_REPEAT_NORMAL);
+    dest = create_random_image (PIXMAN_a8r8g8b8, WIDTH, HEIGHT);
+
+    t = gettime ();
+    for (i = 0; i < N_ITERATIONS; ++i)
+	pixman_image_composite32 (op, tile, NULL, dest, 3, 5, 0, 0, 0, 0, WIDTH, HEIGHT);
+    t = gettime () - t;
+
+    printf ("%-6s %-10s %3dx%-3d tile : %8.1f Mpix/s\n",
+	    operator_name (op) + strlen ("PIXMAN_OP_"), format_name (format),
+	    tile_w, tile_h, N_ITERATIONS * (double)WIDTH * HEIGHT / t / 1e6);
+
+    pixman_image_unref (tile);
+    pixman_image_unref (dest);
+}
+
+int
+main (int argc, char *argv[])
+{
+    int i, j;
+
+    prng_srand (0);
+
+    printf ("# %dx%d destination\n", WIDTH, HEIGHT);
+
+    for (i = 0; i < ARRAY_LENGTH (ops); ++i)
+    {
+	for (j = 0; j < ARRAY_LENGTH (sizes); ++j)
+	    bench_tile (ops[i], PIXMAN_a8r8g8b8, sizes[j][0], sizes[j][1]);
+    }
+
+    return 0;
+}
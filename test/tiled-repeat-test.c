@@ -0,0 +1,175 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "utils.h"
+
+/* Composites with a NORMAL repeat source must match composites with a
+ * source image that has the tiles laid out in full.
+ */
+
+#define MAX_TILE_WIDTH 40
+#define MAX_TILE_HEIGHT 20
+#define MAX_WIDTH 300
+#define MAX_HEIGHT 50
+
+static const pixman_op_t ops[] =
+{
+    PIXMAN_OP_SRC, PIXMAN_OP_OVER, PIXMAN_OP_ADD, PIXMAN_OP_IN,
+    PIXMAN_OP_OUT_REVERSE, PIXMAN_OP_MULTIPLY
+};
+
+/* a1 comes last so that it is only used for sources */
+static const pixman_format_code_t formats[] =
+{
+    PIXMAN_a8r8g8b8, PIXMAN_x8r8g8b8, PIXMAN_r5g6b5, PIXMAN_a8,
+    PIXMAN_r8g8b8, PIXMAN_a16b16g16r16, PIXMAN_a1
+};
+
+static pixman_image_t *
+create_random_image (pixman_format_code_t format, int width, int height)
+{
+    pixman_image_t *image;
+
+    image = pixman_image_create_bits (format, width, height, NULL, 0);
+    prng_randmemset (pixman_image_get_data (image),
+		     pixman_image_get_stride (image) * height, 0);
+
+    return image;
+}
+
+static uint32_t
+get_bit (const uint32_t *row, int x)
+{
+#ifdef WORDS_BIGENDIAN
+    return (row[x >> 5] >> (31 - (x & 31))) & 1;
+#else
+    return (row[x >> 5] >> (x & 31)) & 1;
+#endif
+}
+
+/* Lays out the tiles by hand, so that the reference does not go
+ * through the code under test.
+ */
+static void
+lay_out_tiles (pixman_image_t *tile, pixman_image_t *full, int src_x, int src_y)
+{
+    int bpp = PIXMAN_FORMAT_BPP (pixman_image_get_format (tile));
+    int tile_w = pixman_image_get_width (tile);
+    int tile_h = pixman_image_get_height (tile);
+    int tile_stride = pixman_image_get_stride (tile);
+    int full_stride = pixman_image_get_stride (full);
+    uint8_t *t = (uint8_t *)pixman_image_get_data (tile);
+    uint8_t *f = (uint8_t *)pixman_image_get_data (full);
+    int x, y, sx, sy;
+
+    memset (f, 0, full_stride * pixman_image_get_height (full));
+
+    for (y = 0; y < pixman_image_get_height (full); ++y)
+    {
+	sy = ((src_y + y) % tile_h + tile_h) % tile_h;
+
+	for (x = 0; x < pixman_image_get_width (full); ++x)
+	{
+	    sx = ((src_x + x) % tile_w + tile_w) % tile_w;
+
+	    if (bpp == 1)
+	    {
+		uint32_t *row = (uint32_t *)(f + y * full_stride);
+		uint32_t bit = get_bit ((uint32_t *)(t + sy * tile_stride), sx);
+
+#ifdef WORDS_BIGENDIAN
+		row[x >> 5] |= bit << (31 - (x & 31));
+#else
+		row[x >> 5] |= bit << (x & 31);
+#endif
+	    }
+	    else
+	    {
+		memcpy (f + y * full_stride + x * bpp / 8,
+			t + sy * tile_stride + sx * bpp / 8, bpp / 8);
+	    }
+	}
+    }
+}
+
+static int
+test_tiled (int testnum)
+{
+    pixman_format_code_t src_format, dest_format;
+    pixman_image_t *tile, *full, *mask, *dest, *ref;
+    pixman_op_t op;
+    int tile_w, tile_h, width, height, src_x, src_y, y;
+    int stride, result = 0;
+    uint8_t *d, *r;
+
+    prng_srand (testnum);
+
+    op = ops[prng_rand_n (ARRAY_LENGTH (ops))];
+    src_format = formats[prng_rand_n (ARRAY_LENGTH (formats))];
+    dest_format = formats[prng_rand_n (ARRAY_LENGTH (formats) - 1)];
+    tile_w = prng_rand_n (MAX_TILE_WIDTH) + 1;
+    tile_h = prng_rand_n (MAX_TILE_HEIGHT) + 1;
+    width = prng_rand_n (MAX_WIDTH) + 1;
+    height = prng_rand_n (MAX_HEIGHT) + 1;
+    src_x = prng_rand_n (3 * MAX_TILE_WIDTH) - MAX_TILE_WIDTH;
+    src_y = prng_rand_n (3 * MAX_TILE_HEIGHT) - MAX_TILE_HEIGHT;
+
+    tile = create_random_image (src_format, tile_w, tile_h);
+    pixman_image_set_repeat (tile, PIXMAN_REPEAT_NORMAL);
+
+    /* The same tiles, laid out in full without repeat */
+    full = pixman_image_create_bits (src_format, width, height, NULL, 0);
+    lay_out_tiles (tile, full, src_x, src_y);
+
+    mask = NULL;
+    if (prng_rand_n (3) == 0)
+	mask = create_random_image (PIXMAN_a8, width, height);
+
+    dest = create_random_image (dest_format, width, height);
+    ref = pixman_image_create_bits (dest_format, width, height, NULL, 0);
+    stride = pixman_image_get_stride (dest);
+    memcpy (pixman_image_get_data (ref), pixman_image_get_data (dest),
+	    stride * height);
+
+    pixman_image_composite32 (op, tile, mask, dest,
+			      src_x, src_y, 0, 0, 0, 0, width, height);
+    pixman_image_composite32 (op, full, mask, ref,
+			      0, 0, 0, 0, 0, 0, width, height);
+
+    /* Only the pixels count; blits may round the padding up to words */
+    d = (uint8_t *)pixman_image_get_data (dest);
+    r = (uint8_t *)pixman_image_get_data (ref);
+    for (y = 0; y < height; ++y)
+    {
+	if (memcmp (d + y * stride, r + y * stride,
+		    width * PIXMAN_FORMAT_BPP (dest_format) / 8) != 0)
+	{
+	    printf ("test %d failed: %s %s %dx%d tile, %s %s %dx%d at %d, %d\n",
+		    testnum, operator_name (op), format_name (src_format),
+		    tile_w, tile_h, mask ? "a8" : "null",
+		    format_name (dest_format), width, height, src_x, src_y);
+	    result = 1;
+	    break;
+	}
+    }
+
+    pixman_image_unref (tile);
+    pixman_image_unref (full);
+    if (mask)
+	pixman_image_unref (mask);
+    pixman_image_unref (dest);
+    pixman_image_unref (ref);
+
+    return result;
+}
+
+int
+main (int argc, const char *argv[])
+{
+    int i, n_failed = 0;
+
+    for (i = 0; i < 3000; ++i)
+	n_failed += test_tiled (i);
+
+    return n_failed != 0;
+}
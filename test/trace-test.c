@@ -0,0 +1,126 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include "utils.h"
+
+#define WIDTH	20
+#define HEIGHT	10
+
+static pixman_trace_event_t events[8];
+static int n_events;
+
+static void
+trace (const pixman_trace_event_t *event, void *data)
+{
+    if (n_events < ARRAY_LENGTH (events))
+	events[n_events] = *event;
+    n_events++;
+
+    *(int *)data += 1;
+}
+
+static int
+check (int                  i,
+       pixman_trace_call_t  call,
+       pixman_op_t          op,
+       pixman_format_code_t mask_format,
+       int                  dest_bpp,
+       uint64_t             n_pixels,
+       pixman_bool_t        have_implementation)
+{
+    const pixman_trace_event_t *e = &events[i];
+
+    if (e->call != call || e->op != op || e->mask_format != mask_format ||
+	e->dest_bpp != dest_bpp || e->n_pixels != n_pixels ||
+	(e->implementation != NULL) != have_implementation)
+    {
+	printf ("event %d: unexpected call %d op %d mask %08x bpp %d "
+		"pixels %llu implementation %s\n", i,
+		e->call, e->op, e->mask_format, e->dest_bpp,
+		(unsigned long long)e->n_pixels,
+		e->implementation ? e->implementation : "(none)");
+	return 1;
+    }
+
+    return 0;
+}
+
+int
+main ()
+{
+    static uint32_t src_bits[WIDTH * HEIGHT], dst_bits[WIDTH * HEIGHT];
+    pixman_color_t color = { 0x8000, 0x8000, 0x8000, 0x8000 };
+    pixman_box32_t box = { 0, 0, WIDTH, HEIGHT };
+    pixman_trapezoid_t trap;
+    pixman_image_t *src, *dst;
+    pixman_bool_t filled, blitted;
+    int n_calls = 0;
+    int failed = 0;
+
+    src = pixman_image_create_bits (
+	PIXMAN_a8r8g8b8, WIDTH, HEIGHT, src_bits, WIDTH * 4);
+    dst = pixman_image_create_bits (
+	PIXMAN_a8r8g8b8, WIDTH, HEIGHT, dst_bits, WIDTH * 4);
+
+    trap.top = pixman_int_to_fixed (2);
+    trap.bottom = pixman_int_to_fixed (6);
+    trap.left.p1.x = pixman_int_to_fixed (4);
+    trap.left.p1.y = pixman_int_to_fixed (0);
+    trap.left.p2.x = pixman_int_to_fixed (4);
+    trap.left.p2.y = pixman_int_to_fixed (10);
+    trap.right.p1.x = pixman_int_to_fixed (12);
+    trap.right.p1.y = pixman_int_to_fixed (0);
+    trap.right.p2.x = pixman_int_to_fixed (12);
+    trap.right.p2.y = pixman_int_to_fixed (10);
+
+    pixman_set_trace_function (trace, &n_calls);
+
+    pixman_image_composite32 (PIXMAN_OP_OVER, src, NULL, dst,
+			      0, 0, 0, 0, 5, 0, WIDTH, HEIGHT);
+    filled = pixman_fill (dst_bits, WIDTH, 32, 0, 0, WIDTH, HEIGHT, 0x80808080);
+    blitted = pixman_blt (src_bits, dst_bits, WIDTH, WIDTH, 32, 32,
+			  0, 0, 0, 0, WIDTH / 2, HEIGHT);
+    pixman_image_fill_boxes (PIXMAN_OP_SRC, dst, &color, 1, &box);
+    pixman_composite_trapezoids (PIXMAN_OP_OVER, src, dst, PIXMAN_a8,
+				 0, 0, 0, 0, 1, &trap);
+
+    pixman_set_trace_function (NULL, NULL);
+
+    pixman_fill (dst_bits, WIDTH, 32, 0, 0, WIDTH, HEIGHT, 0);
+
+    /* The trapezoids go through a nested composite */
+    if (n_events != 6 || n_calls != n_events)
+    {
+	printf ("expected 6 events, got %d\n", n_events);
+	return 1;
+    }
+
+    failed |= check (0, PIXMAN_TRACE_COMPOSITE, PIXMAN_OP_OVER,
+		     PIXMAN_null, 32, (WIDTH - 5) * HEIGHT, TRUE);
+    /* Without a SIMD or C fast path, fills and blits fail and report
+     * no implementation
+     */
+    failed |= check (1, PIXMAN_TRACE_FILL, PIXMAN_OP_SRC,
+		     PIXMAN_null, 32, WIDTH * HEIGHT, filled);
+    failed |= check (2, PIXMAN_TRACE_BLT, PIXMAN_OP_SRC,
+		     PIXMAN_null, 32, WIDTH / 2 * HEIGHT, blitted);
+
+    /* Boxes that can't be filled are composited instead */
+    failed |= check (3, filled ? PIXMAN_TRACE_FILL : PIXMAN_TRACE_COMPOSITE,
+		     PIXMAN_OP_SRC, PIXMAN_null, 32, WIDTH * HEIGHT, TRUE);
+    if (events[3].call == PIXMAN_TRACE_FILL &&
+	(events[3].src_format != PIXMAN_null || events[3].src_bpp != 0))
+    {
+	printf ("fill boxes event has a source\n");
+	failed = 1;
+    }
+
+    failed |= check (4, PIXMAN_TRACE_COMPOSITE, PIXMAN_OP_OVER,
+		     PIXMAN_a8, 32, 8 * 4, TRUE);
+    failed |= check (5, PIXMAN_TRACE_COMPOSITE_TRAPEZOIDS, PIXMAN_OP_OVER,
+		     PIXMAN_a8, 32, 8 * 4, FALSE);
+
+    pixman_image_unref (src);
+    pixman_image_unref (dst);
+
+    return failed;
+}
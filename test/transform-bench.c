@@ -0,0 +1,100 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include "utils.h"
+
+/* Measures the per-call overhead of changing the transform of a
+ * source before every composite of a small area, as done when
+ * animating scaled or rotated sources.
+ */
+
+#define N_ITERATIONS 200000
+#define N_STOPS 64
+#define AREA 8
+
+static pixman_image_t *
+make_bits (void)
+{
+    pixman_image_t *image;
+
+    image = pixman_image_create_bits (PIXMAN_a8r8g8b8, 64, 64, NULL, 0);
+    prng_randmemset (pixman_image_get_data (image), 64 * 64 * 4, 0);
+    pixman_image_set_filter (image, PIXMAN_FILTER_BILINEAR, NULL, 0);
+    pixman_image_set_repeat (image, PIXMAN_REPEAT_PAD);
+
+    return image;
+}
+
+static pixman_image_t *
+make_linear (void)
+{
+    pixman_gradient_stop_t stops[N_STOPS];
+    pixman_point_fixed_t p1 = { 0, 0 };
+    pixman_point_fixed_t p2 = { pixman_int_to_fixed (64), 0 };
+    pixman_image_t *image;
+    int i;
+
+    for (i = 0; i < N_STOPS; ++i)
+    {
+	stops[i].x = pixman_int_to_fixed (i) / (N_STOPS - 1);
+	stops[i].color.red = prng_rand ();
+	stops[i].color.green = prng_rand ();
+	stops[i].color.blue = prng_rand ();
+	stops[i].color.alpha = 0xffff;
+    }
+
+    image = pixman_image_create_linear_gradient (&p1, &p2, stops, N_STOPS);
+    pixman_image_set_repeat (image, PIXMAN_REPEAT_REFLECT);
+
+    return image;
+}
+
+static void
+bench (const char *name, pixman_image_t *src, pixman_image_t *dest)
+{
+    pixman_transform_t transform;
+    double t1, t2;
+    int i;
+
+    t1 = gettime ();
+    for (i = 0; i < N_ITERATIONS; ++i)
+    {
+	double s = 1.0 + (i & 255) / 256.0;
+
+	pixman_transform_init_scale (&transform,
+				     pixman_double_to_fixed (s),
+				     pixman_double_to_fixed (s));
+	pixman_image_set_transform (src, &transform);
+
+	pixman_image_composite32 (PIXMAN_OP_OVER, src, NULL, dest,
+				  i & 31, i & 15, 0, 0,
+				  i & 7, i & 7, AREA, AREA);
+    }
+    t2 = gettime ();
+
+    printf ("%-24s : %10.1f ns per call\n",
+	    name, (t2 - t1) * 1000000000 / N_ITERATIONS);
+}
+
+int
+main (int argc, char *argv[])
+{
+    pixman_image_t *dest, *src;
+
+    prng_srand (0);
+
+    dest = pixman_image_create_bits (PIXMAN_a8r8g8b8, 16, 16, NULL, 0);
+
+    printf ("# set_transform + %dx%d composite\n", AREA, AREA);
+
+    src = make_bits ();
+    bench ("a8r8g8b8 bilinear", src, dest);
+    pixman_image_unref (src);
+
+    src = make_linear ();
+    bench ("linear gradient", src, dest);
+    pixman_image_unref (src);
+
+    pixman_image_unref (dest);
+
+    return 0;
+}
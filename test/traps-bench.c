@@ -0,0 +1,65 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include "utils.h"
+
+/* Times adding thin slanted trapezoids, as from stroking lines, to an
+ * a8 image with sampled and with analytic coverage.
+ */
+
+#define N_TRAPS 1000
+#define N_ITERATIONS 20
+
+static void
+bench_thin (const char *name, double slope, pixman_bool_t analytic)
+{
+    pixman_trapezoid_t traps[N_TRAPS];
+    pixman_image_t *image;
+    double t;
+    int i;
+
+    prng_srand (0);
+
+    for (i = 0; i < N_TRAPS; ++i)
+    {
+	pixman_fixed_t x = prng_rand_n (300 << 16) + (100 << 16);
+	pixman_fixed_t y = prng_rand_n (312 << 16);
+	pixman_fixed_t dx = pixman_double_to_fixed (200 * slope);
+
+	traps[i].top = y;
+	traps[i].bottom = y + (200 << 16);
+	traps[i].left.p1.x = x;
+	traps[i].left.p1.y = y;
+	traps[i].left.p2.x = x + dx;
+	traps[i].left.p2.y = y + (200 << 16);
+	traps[i].right = traps[i].left;
+	traps[i].right.p1.x += 0xc000;
+	traps[i].right.p2.x += 0xc000;
+    }
+
+    image = pixman_image_create_bits (PIXMAN_a8, 512, 512, NULL, 0);
+    pixman_image_set_analytic_coverage (image, analytic);
+
+    t = gettime ();
+    for (i = 0; i < N_ITERATIONS; ++i)
+	pixman_add_trapezoids (image, 0, 0, N_TRAPS, traps);
+    t = gettime () - t;
+
+    printf ("%-28s : %8.3f ms\n", name, t * 1000 / N_ITERATIONS);
+
+    pixman_image_unref (image);
+}
+
+int
+main (int argc, char *argv[])
+{
+    printf ("# %d thin trapezoids, 200 rows each\n", N_TRAPS);
+
+    bench_thin ("sampled, slope 0.25", 0.25, FALSE);
+    bench_thin ("analytic, slope 0.25", 0.25, TRUE);
+    bench_thin ("sampled, slope 1", 1, FALSE);
+    bench_thin ("analytic, slope 1", 1, TRUE);
+    bench_thin ("sampled, slope 0.05", 0.05, FALSE);
+    bench_thin ("analytic, slope 0.05", 0.05, TRUE);
+
+    return 0;
+}
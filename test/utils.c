@@ -1025,6 +1025,51 @@ convert_linear_to_srgb (double c)
         return 1.055 * pow (c, 1.0/2.4) - 0.055;
 }
 
+double
+half_to_double (uint16_t h)
+{
+    int e = (h >> 10) & 0x1f;
+    int m = h & 0x3ff;
+    double d;
+
+    if (e == 0x1f)
+	d = m ? NAN : INFINITY;
+    else if (e == 0)
+	d = ldexp (m, -24);
+    else
+	d = ldexp (m + 1024, e - 25);
+
+    return (h & 0x8000) ? -d : d;
+}
+
+/* Rounds to the nearest half, ties to even */
+uint16_t
+double_to_half (double d)
+{
+    uint16_t sign = signbit (d) ? 0x8000 : 0;
+    int e, m;
+
+    d = fabs (d);
+
+    if (isnan (d))
+	return sign | 0x7e00;
+    if (d >= 65520.0)
+	return sign | 0x7c00;
+    if (d < ldexp (1, -14))
+	return sign | (uint16_t)nearbyint (ldexp (d, 24));
+
+    frexp (d, &e);
+    e -= 1;
+    m = nearbyint ((ldexp (d, -e) - 1) * 1024);
+    if (m == 1024)
+    {
+	m = 0;
+	e++;
+    }
+
+    return sign | ((e + 15) << 10) | m;
+}
+
 void
 initialize_palette (pixman_indexed_t *palette, uint32_t depth, int is_rgb)
 {
@@ -1180,6 +1225,15 @@ static const format_entry_t format_list[] =
      * Aliases are not listed by list_formats ().
      */
 
+/* float formats */
+    ENTRY (rgba_float),
+    ENTRY (rgb_float),
+    ENTRY (rgba_half),
+
+/* 64bpp formats */
+    ENTRY (a16b16g16r16),
+    ALIAS (a16b16g16r16,	"16161616"),
+
 /* 32bpp formats */
     ENTRY (a8r8g8b8),
     ALIAS (a8r8g8b8,		"8888"),
@@ -2108,3 +2162,124 @@ pixel_checker_check (const pixel_checker_t *checker, uint32_t pixel,
 
     return result;
 }
+
+void
+image_get_pixel (pixman_image_t *image, int x, int y, double c[4])
+{
+    pixman_format_code_t format = pixman_image_get_format (image);
+    uint8_t *row;
+    uint64_t p;
+    int i;
+
+    x %= pixman_image_get_width (image);
+    y %= pixman_image_get_height (image);
+    row = (uint8_t *)pixman_image_get_data (image) +
+	y * pixman_image_get_stride (image);
+
+    switch (format)
+    {
+    case PIXMAN_rgba_float:
+	for (i = 0; i < 4; ++i)
+	    c[i] = ((float *)row)[4 * x + (i + 3) % 4];
+	break;
+
+    case PIXMAN_rgb_float:
+	c[0] = 1.0;
+	for (i = 1; i < 4; ++i)
+	    c[i] = ((float *)row)[3 * x + i - 1];
+	break;
+
+    case PIXMAN_rgba_half:
+	for (i = 0; i < 4; ++i)
+	    c[i] = half_to_double (((uint16_t *)row)[4 * x + (i + 3) % 4]);
+	break;
+
+    case PIXMAN_a16b16g16r16:
+	p = ((uint64_t *)row)[x];
+	for (i = 0; i < 4; ++i)
+	    c[i] = ((p >> (16 * ((i + 3) % 4))) & 0xffff) / 65535.;
+	break;
+
+    case PIXMAN_a8:
+	for (i = 0; i < 4; ++i)
+	    c[i] = row[x] / 255.;
+	break;
+
+    default:
+	p = ((uint32_t *)row)[x];
+	if (PIXMAN_FORMAT_A (format) == 0)
+	    p |= 0xff000000;
+	for (i = 0; i < 4; ++i)
+	    c[i] = ((p >> (24 - 8 * i)) & 0xff) / 255.;
+	break;
+    }
+}
+
+void
+image_fill_random (pixman_image_t *image)
+{
+    pixman_format_code_t format = pixman_image_get_format (image);
+    int width = pixman_image_get_width (image);
+    int height = pixman_image_get_height (image);
+    uint8_t *row = (uint8_t *)pixman_image_get_data (image);
+    int stride = pixman_image_get_stride (image);
+    int x, y, i;
+
+    for (y = 0; y < height; ++y, row += stride)
+    {
+	for (x = 0; x < width; ++x)
+	{
+	    uint64_t p;
+	    double c[4];
+
+	    switch (prng_rand_n (4))
+	    {
+	    case 0: c[0] = 0; break;
+	    case 1: c[0] = 1; break;
+	    default: c[0] = prng_rand_n (0x10000) / 65536.; break;
+	    }
+
+	    if (PIXMAN_FORMAT_A (format) == 0)
+		c[0] = 1;
+
+	    for (i = 1; i < 4; ++i)
+		c[i] = c[0] * prng_rand_n (0x10001) / 65536.;
+
+	    switch (format)
+	    {
+	    case PIXMAN_rgba_float:
+		for (i = 0; i < 4; ++i)
+		    ((float *)row)[4 * x + (i + 3) % 4] = c[i];
+		break;
+
+	    case PIXMAN_rgb_float:
+		for (i = 1; i < 4; ++i)
+		    ((float *)row)[3 * x + i - 1] = c[i];
+		break;
+
+	    case PIXMAN_rgba_half:
+		for (i = 0; i < 4; ++i)
+		    ((uint16_t *)row)[4 * x + (i + 3) % 4] = double_to_half (c[i]);
+		break;
+
+	    case PIXMAN_a16b16g16r16:
+		p = 0;
+		for (i = 0; i < 4; ++i)
+		    p |= (uint64_t)(c[i] * 65535) << (16 * ((i + 3) % 4));
+		((uint64_t *)row)[x] = p;
+		break;
+
+	    case PIXMAN_a8:
+		row[x] = c[0] * 255;
+		break;
+
+	    default:
+		p = 0;
+		for (i = 0; i < 4; ++i)
+		    p |= (uint32_t)(c[i] * 255) << (24 - 8 * i);
+		((uint32_t *)row)[x] = p;
+		break;
+	    }
+	}
+    }
+}
@@ -205,6 +205,12 @@ convert_srgb_to_linear (double component);
 double
 convert_linear_to_srgb (double component);
 
+double
+half_to_double (uint16_t h);
+
+uint16_t
+double_to_half (double d);
+
 void
 initialize_palette (pixman_indexed_t *palette, uint32_t depth, int is_rgb);
 
@@ -279,3 +285,16 @@ pixel_checker_get_masks (const pixel_checker_t *checker,
                          uint32_t              *rm,
                          uint32_t              *gm,
                          uint32_t              *bm);
+
+/* Reads the pixel at x, y (wrapped to the image size) as a, r, g, b
+ * components between 0 and 1. Handles a8, a8r8g8b8, x8r8g8b8,
+ * a16b16g16r16 and the float and half formats.
+ */
+void
+image_get_pixel (pixman_image_t *image, int x, int y, double c[4]);
+
+/* Fills an image of one of the formats above with random premultiplied
+ * pixels, with plenty of opaque and clear ones.
+ */
+void
+image_fill_random (pixman_image_t *image);